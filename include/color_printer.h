@@ -7,28 +7,28 @@
 #ifndef COLOR_PRINTER_H
 #define COLOR_PRINTER_H
 
+#include <array>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <sstream>
 #include <iostream>
 
-/**
- * @enum PrintColor
- * @brief 打印颜色枚举类
- */
-enum class PrintColor {
-    RED,
-    GREEN,
-    YELLOW,
-    BLUE,
-    MAGENTA,
-    CYAN,
-    WHITE
-};
+#include "color_printer_types.h"
+#include "color_printer_sink.h"
+#include "color_printer_style.h"
 
 /**
  * @class ColorPrinter
  * @brief 彩色打印工具类
  *        提供彩色控制台输出的静态方法
+ *        静态方法是默认打印器（ColorPrinter::Default()，输出到 std::cout 所在的fd）的外观，
+ *        需要独立目的地时创建 ColorPrinter::Printer 实例
  */
 class ColorPrinter {
 public:
@@ -57,6 +57,41 @@ public:
                                    const std::string& type,
                                    const std::string& message);
 
+    /**
+     * @brief 打印彩色字符串（std::string_view版本）
+     *        处理不以'\0'结尾的片段，例如从缓冲区中切出的一行，无需先拷贝成std::string
+     *
+     * @param color 颜色类型 (PrintColor枚举)
+     * @param type 消息类型
+     * @param message 要打印的消息内容
+     */
+    static void PrintColoredMessage(PrintColor color,
+                                   const std::string& type,
+                                   std::string_view message);
+
+    /**
+     * @brief 以任意样式打印消息（256色、真彩色、背景色、粗体等）
+     *        颜色按当前颜色深度（见 SetColorDepth）降级；样式的转义序列在每个线程的查找表中缓存
+     *
+     * @param style 样式
+     * @param type 消息类型
+     * @param message 要打印的消息内容
+     */
+    static void PrintStyledMessage(Style style,
+                                   const std::string& type,
+                                   std::string_view message);
+
+    /**
+     * @brief 以常量样式打印消息
+     *        各颜色深度下的转义序列在编译期生成，运行时只按当前颜色深度取下标
+     *
+     * @note 使用示例：
+     *       constexpr Style kBanner = Style{}.Foreground(TermColor::Rgb(255, 135, 0)).Bold();
+     *       ColorPrinter::PrintStyledMessage<kBanner>("INFO", "服务已启动");
+     */
+    template <Style S>
+    static void PrintStyledMessage(const std::string& type, std::string_view message);
+
     /**
      * @brief 打印彩色数字（bool版本）
      *        注意：bool类型放在前面，避免与字符串字面量冲突
@@ -135,6 +170,8 @@ public:
      * @brief 打印静默状态指示器
      *        打印累积的点号来指示静默状态
      *        最多打印100个点，达到100个后清空并重新开始循环
+     *        通常只追加新增的点号；换了计数器或颜色、回绕、或期间有其他消息输出时才整行重绘
+     *        重绘频率受 SetIndicatorFrameRate 限制，未到下一帧的调用只增加计数
      *
      * @param color 打印颜色 (PrintColor枚举)
      * @param isSilent 是否处于静默状态（当为true时打印点号）
@@ -157,10 +194,210 @@ public:
      */
     static void PrintSilentStatusIndicator(PrintColor color, bool isSilent, int& countRef);
 
-private:
+    /**
+     * @brief 设置静默状态指示器的最大刷新帧率
+     *
+     * @param frames_per_second 每秒最多刷新的次数，0 表示每次调用都刷新（默认 30）
+     */
+    static void SetIndicatorFrameRate(int frames_per_second);
+
+    /**
+     * @brief 根据消息类型字符串推断日志级别（不区分大小写）
+     *        "DEBUG"/"TRACE" -> DEBUG, "OK"/"SUCCESS" -> OK, "WARNING"/"WARN" -> WARNING,
+     *        "ERROR"/"ERR" -> ERROR, "FATAL"/"CRITICAL"/"PANIC" -> FATAL，其余视为 INFO
+     *
+     * @param type 消息类型
+     * @return 对应的日志级别
+     */
+    static LogLevel LevelFromType(std::string_view type);
+
+    /**
+     * @brief 开启或关闭延迟输出（双通道模型）
+     *        开启后，低于同步阈值的消息（INFO、DEBUG等）进入后台线程批量写出；
+     *        达到阈值的消息（默认ERROR及以上）仍在调用线程上直接写入输出fd，
+     *        写入前会先带出本线程尚在队列中的消息，保证同一线程内的先后顺序，
+     *        且不会排在其他线程积压的消息之后
+     *        关闭时会先把队列中剩余的消息全部写出
+     *
+     * @param enabled 是否开启延迟输出（默认关闭，所有消息同步写出）
+     */
+    static void SetDeferredOutput(bool enabled);
+
+    /**
+     * @brief 设置同步通道的级别阈值
+     *        级别不低于该阈值的消息总是在调用线程上直接写出
+     *
+     * @param level 同步阈值（默认 LogLevel::ERROR）
+     */
+    static void SetSyncLevel(LogLevel level);
+
+    /**
+     * @brief 将后台通道中尚未写出的消息立即写出
+     *        返回时，调用前已提交的消息都已写入输出fd
+     */
+    static void Flush();
+
+    class PrintAwaitable;
+    class FlushAwaitable;
+
+    /**
+     * @brief 协程版本的彩色打印
+     *        co_await 时将消息提交到输出通道：队列有空间时不挂起，直接继续执行；
+     *        后台通道积压已满时挂起协程（而不是阻塞线程），待消息被接收后经由
+     *        调度钩子（见 SetAsyncScheduler）恢复
+     *        同步通道的消息（默认ERROR及以上）以及未开启延迟输出时，消息在 co_await 中直接写出
+     *
+     * @param color 颜色类型 (PrintColor枚举)
+     * @param type 消息类型
+     * @param message 要打印的消息内容
+     * @return 可 co_await 的对象
+     *
+     * @note 使用示例：
+     *       co_await ColorPrinter::PrintAsync(PrintColor::GREEN, "INFO", "request done");
+     */
+    static PrintAwaitable PrintAsync(PrintColor color,
+                                     const std::string& type,
+                                     const std::string& message);
+
+    /**
+     * @brief 协程版本的彩色格式化打印（至少一个参数）
+     *
+     * @param color 颜色类型 (PrintColor枚举)
+     * @param type 消息类型
+     * @param format 格式字符串
+     * @param first 第一个格式化参数
+     * @param args 其余格式化参数
+     * @return 可 co_await 的对象
+     */
+    template <typename T, typename... Args>
+    static PrintAwaitable PrintAsync(PrintColor color,
+                                     const std::string& type,
+                                     const char* format,
+                                     T first,
+                                     Args... args);
+
+    /**
+     * @brief 协程版本的 Flush
+     *        co_await 返回时，之前已提交的消息都已写入输出fd；
+     *        需要等待时挂起协程，写出后经由调度钩子恢复
+     *
+     * @return 可 co_await 的对象
+     */
+    static FlushAwaitable FlushAsync();
+
+    /**
+     * @brief 设置协程恢复的调度钩子
+     *        被挂起的协程在消息被接收或写出后，通过该钩子交还给调用方的执行器；
+     *        未设置时交给打印器专用的恢复线程 resume()，从不在写出消息的线程上运行用户代码
+     *        （否则协程里的阻塞式打印会等待正在恢复它的输出线程自己腾出空间，造成死锁）
+     *
+     * @param scheduler 调度函数，例如把句柄投递到协程执行器的队列中；传入空函数恢复默认行为
+     */
+    static void SetAsyncScheduler(std::function<void(std::coroutine_handle<>)> scheduler);
+
+    struct PrinterOptions;
+    struct PrinterConfig;
+    class Printer;
+    class Stream;
+    class OutputCapture;
+    class Progress;
+    class StatusIndicator;
+    class Dashboard;
+
+    /**
+     * @brief 获取默认打印器
+     *        静态方法都转发到该实例，首次调用时创建，进程退出时写出剩余消息
+     */
+    static Printer& Default();
 
+    /**
+     * @brief 解析文本格式的打印器配置
+     *        每行一个 "键 = 值"，'#' 开头为注释，未出现的键保持 config 中原有的值
+     *        支持的键：min_level、sync_level（日志级别名）、colored、timestamp（true/false）、
+     *        color.<级别>（颜色名，例如 color.ERROR = MAGENTA）、
+     *        sink（stdout / stderr / file:<路径> / journal / syslog / shm:<总线名>，
+     *        文件与系统日志输出端不带颜色代码，共享内存总线由收集进程着色）
+     *        sink 的值与 config.sink_spec 相同时保留现有输出端，不会重新打开文件或覆盖代码安装的输出端
+     *
+     * @param text 配置文本
+     * @param config 输入为基础配置，输出为解析后的配置
+     * @param error 解析失败时写入错误描述（可为空）
+     * @return 解析成功返回true；失败时 config 不变
+     */
+    static bool ParseConfig(std::string_view text, PrinterConfig& config, std::string* error = nullptr);
+
+    /**
+     * @brief 获取颜色对应的ANSI转义序列
+     *
+     * @param color 颜色枚举值
+     * @return ANSI颜色代码
+     */
     static std::string GetColorCode(PrintColor color);
 
+    /**
+     * @brief 获取样式在当前颜色深度下的转义序列
+     *
+     * @param style 样式
+     * @return SGR 转义序列，没有任何属性的样式为空字符串
+     */
+    static std::string GetStyleCode(Style style);
+
+    /**
+     * @brief 当前的颜色深度
+     *        首次使用前根据环境变量检测：COLORTERM 为 truecolor/24bit 时为真彩色，
+     *        TERM 含 "256color" 时为256色，否则为16色
+     */
+    static ColorDepth GetColorDepth();
+
+    /**
+     * @brief 覆盖检测到的颜色深度，之后的样式按新深度输出
+     */
+    static void SetColorDepth(ColorDepth depth);
+
+    /**
+     * @brief 获取日志级别的默认颜色
+     *        DEBUG 青色、INFO 绿色、OK 蓝色、WARNING 黄色、ERROR 红色、FATAL 品红，
+     *        供按级别重新着色的工具（例如环形日志读取工具）使用
+     *
+     * @param level 日志级别
+     * @return 默认颜色
+     */
+    static PrintColor DefaultColorForLevel(LogLevel level);
+
+private:
+
+    /**
+     * @struct RenderedLine
+     * @brief 一条已渲染的消息，以及类型和正文在行内的位置
+     */
+    struct RenderedLine {
+        std::string text;
+        PrintColor color;
+        LogLevel level;
+        uint32_t type_offset;
+        uint32_t type_length;
+        uint32_t message_offset;
+        uint32_t message_length;
+        uint16_t escape_head;   // 行首颜色代码的字节数
+        uint16_t escape_tail;   // 换行前重置代码的字节数
+    };
+
+    /**
+     * @brief 渲染一行完整的消息（颜色代码、类型前缀、正文、重置代码与换行）
+     *        所有 PrintColoredMessage 重载最终都经由此函数，一条消息只产生一次写入
+     *
+     * @param escape 行首的颜色代码
+     * @param color escape 对应的 PrintColor，记入 LogRecord
+     * @param colored 为false时不输出颜色代码与重置代码
+     * @param timestamp 为true时在类型前输出本地时间 "YYYY-MM-DD HH:MM:SS.mmm "
+     */
+    static RenderedLine RenderLine(std::string_view escape,
+                                   PrintColor color,
+                                   const std::string& type,
+                                   std::string_view message,
+                                   bool colored,
+                                   bool timestamp);
+
 
     static std::string FormatString(const std::string& format);
 
@@ -175,21 +412,505 @@ private:
     static std::string FormatString(const std::string& format, T first, Args... args);
 };
 
+/**
+ * @struct ColorPrinter::PrinterOptions
+ * @brief 打印器配置
+ */
+struct ColorPrinter::PrinterOptions {
+    bool deferred = false;                              ///< 是否开启延迟输出（见 SetDeferredOutput）
+    LogLevel sync_level = LogLevel::ERROR;              ///< 同步通道阈值
+    size_t batch_bytes = 64 * 1024;                     ///< 后台通道单次写出的最大字节数
+    size_t max_pending_bytes = 8 * 1024 * 1024;         ///< 后台通道最多积压的字节数，超过后阻塞生产者
+    std::chrono::milliseconds flush_interval{20};       ///< 后台通道不足一批时的最长等待时间
+};
+
+/**
+ * @struct ColorPrinter::PrinterConfig
+ * @brief 可在运行时热更新的打印器配置
+ *        以不可变快照的形式发布：打印时只读取一次快照指针，不加锁；
+ *        更新时发布新快照，旧快照在所有读者离开后释放，不会阻塞正在打印的线程
+ */
+struct ColorPrinter::PrinterConfig {
+    std::shared_ptr<LogSink> sink;                          ///< 输出端
+    std::string sink_spec;                                  ///< 配置文本中 sink 的值，与之相同的重新加载保留现有输出端
+    LogLevel min_level = LogLevel::DEBUG;                   ///< 低于该级别的消息直接丢弃
+    LogLevel sync_level = LogLevel::ERROR;                  ///< 同步通道阈值
+    bool colored = true;                                    ///< 是否输出颜色代码（输出端不需要颜色时忽略）
+    bool timestamp = false;                                 ///< 是否在类型前输出时间戳
+    std::array<std::optional<PrintColor>, 6> level_colors;  ///< 按 LogLevel 覆盖调用方指定的颜色
+};
+
+/**
+ * @class ColorPrinter::Printer
+ * @brief 可实例化的彩色打印器
+ *        每个实例拥有独立的输出端、后台通道、队列和配置，
+ *        不同子系统可以输出到不同目的地而不必争用同一个全局流
+ *        接口与 ColorPrinter 的同名静态方法一致
+ *
+ * @note 使用示例：
+ *       auto sink = std::make_shared<FdSink>(STDERR_FILENO);
+ *       ColorPrinter::Printer printer{sink, {.deferred = true}};
+ *       printer.PrintColoredMessage(PrintColor::GREEN, "INFO", "子系统启动");
+ */
+class ColorPrinter::Printer {
+public:
+    /**
+     * @param sink 输出端
+     * @param options 打印器配置
+     */
+    explicit Printer(std::shared_ptr<LogSink> sink, PrinterOptions options = {});
+
+    /**
+     * @brief 析构时停止后台线程并写出剩余消息
+     */
+    ~Printer();
+
+    Printer(const Printer&) = delete;
+    Printer& operator=(const Printer&) = delete;
+
+    void PrintColoredMessage(PrintColor color, const std::string& type, const char* message);
+    void PrintColoredMessage(PrintColor color, const std::string& type, const std::string& message);
+    void PrintColoredMessage(PrintColor color, const std::string& type, std::string_view message);
+    void PrintStyledMessage(Style style, const std::string& type, std::string_view message);
+
+    template <Style S>
+    void PrintStyledMessage(const std::string& type, std::string_view message);
+    void PrintColoredMessage(PrintColor color, const std::string& type, bool value);
+    void PrintColoredMessage(PrintColor color, const std::string& type, char value);
+    void PrintColoredMessage(PrintColor color, const std::string& type, int value);
+    void PrintColoredMessage(PrintColor color, const std::string& type, float value);
+    void PrintColoredMessage(PrintColor color, const std::string& type, double value);
+
+    template <typename T, typename... Args>
+    void PrintColoredMessage(PrintColor color,
+                             const std::string& type,
+                             const char* format,
+                             T first,
+                             Args... args);
+
+    PrintAwaitable PrintAsync(PrintColor color, const std::string& type, const std::string& message);
+
+    template <typename T, typename... Args>
+    PrintAwaitable PrintAsync(PrintColor color,
+                              const std::string& type,
+                              const char* format,
+                              T first,
+                              Args... args);
+
+    FlushAwaitable FlushAsync();
+
+    void SetDeferredOutput(bool enabled);
+    void SetSyncLevel(LogLevel level);
+    void Flush();
+    void SetAsyncScheduler(std::function<void(std::coroutine_handle<>)> scheduler);
+
+    /**
+     * @brief 获取当前输出端
+     */
+    std::shared_ptr<LogSink> Sink() const;
+
+    /**
+     * @brief 获取当前配置的拷贝
+     */
+    PrinterConfig Config() const;
+
+    /**
+     * @brief 发布新配置
+     *        正在打印的线程继续使用旧快照直到本条消息结束，之后的消息使用新配置；
+     *        本函数会等待旧快照的读者离开后才返回。config.sink 为空时保留当前输出端
+     */
+    void SetConfig(PrinterConfig config);
+
+    /**
+     * @brief 基于当前配置修改并发布（多个更新者之间串行执行）
+     *
+     * @param edit 修改函数，接收当前配置的拷贝
+     */
+    void UpdateConfig(const std::function<void(PrinterConfig&)>& edit);
+
+    /**
+     * @brief 监视配置文件，文件被写入或替换时重新加载（Linux inotify）
+     *        启动时立即加载一次；解析失败时保留原配置并输出一条 WARNING
+     *        再次调用会替换之前的监视
+     *
+     * @param path 配置文件路径，格式见 ColorPrinter::ParseConfig
+     * @return 启动监视成功返回true
+     */
+    bool WatchConfigFile(const std::string& path);
+
+    /**
+     * @brief 停止监视配置文件
+     */
+    void StopWatchingConfigFile();
+
+private:
+    friend class ColorPrinter::PrintAwaitable;
+    friend class ColorPrinter::FlushAwaitable;
+    friend class ColorPrinter::Stream;
+    friend class ColorPrinter::OutputCapture;
+
+    class Impl;
+
+    /**
+     * @brief 按当前配置渲染一行消息
+     *
+     * @param sync 输出是否应走同步通道
+     * @return 渲染结果；被 min_level 过滤掉时 text 为空
+     */
+    RenderedLine Render(PrintColor color, const std::string& type, std::string_view message, bool& sync) const;
+
+    /**
+     * @brief 按当前配置渲染一行消息，颜色代码为 escape（配置中按级别覆盖的颜色优先）
+     *
+     * @param color escape 对应的最接近的 PrintColor，记入 LogRecord
+     */
+    RenderedLine Render(std::string_view escape,
+                        PrintColor color,
+                        const std::string& type,
+                        std::string_view message,
+                        bool& sync) const;
+
+    /**
+     * @brief 渲染一行消息并交给输出通道
+     */
+    void Emit(PrintColor color, const std::string& type, std::string_view message);
+    void Emit(std::string_view escape, PrintColor color, const std::string& type, std::string_view message);
+
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @class ColorPrinter::PrintAwaitable
+ * @brief PrintAsync 返回的可等待对象
+ */
+class ColorPrinter::PrintAwaitable {
+public:
+    bool await_ready();
+    bool await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept {}
+
+private:
+    friend class ColorPrinter::Printer;
+
+    PrintAwaitable(Printer& printer, RenderedLine line, bool sync)
+        : printer_(&printer), line_(std::move(line)), sync_(sync) {}
+
+    Printer* printer_;
+    RenderedLine line_;
+    bool sync_;
+};
+
+/**
+ * @class ColorPrinter::FlushAwaitable
+ * @brief FlushAsync 返回的可等待对象
+ */
+class ColorPrinter::FlushAwaitable {
+public:
+    bool await_ready();
+    bool await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept {}
+
+private:
+    friend class ColorPrinter::Printer;
+
+    explicit FlushAwaitable(Printer& printer)
+        : printer_(&printer) {}
+
+    Printer* printer_;
+};
+
+/**
+ * @class ColorPrinter::Stream
+ * @brief 带颜色与类型前缀的 std::ostream 适配器，可以直接替换现有的 operator<< 调用链
+ *        每写入一个 '\n'，这一行就立即交给打印器（与 PrintColoredMessage 走同一条单次写入的路径），
+ *        不必等 std::endl 或 std::flush；不完整的行积累在内部缓冲区中，析构时输出
+ *        每个 Stream 对象只应由一个线程使用
+ *
+ * @note 使用示例：
+ *       ColorPrinter::Stream(PrintColor::GREEN, "INFO") << "连接数: " << count << std::endl;
+ *
+ *       ColorPrinter::Stream debug(printer, PrintColor::CYAN, "DEBUG");
+ *       debug << "x = " << x << ", y = " << y << std::endl;
+ */
+class ColorPrinter::Stream : public std::ostream {
+public:
+    /**
+     * @brief 输出到默认打印器
+     */
+    Stream(PrintColor color, std::string type);
+
+    /**
+     * @brief 输出到指定的打印器
+     */
+    Stream(Printer& printer, PrintColor color, std::string type);
+
+    ~Stream() override;
+
+    Stream(const Stream&) = delete;
+    Stream& operator=(const Stream&) = delete;
+
+private:
+    /**
+     * @class LineBuffer
+     * @brief 不带放置区的 streambuf：写入的内容在 overflow / xsputn 中按 '\n' 切分，完整的行立即输出，
+     *        不完整的行留在内部字符串中
+     */
+    class LineBuffer : public std::streambuf {
+    public:
+        LineBuffer(Printer& printer, PrintColor color, std::string type);
+
+        /**
+         * @brief 输出末尾不完整的行
+         */
+        void EmitPartial();
+
+    protected:
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(const char* data, std::streamsize count) override;
+
+    private:
+        Printer& printer_;
+        PrintColor color_;
+        std::string type_;
+        std::string pending_;  ///< 尚未遇到 '\n' 的内容
+    };
+
+    LineBuffer buffer_;
+};
+
+/**
+ * @class ColorPrinter::StatusIndicator
+ * @brief 可由多个工作线程共享的静默状态指示器
+ *        显示效果与 PrintSilentStatusIndicator 相同（最多100个点后回绕），但计数由对象自己维护：
+ *        每个线程在自己的计数分片（按缓存行对齐）上累加，绘制时再汇总；
+ *        到了下一帧时只有一个线程能抢到绘制权（原子交换），其余线程不等待、不重复绘制
+ *        刷新频率同样受 SetIndicatorFrameRate 限制
+ *
+ * @note 使用示例：
+ *       ColorPrinter::StatusIndicator alive(PrintColor::GREEN);
+ *       // 每个工作线程
+ *       while (running) { work(); alive.Tick(); }
+ */
+class ColorPrinter::StatusIndicator {
+public:
+    explicit StatusIndicator(PrintColor color = PrintColor::GREEN);
+
+    /**
+     * @brief 调用 Flush，屏幕上留下最终的计数
+     */
+    ~StatusIndicator();
+
+    StatusIndicator(const StatusIndicator&) = delete;
+    StatusIndicator& operator=(const StatusIndicator&) = delete;
+
+    /**
+     * @brief 计数加一，到了下一帧且抢到绘制权时重绘，可由任意线程并发调用
+     */
+    void Tick();
+
+    /**
+     * @brief 不受帧率限制，立即按当前计数重绘
+     *        落在最后一帧之内的 Tick 不会触发绘制，停止计数后调用它让屏幕显示最终的计数
+     */
+    void Flush();
+
+    /**
+     * @brief 所有线程累计的次数
+     */
+    uint64_t Ticks() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @class ColorPrinter::Progress
+ * @brief 进度条与吞吐量显示
+ *        工作线程调用 Advance 累加进度（按线程分片的原子计数，不加锁、不互相争用缓存行），
+ *        由一个后台线程按固定频率绘制：进度条（用 Unicode 方块字符显示到 1/8 格）、百分比、
+ *        速率（指数加权平均）和预计剩余时间；Advance 的开销与刷新频率无关
+ *        写入默认打印器输出端所在的终端，颜色跟随输出端的 WantsColor()；有状态页脚（FooterSink）时
+ *        进度条画在页脚中，结束时最终一行写在页脚上方
+ *        输出端不是终端时不绘制中间帧，只在结束时输出一行最终结果
+ *
+ * @note 使用示例：
+ *       ColorPrinter::Progress progress(files.size(), PrintColor::GREEN, "INFO");
+ *       parallel_for(files, [&](const File& f) { process(f); progress.Advance(); });
+ *       progress.Finish();
+ */
+class ColorPrinter::Progress {
+public:
+    /**
+     * @param total 总数，为0时只显示已完成数量和速率
+     * @param color 进度条颜色
+     * @param type 前缀中的消息类型
+     * @param refresh 刷新间隔
+     */
+    Progress(uint64_t total,
+             PrintColor color,
+             std::string type,
+             std::chrono::milliseconds refresh = std::chrono::milliseconds(100));
+
+    /**
+     * @brief 未调用 Finish 时自动结束
+     */
+    ~Progress();
+
+    Progress(const Progress&) = delete;
+    Progress& operator=(const Progress&) = delete;
+
+    /**
+     * @brief 增加进度，可由任意线程并发调用
+     */
+    void Advance(uint64_t count = 1);
+
+    /**
+     * @brief 当前已完成的数量
+     */
+    uint64_t Done() const;
+
+    /**
+     * @brief 停止后台绘制，输出最终一帧并换行（只有第一次调用生效）
+     */
+    void Finish();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @class ColorPrinter::Dashboard
+ * @brief 多行实时面板：每个任务占一行，显示进度条、百分比、速率和状态（状态决定颜色）
+ *        后台线程按固定帧率绘制，保留上一帧的屏幕内容（按字符格），每帧只输出光标移动和变化的字符，
+ *        整帧一次 write；通过慢速 SSH 连接时也只占用很少的带宽
+ *        行数超过终端高度时只画最后几行，第一行汇总被隐藏的行数，面板总高度不超过终端行数减一
+ *        写入默认打印器输出端所在的终端，颜色跟随输出端的 WantsColor()；有状态页脚（FooterSink）时
+ *        各行画在页脚中，结束时每行的最终状态写在页脚上方
+ *        输出端不是终端时不绘制中间帧，只在结束时输出每行的最终状态
+ *
+ * @note 使用示例：
+ *       ColorPrinter::Dashboard dashboard;
+ *       auto row = dashboard.AddRow("下载 a.tar", bytes_total);
+ *       row.Advance(received);                        // 任意线程，无锁
+ *       row.SetState(PrintColor::RED, "失败");        // 状态文字与颜色
+ *       dashboard.Finish();
+ */
+class ColorPrinter::Dashboard {
+public:
+    /**
+     * @class Row
+     * @brief 面板中一行的句柄，可以拷贝，在面板存活期间有效
+     */
+    class Row {
+    public:
+        /**
+         * @brief 增加进度（relaxed 原子累加），可由任意线程并发调用
+         */
+        void Advance(uint64_t count = 1);
+
+        /**
+         * @brief 修改总数，为0时只显示数量和速率
+         */
+        void SetTotal(uint64_t total);
+
+        /**
+         * @brief 设置状态文字及该行的颜色
+         */
+        void SetState(PrintColor color, std::string state);
+
+    private:
+        friend class Dashboard;
+        struct State;
+
+        explicit Row(State* state) : state_(state) {}
+
+        State* state_;
+    };
+
+    /**
+     * @param frame_interval 帧间隔
+     */
+    explicit Dashboard(std::chrono::milliseconds frame_interval = std::chrono::milliseconds(100));
+
+    /**
+     * @brief 未调用 Finish 时自动结束
+     */
+    ~Dashboard();
+
+    Dashboard(const Dashboard&) = delete;
+    Dashboard& operator=(const Dashboard&) = delete;
+
+    /**
+     * @brief 添加一行（追加到面板底部）
+     *
+     * @param label 行首的名称
+     * @param total 总数，为0时只显示数量和速率
+     * @param color 初始颜色
+     */
+    Row AddRow(std::string label, uint64_t total = 0, PrintColor color = PrintColor::GREEN);
+
+    /**
+     * @brief 停止后台绘制，输出最终一帧，光标停在面板下方（只有第一次调用生效）
+     */
+    void Finish();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
 // 模板函数实现
+template <typename T, typename... Args>
+ColorPrinter::PrintAwaitable ColorPrinter::PrintAsync(PrintColor color,
+                                                      const std::string& type,
+                                                      const char* format,
+                                                      T first,
+                                                      Args... args) {
+    return Default().PrintAsync(color, type, format, first, args...);
+}
+
+template <typename T, typename... Args>
+void ColorPrinter::Printer::PrintColoredMessage(PrintColor color,
+                                                const std::string& type,
+                                                const char* format,
+                                                T first,
+                                                Args... args) {
+    // 使用printf风格格式化消息，支持精度设置
+    std::string message_str = FormatPrintf(format, first, args...);
+    Emit(color, type, message_str);
+}
+
+template <typename T, typename... Args>
+ColorPrinter::PrintAwaitable ColorPrinter::Printer::PrintAsync(PrintColor color,
+                                                               const std::string& type,
+                                                               const char* format,
+                                                               T first,
+                                                               Args... args) {
+    std::string message_str = FormatPrintf(format, first, args...);
+    bool sync = false;
+    RenderedLine line = Render(color, type, message_str, sync);
+    return PrintAwaitable(*this, std::move(line), sync);
+}
+
 template <typename T, typename... Args>
 void ColorPrinter::PrintColoredMessage(PrintColor color,
                                       const std::string& type,
                                       const char* format,
                                       T first,
                                       Args... args) {
-    std::string color_code = GetColorCode(color);
-    const std::string reset_code = "\033[0m";
+    Default().PrintColoredMessage(color, type, format, first, args...);
+}
 
-    // 使用printf风格格式化消息，支持精度设置
-    std::string message_str = FormatPrintf(format, first, args...);
+template <Style S>
+void ColorPrinter::Printer::PrintStyledMessage(const std::string& type, std::string_view message) {
+    Emit(kStyleEscapes<S>[static_cast<size_t>(GetColorDepth())].View(), NearestPrintColor(S), type, message);
+}
 
-    // 打印彩色消息，使用用户要求的格式
-    std::cout << color_code << "[" << type << "] " << message_str << reset_code << std::endl;
+template <Style S>
+void ColorPrinter::PrintStyledMessage(const std::string& type, std::string_view message) {
+    Default().PrintStyledMessage<S>(type, message);
 }
 
 template <typename T, typename... Args>
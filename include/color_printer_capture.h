@@ -0,0 +1,90 @@
+/**
+ * @file color_printer_capture.h
+ * @brief 捕获进程的标准输出/标准错误（fd 1 和 2），逐行加上颜色与类型前缀后重新输出
+ */
+
+#ifndef COLOR_PRINTER_CAPTURE_H
+#define COLOR_PRINTER_CAPTURE_H
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "color_printer.h"
+
+/**
+ * @struct CaptureOptions
+ * @brief 输出捕获的配置
+ */
+struct CaptureOptions {
+    bool capture_stdout = true;
+    bool capture_stderr = true;
+    PrintColor stdout_color = PrintColor::WHITE;
+    std::string stdout_type = "STDOUT";
+    PrintColor stderr_color = PrintColor::RED;
+    std::string stderr_type = "STDERR";
+    size_t pipe_bytes = 1024 * 1024;     ///< 管道容量（F_SETPIPE_SZ），写入方在读取线程落后时才会阻塞
+    size_t max_line_bytes = 64 * 1024;   ///< 超过该长度仍没有换行时先输出已有部分
+};
+
+/**
+ * @class ColorPrinter::OutputCapture
+ * @brief 把 fd 1 / fd 2 重定向到管道，由后台线程读取、按行切分，
+ *        每行以配置的颜色和类型经打印器输出；第三方库的 std::cout、printf 和直接 write 都会被捕获
+ *        打印器的输出端写 fd 1 / fd 2 时（LogSink::WritesToFd），捕获期间换成 RebindFd 得到的、
+ *        写入原来终端的输出端，避免输出回到管道；FdSink 与由它们组成的 FanOutSink 支持改写，
+ *        FooterSink 与未实现这两个接口的自定义输出端不支持，此时不捕获（Active() 为false）
+ *        析构时恢复 fd 1 / fd 2 与原输出端，并输出管道中剩余的内容
+ *        同一时刻只应有一个 OutputCapture 存活
+ *
+ * @note 使用示例：
+ *       ColorPrinter::OutputCapture capture;  // 捕获到默认打印器
+ *       third_party_init();                    // 其 std::cout 输出带上 [STDOUT] 前缀
+ */
+class ColorPrinter::OutputCapture {
+public:
+    explicit OutputCapture(CaptureOptions options = {});
+    OutputCapture(Printer& printer, CaptureOptions options = {});
+    ~OutputCapture();
+
+    OutputCapture(const OutputCapture&) = delete;
+    OutputCapture& operator=(const OutputCapture&) = delete;
+
+    /**
+     * @brief 是否成功开始捕获（创建管道失败或输出端无法改写时为false，此时不做任何重定向）
+     */
+    bool Active() const { return active_; }
+
+private:
+    /**
+     * @struct Channel
+     * @brief 一个被捕获的描述符
+     */
+    struct Channel {
+        int target_fd = -1;     ///< 被重定向的描述符（1 或 2）
+        int saved_fd = -1;      ///< 重定向前 target_fd 的副本
+        int read_fd = -1;       ///< 管道读端
+        int write_fd = -1;      ///< 管道写端，重定向到 target_fd 后关闭
+        PrintColor color = PrintColor::WHITE;
+        std::string type;
+        std::string partial;    ///< 尚未遇到换行的内容
+    };
+
+    bool Start();
+    bool OpenPipe(Channel& channel, int target_fd);
+    void Run();
+    bool Drain(Channel& channel, char* buffer, size_t size);
+    void EmitLines(Channel& channel, const char* data, size_t length);
+    void EmitLine(Channel& channel, std::string_view line);
+    void Restore();
+
+    Printer& printer_;
+    CaptureOptions options_;
+    Channel channels_[2];
+    std::shared_ptr<LogSink> original_sink_;
+    int stop_fd_ = -1;
+    bool active_ = false;
+    std::thread reader_;
+};
+
+#endif // COLOR_PRINTER_CAPTURE_H
@@ -0,0 +1,174 @@
+/**
+ * @file color_printer_compressed_sink.h
+ * @brief 在后台线程上按块压缩的文件输出端
+ */
+
+#ifndef COLOR_PRINTER_COMPRESSED_SINK_H
+#define COLOR_PRINTER_COMPRESSED_SINK_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "color_printer_sink.h"
+
+/**
+ * @enum CompressionCodec
+ * @brief 块压缩算法
+ */
+enum class CompressionCodec : uint8_t {
+    NONE = 0,  ///< 不压缩（压缩后反而更大的块也按此存储）
+    LZ = 1,    ///< 内置的 LZ 块压缩，速度优先
+    ZLIB = 2   ///< zlib（构建时找到 zlib 才可用，否则退回 LZ）
+};
+
+/**
+ * @struct CompressedBlockHeader
+ * @brief 压缩文件中每个块的帧头（32字节，小端），紧跟 stored_bytes 字节的块数据
+ *        每个块只包含完整的行、可以独立解压；raw_offset 为块在解压后数据中的偏移，
+ *        因此读取方只需依次读取帧头即可定位任意位置，并可以并行解压各块
+ *        进程崩溃时最后一个块可能不完整，校验失败的块及其后的内容被忽略
+ */
+struct CompressedBlockHeader {
+    static constexpr char kMagic[4] = {'C', 'P', 'Z', 'B'};
+
+    char magic[4];
+    uint8_t codec;           ///< CompressionCodec
+    uint8_t reserved[3];
+    uint32_t raw_bytes;      ///< 解压后的字节数
+    uint32_t stored_bytes;   ///< 块数据的字节数
+    uint64_t raw_offset;     ///< 块在解压后数据中的起始偏移
+    uint32_t checksum;       ///< 块数据的 FNV-1a 校验和
+    uint32_t header_check;   ///< 帧头前 28 字节的 FNV-1a 校验和
+};
+
+static_assert(sizeof(CompressedBlockHeader) == 32, "压缩块帧头必须为32字节");
+
+/**
+ * @struct CompressedFileOptions
+ * @brief 压缩文件输出端的配置
+ */
+struct CompressedFileOptions {
+    std::string path;                                   ///< 文件路径；已存在的压缩日志会截掉不完整的尾部后继续追加，不是压缩日志的文件拒绝打开
+    bool colored = false;                               ///< 是否保留颜色代码
+    CompressionCodec codec = CompressionCodec::LZ;
+    int zlib_level = 6;                                 ///< ZLIB 的压缩级别（1~9）
+    size_t block_bytes = 1024 * 1024;                   ///< 单个块解压后的最大字节数（单行更长时整行成块）
+    size_t max_blocks = 4;                              ///< 最多积压的待压缩块个数，超过后写入方等待
+    std::chrono::milliseconds flush_interval{1000};     ///< 块未满时最长多久压缩写出一次
+};
+
+/**
+ * @struct CompressionStats
+ * @brief 压缩统计
+ */
+struct CompressionStats {
+    uint64_t blocks = 0;
+    uint64_t raw_bytes = 0;           ///< 压缩前的字节数
+    uint64_t stored_bytes = 0;        ///< 写入文件的字节数（含帧头）
+    double cpu_seconds = 0.0;         ///< 压缩线程花在压缩上的 CPU 时间
+
+    /**
+     * @brief 压缩比（压缩前/压缩后），没有数据时为0
+     */
+    double Ratio() const { return stored_bytes == 0 ? 0.0 : static_cast<double>(raw_bytes) / stored_bytes; }
+};
+
+/**
+ * @class CompressedFileSink
+ * @brief 压缩文件输出端
+ *        写入方只把行拷贝进当前块；压缩与写文件在后台线程上完成
+ */
+class CompressedFileSink : public LogSink {
+public:
+    explicit CompressedFileSink(CompressedFileOptions options);
+
+    /**
+     * @brief 压缩写出剩余内容并停止后台线程
+     */
+    ~CompressedFileSink() override;
+
+    CompressedFileSink(const CompressedFileSink&) = delete;
+    CompressedFileSink& operator=(const CompressedFileSink&) = delete;
+
+    void Write(const LogRecord* records, size_t count) override;
+
+    /**
+     * @brief 把当前块压缩写出，等待此前写入的内容全部落到文件中
+     */
+    void Flush() override;
+
+    bool WantsColor() const override { return options_.colored; }
+
+    bool WritesToFd(int /*fd*/) const override { return false; }
+
+    /**
+     * @brief 文件是否成功打开；失败时（包括文件已存在但不是压缩日志）写入被丢弃
+     */
+    bool IsOpen() const { return fd_ >= 0; }
+
+    /**
+     * @brief 实际使用的压缩算法（请求 ZLIB 但不可用时为 LZ）
+     */
+    CompressionCodec Codec() const { return codec_; }
+
+    /**
+     * @brief 到目前为止的压缩统计
+     */
+    CompressionStats Stats() const;
+
+    /**
+     * @brief 读取压缩文件中所有有效块的帧头，遇到不完整或校验失败的块时停止
+     *
+     * @param valid_bytes 输出有效块的总字节数（即可安全追加的位置），可为空
+     * @return 文件可读时返回true
+     */
+    static bool ReadBlockIndex(const std::string& path, std::vector<CompressedBlockHeader>& blocks,
+                               uint64_t* valid_bytes = nullptr);
+
+    /**
+     * @brief 按顺序逐块解压整个文件，各块在多个线程上并行解压
+     *        同一时刻最多保留 2 × threads 个解压后的块，解压任意大的文件都不会占用与之相当的内存
+     *
+     * @param consumer 依次收到每个块解压后的内容（只在调用期间有效），返回false时停止解压
+     * @param threads 线程数，0 表示使用硬件并发数
+     * @return 文件可读、所有有效块都能解压且 consumer 没有中途停止时返回true
+     */
+    static bool Decompress(const std::string& path, const std::function<bool(std::string_view)>& consumer,
+                           unsigned threads = 0);
+
+private:
+    void CompressorLoop();
+    void HandOffActiveLocked(std::unique_lock<std::mutex>& lock);
+    void SubmitActiveLocked();
+    void CompressBlock(const std::string& block);
+
+    const CompressedFileOptions options_;
+    CompressionCodec codec_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable compressor_cv_;  // 唤醒压缩线程
+    std::condition_variable done_cv_;        // 块写出
+    std::string active_;                     // 正在填充的块
+    std::deque<std::string> full_;           // 等待压缩的块
+    std::vector<std::string> spare_;         // 可复用的空块
+    uint64_t submitted_ = 0;
+    uint64_t written_ = 0;
+    CompressionStats stats_;
+    bool stop_ = false;
+    std::thread compressor_;
+
+    // 以下仅由压缩线程访问
+    int fd_ = -1;
+    uint64_t raw_offset_ = 0;
+    std::string compressed_;
+};
+
+#endif // COLOR_PRINTER_COMPRESSED_SINK_H
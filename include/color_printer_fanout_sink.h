@@ -0,0 +1,76 @@
+/**
+ * @file color_printer_fanout_sink.h
+ * @brief 把同一批消息分发给多个输出端，消息只渲染一次
+ */
+
+#ifndef COLOR_PRINTER_FANOUT_SINK_H
+#define COLOR_PRINTER_FANOUT_SINK_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "color_printer_sink.h"
+
+/**
+ * @class FanOutSink
+ * @brief 分发输出端
+ *        打印器只渲染一次（任一子输出端需要颜色时带颜色代码），每条记录携带颜色代码在行内的位置：
+ *        - 需要颜色的子输出端直接拿到原始记录，不拷贝
+ *        - 不需要颜色的子输出端拿到跳过颜色代码后的行；这些字节每批只拼接一次，由所有此类输出端共享
+ *        - 类型、正文等结构化字段对所有子输出端都是指向原始字节的视图
+ *        每个子输出端有独立的级别过滤
+ */
+class FanOutSink : public LogSink {
+public:
+    FanOutSink() = default;
+
+    /**
+     * @brief 添加子输出端
+     *
+     * @param min_level 低于该级别的消息不交给此输出端
+     */
+    void Add(std::shared_ptr<LogSink> sink, LogLevel min_level = LogLevel::DEBUG);
+
+    void Write(const LogRecord* records, size_t count) override;
+
+    void Flush() override;
+
+    /**
+     * @brief 任一子输出端需要颜色时为true
+     */
+    bool WantsColor() const override { return any_colored_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 任一子输出端可能写入 fd 时为true
+     */
+    bool WritesToFd(int fd) const override;
+
+    /**
+     * @brief 写入 from_fd 的子输出端换成各自 RebindFd 的结果，其余子输出端原样共享；
+     *        任一子输出端不支持时返回空指针
+     */
+    std::shared_ptr<LogSink> RebindFd(int from_fd, int to_fd) const override;
+
+private:
+    struct Target {
+        std::shared_ptr<LogSink> sink;
+        LogLevel min_level;
+        bool colored;
+    };
+
+    const LogRecord* PlainRecords(const LogRecord* records, size_t count);
+
+    mutable std::mutex mutex_;
+    std::vector<Target> targets_;
+    std::atomic<bool> any_colored_{false};
+
+    // 以下为 Write 期间复用的缓冲区（受 mutex_ 保护）
+    std::string plain_bytes_;
+    std::vector<LogRecord> plain_records_;
+    std::vector<LogRecord> filtered_;
+};
+
+#endif // COLOR_PRINTER_FANOUT_SINK_H
@@ -0,0 +1,154 @@
+/**
+ * @file color_printer_file_sink.h
+ * @brief 带用户态大缓冲、按大小/时间轮转的文件输出端
+ */
+
+#ifndef COLOR_PRINTER_FILE_SINK_H
+#define COLOR_PRINTER_FILE_SINK_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "color_printer_sink.h"
+
+namespace color_printer_detail {
+class UringWriter;
+}
+
+/**
+ * @struct RotatingFileOptions
+ * @brief 轮转文件输出端的配置
+ */
+struct RotatingFileOptions {
+    std::string path;                                   ///< 当前文件路径，历史文件为 path.1（最新）… path.N
+    bool colored = false;                               ///< 是否保留颜色代码
+    size_t buffer_bytes = 1024 * 1024;                  ///< 单个用户态缓冲区大小
+    size_t max_buffers = 4;                             ///< 最多积压的缓冲区个数，超过后写入方等待
+    std::chrono::milliseconds flush_interval{200};      ///< 缓冲区未满时最长多久写出一次
+    size_t max_file_bytes = 0;                          ///< 单个文件的最大字节数，0 表示不按大小轮转
+    std::chrono::seconds rotate_interval{0};            ///< 按时间轮转的间隔，0 表示不按时间轮转
+    size_t max_files = 5;                               ///< 保留的历史文件个数，0 表示轮转时直接删除
+    bool preallocate = true;                            ///< 按大小轮转时用 fallocate 预分配 max_file_bytes
+    /**
+     * @brief 用 io_uring 异步写文件（仅 Linux）
+     *        写线程把缓冲区按批提交为链接的写请求，不等待完成即可处理下一个缓冲区；
+     *        缓冲区池尽量注册为固定缓冲区（受 RLIMIT_MEMLOCK 限制，注册失败时使用普通写请求）；
+     *        编译环境或内核不支持时自动回退到 write
+     */
+    bool io_uring = false;
+    /**
+     * @brief 轮转完成后的回调（例如把 path.1 交给压缩程序），在后台写线程上调用
+     *        下一次轮转前 path.1 不会被改名，回调可以在此期间处理它
+     */
+    std::function<void(const std::string& rotated_path)> on_rotated;
+};
+
+/**
+ * @class RotatingFileSink
+ * @brief 轮转文件输出端
+ *        写入方只把行拷贝进用户态缓冲区；写文件、轮转（重命名、打开新文件、预分配）
+ *        与压缩交接全部在后台写线程上完成，调用方不会等待文件系统元数据操作
+ *        （只有当积压的缓冲区达到 max_buffers 时才会等待写线程腾出缓冲区）
+ */
+class RotatingFileSink : public LogSink {
+public:
+    explicit RotatingFileSink(RotatingFileOptions options);
+
+    /**
+     * @brief 写出剩余内容并停止写线程
+     */
+    ~RotatingFileSink() override;
+
+    RotatingFileSink(const RotatingFileSink&) = delete;
+    RotatingFileSink& operator=(const RotatingFileSink&) = delete;
+
+    void Write(const LogRecord* records, size_t count) override;
+
+    /**
+     * @brief 等待此前写入的内容全部落到文件中
+     */
+    void Flush() override;
+
+    bool WantsColor() const override { return options_.colored; }
+
+    bool WritesToFd(int /*fd*/) const override { return false; }
+
+    const std::string& Path() const { return options_.path; }
+
+    /**
+     * @brief 是否实际使用了 io_uring（请求了 io_uring 但不可用时为false）
+     */
+    bool UsingIoUring() const { return uring_ != nullptr; }
+
+private:
+    /**
+     * @brief 已提交给 io_uring、尚未全部完成的缓冲区
+     */
+    struct InFlightBuffer {
+        std::string data;
+        size_t pending = 0;  // 未完成的写请求个数
+    };
+
+    /**
+     * @brief 一个已提交的写请求，短写或失败时用 pwrite 补写
+     */
+    struct PendingWrite {
+        uint64_t buffer_seq;
+        const char* data;
+        size_t length;
+        uint64_t offset;
+    };
+
+    void WriterLoop();
+    void HandOffActiveLocked(std::unique_lock<std::mutex>& lock);
+    void SubmitActiveLocked();
+    void WriteBuffer(const std::string& buffer);
+    void WriteChunk(const char* data, size_t length);
+    void OpenFile();
+    void CloseFile();
+    void Rotate();
+
+    void SetUpUring();
+    void SubmitChain();
+    void ReapCompletions(unsigned wait_min);
+    void DrainInFlight();
+    void RetireCompletedLocked();
+
+    const RotatingFileOptions options_;
+
+    std::mutex mutex_;
+    std::condition_variable writer_cv_;  // 唤醒写线程
+    std::condition_variable done_cv_;    // 缓冲区写出
+    std::string active_;                 // 正在填充的缓冲区
+    std::deque<std::string> full_;       // 等待写出的缓冲区
+    std::vector<std::string> spare_;     // 可复用的空缓冲区
+    uint64_t submitted_ = 0;             // 累计提交给写线程的缓冲区个数
+    uint64_t written_ = 0;               // 累计写出的缓冲区个数
+    bool stop_ = false;
+    std::thread writer_;
+
+    // 以下仅由写线程访问
+    int fd_ = -1;
+    size_t file_bytes_ = 0;
+    std::chrono::steady_clock::time_point opened_at_;
+
+    // io_uring 状态，仅由写线程访问（RetireCompletedLocked 另需持有 mutex_）
+    std::unique_ptr<color_printer_detail::UringWriter> uring_;
+    std::vector<std::pair<const char*, size_t>> registered_;      // 注册的缓冲区 {起始地址, 容量}
+    std::deque<InFlightBuffer> in_flight_;                        // 按提交顺序排列
+    uint64_t retired_seq_ = 0;                                    // in_flight_.front() 的序号
+    int current_buffer_index_ = -1;                               // 当前缓冲区的注册下标
+    std::vector<PendingWrite> chain_;                             // 待提交的链接写请求
+    std::vector<PendingWrite> pending_writes_;                    // 下标即请求 tag
+    std::vector<uint64_t> free_tags_;
+};
+
+#endif // COLOR_PRINTER_FILE_SINK_H
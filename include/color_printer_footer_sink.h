@@ -0,0 +1,146 @@
+/**
+ * @file color_printer_footer_sink.h
+ * @brief 固定在终端底部的状态页脚，与滚动的日志消息协调输出
+ */
+
+#ifndef COLOR_PRINTER_FOOTER_SINK_H
+#define COLOR_PRINTER_FOOTER_SINK_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "color_printer_sink.h"
+
+namespace color_printer_detail {
+/**
+ * @brief 有活动的 FooterSink 时把静默状态指示器画在页脚的最后一行（库内部使用）
+ *
+ * @param dots 点数（0~100），页脚中显示为 "[INFO] ...."
+ * @return 没有活动的页脚时返回false，由调用者直接绘制
+ */
+bool ShowIndicatorInFooter(PrintColor color, int dots);
+
+/**
+ * @brief 有活动的 FooterSink 时把 owner 的状态行（进度条、面板）画在页脚中，
+ *        位于 SetLine 的各行之下、静默状态指示器之上（库内部使用）
+ *
+ * @param owner 调用者，同一 owner 的行整体替换
+ * @param lines 各行内容，可以带颜色代码；为空时移除 owner 的行
+ * @return 没有活动的页脚时返回false，由调用者直接绘制
+ */
+bool ShowLinesInFooter(const void* owner, std::vector<std::string> lines);
+
+/**
+ * @brief 有活动的 FooterSink 时把一行写在页脚上方，随消息滚动（库内部使用）
+ *        用于进度条、面板结束时留下最终状态
+ *
+ * @param text 不带颜色代码和换行的一行；页脚带颜色时按 color 着色
+ * @return 没有活动的页脚时返回false
+ */
+bool WriteAboveFooter(PrintColor color, std::string_view text);
+}
+
+/**
+ * @class FooterSink
+ * @brief 写入终端的输出端，在消息下方固定显示若干状态行
+ *        每批消息：清除页脚、写出消息、补回页脚，三者合成一次 write，消息始终在页脚上方滚动，页脚不会闪烁消失；
+ *        补回的是上次画出的页脚，SetLine 等带来的变化在距上次重绘满一帧时才画出（由本批或后台线程），
+ *        状态行更新再频繁，页脚每秒最多重绘帧率次
+ *        存在时静默状态指示器画在页脚的最后一行，不再与消息挤在同一行；下一批消息写出时指示器结束，从页脚移除
+ *        存在时进度条（ColorPrinter::Progress）与多行面板（ColorPrinter::Dashboard）也画在页脚中，结束时最终状态写在页脚上方
+ *        fd 不是终端时等同于 FdSink，状态行不输出
+ *
+ *        示例：
+ *        auto footer = std::make_shared<FooterSink>();
+ *        ColorPrinter::Default().UpdateConfig([&](ColorPrinter::PrinterConfig& config) { config.sink = footer; });
+ *        footer->SetLine(0, PrintColor::CYAN, "已处理 0 个文件");
+ *
+ *        绕过打印器直接写入同一终端的内容（例如 std::cout）不经过页脚协调
+ */
+class FooterSink : public LogSink {
+public:
+    /**
+     * @param fd 终端的文件描述符（不接管所有权），默认为标准输出
+     * @param colored 消息是否带颜色代码（页脚本身总是带颜色）
+     * @param frame_interval 页脚两次重绘的最小间隔
+     */
+    explicit FooterSink(int fd = 1, bool colored = true,
+                        std::chrono::milliseconds frame_interval = std::chrono::milliseconds(33));
+
+    /**
+     * @brief 从屏幕上清除页脚
+     */
+    ~FooterSink() override;
+
+    FooterSink(const FooterSink&) = delete;
+    FooterSink& operator=(const FooterSink&) = delete;
+
+    void Write(const LogRecord* records, size_t count) override;
+
+    bool WantsColor() const override { return colored_; }
+
+    /**
+     * @brief 页脚状态绑定在终端上，不支持 RebindFd：OutputCapture 不会捕获页脚所在的描述符
+     */
+    bool WritesToFd(int fd) const override { return fd == fd_; }
+
+    int Fd() const { return fd_; }
+
+    /**
+     * @brief 设置第 index 个状态行，行数不够时补空行
+     *        超出终端宽度的部分截断，换行符之后的内容忽略
+     */
+    void SetLine(size_t index, PrintColor color, std::string text);
+
+    /**
+     * @brief 设置状态行的行数，多余的行被移除
+     */
+    void SetLineCount(size_t count);
+
+private:
+    friend bool color_printer_detail::ShowIndicatorInFooter(PrintColor color, int dots);
+    friend bool color_printer_detail::ShowLinesInFooter(const void* owner, std::vector<std::string> lines);
+    friend bool color_printer_detail::WriteAboveFooter(PrintColor color, std::string_view text);
+
+    struct Line {
+        PrintColor color = PrintColor::WHITE;
+        std::string text;
+    };
+
+    void SetIndicator(PrintColor color, std::string_view text);
+    void SetOwnedLines(const void* owner, std::vector<std::string> lines);
+    void WriteAbove(PrintColor color, std::string_view text);
+    void Run();
+    void MarkDirtyLocked();
+    void EraseLocked();
+    void DrawLocked(std::chrono::steady_clock::time_point now);
+    void AppendDrawnLocked();
+
+    const int fd_;
+    const bool colored_;
+    const bool interactive_;
+    const std::chrono::milliseconds frame_interval_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<Line> lines_;
+    std::vector<std::pair<const void*, std::vector<std::string>>> owned_lines_;  ///< 进度条、面板的行（可带颜色代码）
+    Line indicator_;              ///< 静默状态指示器，text 为空时不显示；写出消息时清空
+    size_t drawn_lines_ = 0;      ///< 屏幕上当前的页脚行数；光标停在最后一行的末尾
+    bool dirty_ = false;          ///< 页脚需要在下一帧重绘
+    bool lines_removed_ = false;  ///< 有行被移除（进度条结束）：drawn_ 已过时，下一批消息之后立即重绘
+    bool stopping_ = false;
+    std::chrono::steady_clock::time_point drawn_at_;
+    std::string drawn_;           ///< 上次画出的页脚（不含清除序列），消息批次之后原样补回
+    size_t drawn_line_count_ = 0; ///< drawn_ 的行数
+    std::string frame_;           ///< 复用的输出缓冲区
+    std::thread renderer_;
+};
+
+#endif // COLOR_PRINTER_FOOTER_SINK_H
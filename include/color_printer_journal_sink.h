@@ -0,0 +1,111 @@
+/**
+ * @file color_printer_journal_sink.h
+ * @brief 发送到本机 systemd-journald（原生协议）或 syslog（/dev/log）的输出端
+ */
+
+#ifndef COLOR_PRINTER_JOURNAL_SINK_H
+#define COLOR_PRINTER_JOURNAL_SINK_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "color_printer_sink.h"
+
+/**
+ * @enum JournalProtocol
+ * @brief 系统日志协议
+ */
+enum class JournalProtocol {
+    JOURNALD,  ///< journald 原生协议，每条消息是一组 "字段=值"，可携带结构化字段
+    SYSLOG     ///< RFC 3164 格式的 syslog 报文
+};
+
+/**
+ * @struct JournalOptions
+ * @brief 系统日志输出端的配置
+ */
+struct JournalOptions {
+    JournalProtocol protocol = JournalProtocol::JOURNALD;
+    std::string socket_path;    ///< 为空时使用 /run/systemd/journal/socket 或 /dev/log
+    /**
+     * @brief JOURNALD 协议连不上 journald 时改用 syslog 协议发送到 syslog_socket_path；
+     *        每次重新连接时先尝试 journald
+     */
+    bool syslog_fallback = true;
+    std::string syslog_socket_path;  ///< 回退使用的 syslog 套接字，为空时使用 /dev/log
+    std::string identifier;     ///< SYSLOG_IDENTIFIER / syslog 标签，为空时使用程序名
+    int facility = 1;           ///< syslog 设施号，默认 1（LOG_USER）
+    /**
+     * @brief 守护进程接收队列满时最长等待多久；超时后丢弃本批剩余消息，
+     *        并且在下一次发送成功之前不再等待，避免守护进程卡住时拖慢每一批
+     */
+    std::chrono::milliseconds send_timeout{1000};
+    /**
+     * @brief 附加到每条消息的结构化字段（仅 JOURNALD），字段名须为大写字母、数字和下划线
+     */
+    std::vector<std::pair<std::string, std::string>> fields;
+};
+
+/**
+ * @class JournalSink
+ * @brief 通过 unix 数据报套接字写入系统日志
+ *        一批消息用 sendmmsg 一次发送；日志级别映射为 syslog 优先级，
+ *        journald 协议另外携带 COLOR_PRINTER_TYPE（消息类型）与 COLOR_PRINTER_COLOR 字段
+ *        消息总是不带颜色代码；守护进程重启后自动重新连接
+ *        没有 journald 的系统上（容器等）默认回退到 /dev/log 的 syslog（见 JournalOptions::syslog_fallback）
+ */
+class JournalSink : public LogSink {
+public:
+    explicit JournalSink(JournalOptions options = {});
+    ~JournalSink() override;
+
+    JournalSink(const JournalSink&) = delete;
+    JournalSink& operator=(const JournalSink&) = delete;
+
+    void Write(const LogRecord* records, size_t count) override;
+
+    bool WantsColor() const override { return false; }
+
+    bool WritesToFd(int /*fd*/) const override { return false; }
+
+    /**
+     * @brief 因套接字错误或报文过大而丢弃的消息条数
+     */
+    uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 日志级别对应的 syslog 优先级（0~7，数值越小越严重）
+     */
+    static int PriorityForLevel(LogLevel level);
+
+    /**
+     * @brief 当前连接使用的协议；JOURNALD 回退到 syslog 后为 SYSLOG
+     */
+    JournalProtocol ActiveProtocol() const { return active_protocol_.load(std::memory_order_relaxed); }
+
+private:
+    bool Connect();
+    bool ConnectTo(const std::string& path);
+    void BuildDatagrams(const LogRecord* records, size_t count);
+    void AppendJournalMessage(const LogRecord& record);
+    void AppendSyslogMessage(const LogRecord& record);
+    size_t SendBatch(size_t first, size_t count);
+
+    const JournalOptions options_;
+    std::string identifier_;
+
+    std::mutex mutex_;               // 输出端可被多个打印器共享
+    int fd_ = -1;
+    std::atomic<JournalProtocol> active_protocol_;
+    bool congested_ = false;         // 上次发送超时，之后以非阻塞方式尝试
+    std::string datagrams_;          // 本批所有报文首尾相接
+    std::vector<size_t> boundaries_; // 各报文在 datagrams_ 中的起点，末尾追加总长度
+    std::atomic<uint64_t> dropped_{0};
+};
+
+#endif // COLOR_PRINTER_JOURNAL_SINK_H
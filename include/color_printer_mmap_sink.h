@@ -0,0 +1,104 @@
+/**
+ * @file color_printer_mmap_sink.h
+ * @brief 内存映射的环形日志文件输出端
+ */
+
+#ifndef COLOR_PRINTER_MMAP_SINK_H
+#define COLOR_PRINTER_MMAP_SINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "color_printer_sink.h"
+
+/**
+ * @struct MmapRingHeader
+ * @brief 环形日志文件头（位于文件开头，占一页）
+ *        数据区紧随其后，长度为 capacity，实际使用向下取整到8字节的部分；
+ *        head 为累计预留的字节数，写入位置为 head % 数据区长度
+ *
+ *        每批消息写成一帧：8字节提交标记、8字节正文长度、正文，整帧补齐到8字节。
+ *        提交标记在正文拷贝完成后才写入，值为该帧起始位置（累计字节数）按位取反，
+ *        读取方据此识别已完成的帧，跳过正在写或写入方中途崩溃留下的帧以及上一圈的旧数据
+ */
+struct MmapRingHeader {
+    static constexpr char kMagic[8] = {'C', 'P', 'R', 'I', 'N', 'G', '2', '\0'};
+    static constexpr uint64_t kDataOffset = 4096;
+    static constexpr uint64_t kFrameHeader = 16;
+
+    char magic[8];
+    uint64_t capacity;
+    std::atomic<uint64_t> head;
+
+    /**
+     * @brief 数据区中实际使用的字节数（8字节对齐，保证帧头的每个字不跨越回绕点）
+     */
+    static uint64_t RingBytes(uint64_t capacity) { return capacity & ~uint64_t{7}; }
+
+    /**
+     * @brief 正文为 payload 字节的帧占用的字节数
+     */
+    static uint64_t FrameBytes(uint64_t payload) { return (kFrameHeader + payload + 7) & ~uint64_t{7}; }
+};
+
+/**
+ * @class MmapRingSink
+ * @brief 固定大小、mmap 映射的环形日志文件
+ *        写入方用一次原子 fetch_add 为整批预留一帧，memcpy 后写入提交标记，热路径上没有系统调用；
+ *        数据位于共享映射的页缓存中，进程崩溃后内核仍会把它写回文件
+ *        已存在且容量相同的文件会被继续追加，进程重启后保留历史；
+ *        其他非空文件（不是环形日志或容量不同）拒绝打开，不会被截断
+ *        可由多个打印器（甚至多个进程）同时写入
+ */
+class MmapRingSink : public LogSink {
+public:
+    /**
+     * @param path 文件路径
+     * @param capacity 数据区大小（字节）
+     * @param colored 是否保留颜色代码；默认不保留，由读取工具按级别着色
+     */
+    MmapRingSink(const std::string& path, uint64_t capacity, bool colored = false);
+    ~MmapRingSink() override;
+
+    MmapRingSink(const MmapRingSink&) = delete;
+    MmapRingSink& operator=(const MmapRingSink&) = delete;
+
+    /**
+     * @brief 文件是否成功映射；失败（包括文件不是同容量的环形日志）时写入被丢弃
+     */
+    bool IsOpen() const { return header_ != nullptr; }
+
+    void Write(const LogRecord* records, size_t count) override;
+
+    /**
+     * @brief 请求内核异步写回映射的页（msync MS_ASYNC）
+     */
+    void Flush() override;
+
+    bool WantsColor() const override { return colored_; }
+
+    bool WritesToFd(int /*fd*/) const override { return false; }
+
+    /**
+     * @brief 按时间顺序读取环形日志文件的内容
+     *        只输出已提交的帧；尚未提交（正在写入或写入方已崩溃）的帧被跳过，
+     *        读取期间被新数据覆盖的旧帧也会丢弃，不会输出上一圈的旧数据或拼接出的半行
+     *
+     * @param path 文件路径
+     * @param out 输出按时间顺序排列的完整行
+     * @return 文件格式正确时返回true
+     */
+    static bool ReadChronological(const std::string& path, std::string& out);
+
+private:
+    void Copy(uint64_t position, const char* data, size_t length);
+
+    MmapRingHeader* header_ = nullptr;
+    char* data_ = nullptr;
+    uint64_t capacity_ = 0;  ///< 数据区实际使用的字节数
+    size_t mapped_bytes_ = 0;
+    bool colored_;
+};
+
+#endif // COLOR_PRINTER_MMAP_SINK_H
@@ -0,0 +1,180 @@
+/**
+ * @file color_printer_network_sink.h
+ * @brief 通过 TCP/UDP 把日志按批发送到收集端的输出端
+ */
+
+#ifndef COLOR_PRINTER_NETWORK_SINK_H
+#define COLOR_PRINTER_NETWORK_SINK_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <vector>
+
+#include "color_printer_sink.h"
+
+/**
+ * @enum NetworkProtocol
+ * @brief 传输协议
+ */
+enum class NetworkProtocol {
+    TCP,  ///< 可靠传输；断线期间批次留在本地缓存中，重连后继续发送
+    UDP   ///< 每批一个数据报，丢包由收集端按序号统计
+};
+
+/**
+ * @enum NetworkFormat
+ * @brief 批内消息的编码
+ */
+enum class NetworkFormat : uint8_t {
+    LINES = 0,   ///< 渲染好的不带颜色代码的行
+    RECORDS = 1  ///< 每条消息一行 JSON：{"level":…,"type":…,"color":…,"message":…}
+};
+
+/**
+ * @struct NetworkFrameHeader
+ * @brief 每批消息的帧头（32字节，小端），紧跟 payload_bytes 字节的消息
+ *        first_record 为批内第一条消息在该输出端所有消息中的序号，
+ *        收集端据此按 stream_id 统计丢失的消息（包括本地缓存溢出丢弃的）
+ */
+struct NetworkFrameHeader {
+    static constexpr char kMagic[4] = {'C', 'P', 'N', 'F'};
+
+    char magic[4];
+    uint8_t format;          ///< NetworkFormat
+    uint8_t reserved[3];
+    uint32_t payload_bytes;
+    uint32_t record_count;
+    uint64_t stream_id;      ///< 每个输出端实例随机生成
+    uint64_t first_record;
+};
+
+static_assert(sizeof(NetworkFrameHeader) == 32, "网络帧头必须为32字节");
+
+/**
+ * @struct NetworkOptions
+ * @brief 网络输出端的配置
+ */
+struct NetworkOptions {
+    std::string host = "127.0.0.1";
+    uint16_t port = 5140;
+    NetworkProtocol protocol = NetworkProtocol::TCP;
+    NetworkFormat format = NetworkFormat::LINES;
+    size_t batch_bytes = 64 * 1024;                     ///< 一批的最大字节数（UDP 不超过单个数据报）
+    std::chrono::milliseconds batch_interval{100};      ///< 一批最长等待多久就发送
+    size_t spool_bytes = 16 * 1024 * 1024;              ///< 待发送批次的内存上限，超出时丢弃最旧的批次
+    std::chrono::milliseconds reconnect_min{100};       ///< 重连退避的初始间隔，每次失败加倍
+    std::chrono::milliseconds reconnect_max{5000};      ///< 重连退避的最大间隔
+    std::chrono::milliseconds flush_timeout{2000};      ///< Flush 与析构时最长等待发送完成的时间
+};
+
+/**
+ * @class NetworkSink
+ * @brief 网络输出端
+ *        写入方只把消息编码进当前批次；连接、发送与重连都在后台线程上用非阻塞套接字完成，
+ *        收集端不可达时写入方不会等待，超出缓存上限的最旧批次被丢弃并计数
+ */
+class NetworkSink : public LogSink {
+public:
+    explicit NetworkSink(NetworkOptions options);
+
+    /**
+     * @brief 在 flush_timeout 内尽量发出剩余批次，然后停止后台线程
+     */
+    ~NetworkSink() override;
+
+    NetworkSink(const NetworkSink&) = delete;
+    NetworkSink& operator=(const NetworkSink&) = delete;
+
+    void Write(const LogRecord* records, size_t count) override;
+
+    /**
+     * @brief 结束当前批次并等待缓存发空，最多等待 flush_timeout
+     */
+    void Flush() override;
+
+    bool WantsColor() const override { return false; }
+
+    bool WritesToFd(int /*fd*/) const override { return false; }
+
+    /**
+     * @brief 已发出的消息条数
+     */
+    uint64_t Sent() const { return sent_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 因缓存溢出、单条消息超过数据报上限或发送失败而丢弃的消息条数
+     */
+    uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 当前是否已连接到收集端（UDP 为套接字是否可用）
+     */
+    bool Connected() const { return connected_.load(std::memory_order_relaxed); }
+
+private:
+    struct Batch {
+        std::string frame;        // 帧头 + 消息
+        uint32_t records = 0;
+    };
+
+    enum class SendResult { DONE, BLOCKED, FAILED };
+
+    struct Address {
+        int family;
+        int socktype;
+        int protocol;
+        sockaddr_storage storage;
+        socklen_t length;
+    };
+
+    void SenderLoop();
+    void SealBatchLocked();
+    void AppendRecordLocked(const LogRecord& record);
+    bool EnsureConnected();
+    bool ConnectNext();
+    bool PeerClosed() const;
+    void ScheduleReconnect();
+    void Disconnect();
+    SendResult SendInProgress();
+
+    const NetworkOptions options_;
+    const uint64_t stream_id_;
+    const size_t max_batch_bytes_;
+
+    std::mutex mutex_;
+    std::condition_variable sender_cv_;   // 唤醒发送线程
+    std::condition_variable drained_cv_;  // 缓存发空
+    Batch current_;
+    std::chrono::steady_clock::time_point current_started_;
+    uint64_t current_first_ = 0;          // 当前批次第一条消息的序号
+    std::deque<Batch> spool_;
+    size_t spool_bytes_ = 0;
+    uint64_t next_record_ = 0;
+    bool sending_ = false;                // 发送线程手里有一个正在发送的批次
+    bool stop_ = false;
+    std::chrono::steady_clock::time_point stop_deadline_;
+    std::thread sender_;
+
+    std::atomic<uint64_t> sent_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> connected_{false};
+
+    // 以下仅由发送线程访问
+    int fd_ = -1;
+    bool connecting_ = false;
+    std::vector<Address> addresses_;      // 本轮解析出的地址，连接失败时依次尝试下一个
+    size_t next_address_ = 0;
+    Batch in_progress_;                   // 从 spool_ 取出、正在发送的批次
+    size_t sent_offset_ = 0;              // in_progress_ 已发出的字节数（TCP 部分发送）
+    std::chrono::milliseconds backoff_{0};
+    std::chrono::steady_clock::time_point next_attempt_;
+};
+
+#endif // COLOR_PRINTER_NETWORK_SINK_H
@@ -0,0 +1,182 @@
+/**
+ * @file color_printer_shm_sink.h
+ * @brief 多进程共享内存日志总线：各进程无锁写入同一个环形缓冲区，由单独的收集进程着色后输出
+ */
+
+#ifndef COLOR_PRINTER_SHM_SINK_H
+#define COLOR_PRINTER_SHM_SINK_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+
+#include "color_printer_sink.h"
+
+/**
+ * @struct ShmBusHeader
+ * @brief 共享内存段开头的控制块（占一页），数据区紧随其后
+ *        head 为生产者累计预留的字节数，tail 为收集端累计消费的字节数，
+ *        二者之差不超过 capacity；各计数器独占缓存行
+ *        head 的每个取值都是记录边界（预留总是从当时的 head 开始）
+ */
+struct ShmBusHeader {
+    static constexpr char kMagic[8] = {'C', 'P', 'S', 'H', 'M', 'B', '3', '\0'};
+    static constexpr uint64_t kDataOffset = 4096;
+    static constexpr uint64_t kCollectorTimeoutMs = 3000;  ///< 心跳超过该时长未更新视为收集端已退出
+
+    char magic[8];
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint64_t> dropped;           ///< 缓冲区满或被收集端跳过而丢弃的消息条数
+    alignas(64) std::atomic<uint64_t> resync_bytes;      ///< 收集端越过长度未知的停滞记录时丢弃的字节数
+    alignas(64) std::atomic<uint32_t> collector_waiting; ///< 收集端正在休眠，生产者提交后需要唤醒
+    std::atomic<uint32_t> wake_seq;                      ///< futex 字
+    alignas(64) std::atomic<uint64_t> heartbeat_ms;      ///< 收集端最近一次 Drain/WaitForData 的时间（CLOCK_MONOTONIC 毫秒）
+    std::atomic<uint32_t> retired;                       ///< 总线已被移除或替换，生产者应重新连接
+};
+
+/**
+ * @struct ShmRecordHeader
+ * @brief 数据区中每条消息的头（8字节），后跟不带颜色代码的一行；整条记录按8字节对齐
+ *        state 的低30位为记录总长度（含头），kBusy 表示已预留、尚未写完，
+ *        kPadding 表示跳到数据区开头的填充记录；为0表示该位置尚未被预留，
+ *        或者已被预留但生产者还没写入记录头
+ *
+ *        生产者在预留（CAS）之后、写完之前被杀死时，记录永远停在 kBusy 或 0：
+ *        收集端在同一位置停滞超过超时时间（color_printer_collect 为1秒）后跳过它，见 ShmBusSink::Drain
+ */
+struct ShmRecordHeader {
+    static constexpr uint32_t kBusy = 1u << 31;
+    static constexpr uint32_t kPadding = 1u << 30;
+    static constexpr uint32_t kLengthMask = kPadding - 1;
+
+    std::atomic<uint32_t> state;
+    uint8_t color;   ///< PrintColor
+    uint8_t level;   ///< LogLevel
+    uint16_t reserved;
+};
+
+static_assert(sizeof(ShmRecordHeader) == 8, "共享内存记录头必须为8字节");
+
+/**
+ * @class ShmBusSink
+ * @brief 写入共享内存日志总线的输出端
+ *        生产者用一次 CAS 预留空间、memcpy 后提交，热路径上没有系统调用；
+ *        只有收集端空闲休眠时，第一个提交的生产者才会用一次 futex 唤醒它
+ *        总线不存在（收集端未启动）或已被移除时退回直接写标准输出，
+ *        并在之后的写入中每隔 kAttachIntervalMs 重新尝试连接
+ */
+class ShmBusSink : public LogSink {
+public:
+    /**
+     * @param name 共享内存对象名，例如 "/color_printer_bus"
+     * @param block_when_full 缓冲区满时等待收集端腾出空间；为false时丢弃并计数。
+     *        收集端心跳超过 ShmBusHeader::kCollectorTimeoutMs 未更新（多半已经退出）时不再等待，同样丢弃并计数
+     */
+    explicit ShmBusSink(const std::string& name, bool block_when_full = true);
+    ~ShmBusSink() override;
+
+    ShmBusSink(const ShmBusSink&) = delete;
+    ShmBusSink& operator=(const ShmBusSink&) = delete;
+
+    static constexpr uint64_t kAttachIntervalMs = 1000;  ///< 未连接时重新尝试连接的最短间隔
+
+    /**
+     * @brief 是否已连接到总线
+     */
+    bool IsOpen() const { return bus_.load(std::memory_order_acquire) != nullptr; }
+
+    void Write(const LogRecord* records, size_t count) override;
+
+    /**
+     * @brief 总线上未连接时写标准输出需要颜色代码，否则由收集端着色
+     */
+    bool WantsColor() const override { return !IsOpen(); }
+
+    /**
+     * @brief 未连接到总线时写标准输出
+     */
+    bool WritesToFd(int fd) const override;
+
+    /**
+     * @brief 创建总线，由收集端调用
+     *        已有同名、同容量且未被移除的总线时直接接管（上一个收集端崩溃后重启的情形），
+     *        其中尚未取出的记录保留，已连接的生产者不受影响；若它的收集端心跳仍在更新，
+     *        最多等待 ShmBusHeader::kCollectorTimeoutMs，仍未超时则视为另一个收集端在运行，返回空指针。
+     *        容量不同时把旧总线标记为已移除后新建，已连接的生产者随后重新连接
+     *
+     * @return 映射的控制块，失败时返回空指针；用 Remove 或 Unmap 释放
+     */
+    static ShmBusHeader* Create(const std::string& name, uint64_t capacity);
+
+    /**
+     * @brief 收集端退出时移除总线：标记为已移除、删除共享内存对象并解除映射
+     *        已连接的生产者随后退回写标准输出，直到新的收集端创建总线
+     */
+    static void Remove(const std::string& name, ShmBusHeader* header);
+
+    /**
+     * @brief 解除 Create 返回的映射
+     */
+    static void Unmap(ShmBusHeader* header);
+
+    static constexpr uint64_t kNotStuck = UINT64_MAX;  ///< Drain 的 stuck_head：没有停滞
+
+    /**
+     * @brief 从总线取出已提交的连续记录，收集端调用（单消费者）
+     *        被取出的空间清零后归还给生产者；同时更新收集端心跳
+     *
+     * @param max_bytes 本次最多消费的字节数
+     * @param stuck_head tail 长时间停在同一条记录上时（写入它的进程多半已退出），传入停滞开始时观察到的 head，
+     *        否则传 kNotStuck。停滞的记录已写入长度（kBusy）时只跳过这一条；还没有记录头时长度未知，
+     *        直接跳到 stuck_head，其间的字节计入 resync_bytes。停滞开始前预留的生产者都已有整个超时时间
+     *        写完，跳过后归还的空间不会再被它们写入。两种情况都至少丢失一条消息，计入 dropped
+     * @param on_record 回调，参数为颜色、级别与一行（以'\n'结尾）
+     * @return 消费的记录条数
+     */
+    static size_t Drain(ShmBusHeader* header, uint64_t max_bytes, uint64_t stuck_head,
+                        const std::function<void(PrintColor, LogLevel, std::string_view)>& on_record);
+
+    /**
+     * @brief 收集端没有数据时休眠，直到生产者提交或超时；醒来后更新收集端心跳
+     *        timeout_ms 应远小于 ShmBusHeader::kCollectorTimeoutMs
+     */
+    static void WaitForData(ShmBusHeader* header, int timeout_ms);
+
+private:
+    /**
+     * @struct Bus
+     * @brief 一次连接得到的映射
+     */
+    struct Bus {
+        ShmBusHeader* header;
+        char* data;
+        uint64_t capacity;
+        size_t mapped_bytes;
+    };
+
+    /**
+     * @brief 返回本次写入使用的总线；未连接或总线已被移除时按间隔重新连接，仍不可用返回空指针
+     */
+    Bus* CurrentBus();
+
+    void Attach();
+    void Append(Bus& bus, const LogRecord& record);
+
+    const std::string name_;
+    const bool block_when_full_;
+    FdSink fallback_{STDOUT_FILENO};  ///< 未连接时整批写标准输出（合并为一次 write/writev）
+    std::atomic<Bus*> bus_{nullptr};
+    std::atomic<uint64_t> next_attach_ms_{0};
+    std::mutex attach_mutex_;
+    std::vector<std::unique_ptr<Bus>> buses_;  ///< 连接过的全部映射；其他线程可能仍在写旧映射，析构时才解除
+};
+
+#endif // COLOR_PRINTER_SHM_SINK_H
@@ -0,0 +1,118 @@
+/**
+ * @file color_printer_sink.h
+ * @brief 输出端（Sink）接口
+ *        打印器把渲染好的消息按批交给输出端，输出端负责写到具体的目的地
+ */
+
+#ifndef COLOR_PRINTER_SINK_H
+#define COLOR_PRINTER_SINK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "color_printer_types.h"
+
+/**
+ * @struct LogRecord
+ * @brief 一条已渲染的消息
+ *        所有视图只在 LogSink::Write 调用期间有效，需要保留时由输出端自行拷贝
+ */
+struct LogRecord {
+    PrintColor color;
+    LogLevel level;
+    std::string_view type;     ///< 消息类型，例如 "INFO"
+    std::string_view message;  ///< 消息正文（不含前缀与换行）
+    std::string_view line;     ///< 完整的一行，以'\n'结尾；是否带颜色代码取决于 WantsColor()
+    uint32_t escape_head = 0;  ///< line 开头颜色代码的字节数，不带颜色时为0
+    uint32_t escape_tail = 0;  ///< line 末尾换行前重置代码的字节数，不带颜色时为0
+
+    /**
+     * @brief 去掉颜色代码与换行后的行内容；line 不带颜色时即 line 去掉末尾的换行
+     */
+    std::string_view Plain() const {
+        return line.substr(escape_head, line.size() - escape_head - escape_tail - 1);
+    }
+};
+
+/**
+ * @class LogSink
+ * @brief 输出端基类
+ *        Write 由打印器串行调用（同一打印器不会并发调用同一输出端），
+ *        同一输出端被多个打印器共享时需要自行加锁
+ */
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+
+    /**
+     * @brief 写出一批消息
+     *        批内消息的 line 在内存中通常是连续的，可以合并为一次写入
+     *
+     * @param records 消息数组
+     * @param count 消息条数
+     */
+    virtual void Write(const LogRecord* records, size_t count) = 0;
+
+    /**
+     * @brief 把输出端自身缓冲的内容写出
+     */
+    virtual void Flush() {}
+
+    /**
+     * @brief 是否需要带颜色代码的行
+     */
+    virtual bool WantsColor() const { return true; }
+
+    /**
+     * @brief 是否可能写入文件描述符 fd（由调用者提供的描述符，例如 FdSink 的 fd）
+     *        ColorPrinter::OutputCapture 据此判断打印器的输出会不会被重定向回管道；
+     *        默认返回true：自定义输出端写到哪里无从确认。只写自己打开的文件、套接字的输出端返回false
+     */
+    virtual bool WritesToFd(int /*fd*/) const { return true; }
+
+    /**
+     * @brief 返回一个把对 from_fd 的写入改为写入 to_fd、其余行为相同的新输出端，不支持时返回空指针
+     *        OutputCapture 捕获期间用它让打印器继续写入原来的终端
+     */
+    virtual std::shared_ptr<LogSink> RebindFd(int /*from_fd*/, int /*to_fd*/) const { return nullptr; }
+};
+
+/**
+ * @class FdSink
+ * @brief 写入文件描述符的输出端（默认打印器使用 STDOUT_FILENO）
+ *        连续的行合并为一次 write，不连续时使用 writev
+ *        带颜色时，同一批内相邻同色行之间的重置代码和颜色代码被省去，每批以重置代码结束
+ */
+class FdSink : public LogSink {
+public:
+    /**
+     * @param fd 目标文件描述符（不接管所有权）
+     * @param colored 是否输出颜色代码
+     */
+    explicit FdSink(int fd, bool colored = true);
+
+    void Write(const LogRecord* records, size_t count) override;
+
+    bool WantsColor() const override { return colored_; }
+
+    int Fd() const { return fd_; }
+
+    bool WritesToFd(int fd) const override { return fd == fd_; }
+
+    std::shared_ptr<LogSink> RebindFd(int from_fd, int to_fd) const override;
+
+    /**
+     * @brief 累计省去的颜色代码字节数
+     */
+    uint64_t EscapeBytesSaved() const { return escape_bytes_saved_.load(std::memory_order_relaxed); }
+
+private:
+    int fd_;
+    bool colored_;
+    std::atomic<uint64_t> escape_bytes_saved_{0};
+};
+
+#endif // COLOR_PRINTER_SINK_H
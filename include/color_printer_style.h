@@ -0,0 +1,324 @@
+/**
+ * @file color_printer_style.h
+ * @brief 终端样式：16色 / 256色 / 24位真彩色的前景与背景，以及粗体、暗淡、斜体、下划线
+ *        样式的转义序列由 constexpr 函数生成，常量样式在编译期就得到各颜色深度下的序列
+ */
+
+#ifndef COLOR_PRINTER_STYLE_H
+#define COLOR_PRINTER_STYLE_H
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "color_printer_types.h"
+
+/**
+ * @enum ColorDepth
+ * @brief 终端支持的颜色深度，高于该深度的颜色按最近的颜色降级输出
+ */
+enum class ColorDepth : uint8_t {
+    BASIC16,     ///< 16色（SGR 30-37 / 90-97）
+    INDEXED256,  ///< 256色（SGR 38;5;n）
+    TRUECOLOR    ///< 24位真彩色（SGR 38;2;r;g;b）
+};
+
+/**
+ * @struct TermColor
+ * @brief 打包在32位中的一种颜色：第24-25位为种类（0 默认、1 16色、2 256色、3 24位），
+ *        低24位为颜色索引或 0xRRGGBB
+ */
+struct TermColor {
+    uint32_t packed = 0;
+
+    static constexpr uint32_t kDefault = 0;
+    static constexpr uint32_t kBasic = 1;
+    static constexpr uint32_t kIndexed = 2;
+    static constexpr uint32_t kRgb = 3;
+
+    /**
+     * @brief 终端的默认颜色
+     */
+    static constexpr TermColor Default() { return TermColor{}; }
+
+    /**
+     * @brief 16色中的一种：0-7 为标准色（黑红绿黄蓝品红青白），8-15 为对应的亮色
+     */
+    static constexpr TermColor Basic(uint8_t index) { return TermColor{(kBasic << 24) | (index & 15u)}; }
+
+    /**
+     * @brief 256色调色板中的一种
+     */
+    static constexpr TermColor Indexed(uint8_t index) { return TermColor{(kIndexed << 24) | index}; }
+
+    /**
+     * @brief 24位真彩色
+     */
+    static constexpr TermColor Rgb(uint8_t red, uint8_t green, uint8_t blue) {
+        return TermColor{(kRgb << 24) | (uint32_t{red} << 16) | (uint32_t{green} << 8) | blue};
+    }
+
+    constexpr uint32_t Kind() const { return packed >> 24; }
+    constexpr uint32_t Value() const { return packed & 0xFFFFFFu; }
+
+    constexpr bool operator==(const TermColor&) const = default;
+};
+
+/**
+ * @struct Style
+ * @brief 打包在64位中的样式：第0-25位前景色、第26-51位背景色（TermColor），第52-55位字体标志
+ *        可以作为模板参数，见 ColorPrinter::PrintStyledMessage
+ *
+ * @note 使用示例：
+ *       constexpr Style kAlert = Style::Of(PrintColor::RED).Bold().Background(TermColor::Indexed(236));
+ *       ColorPrinter::PrintStyledMessage<kAlert>("ERROR", "磁盘已满");
+ */
+struct Style {
+    uint64_t packed = 0;
+
+    static constexpr uint64_t kBold = 1;
+    static constexpr uint64_t kDim = 2;
+    static constexpr uint64_t kItalic = 4;
+    static constexpr uint64_t kUnderline = 8;
+
+    /**
+     * @brief 与 PrintColor 相同颜色的样式
+     */
+    static constexpr Style Of(PrintColor color) {
+        return Style{}.Foreground(TermColor::Basic(static_cast<uint8_t>(static_cast<int>(color) + 1)));
+    }
+
+    constexpr TermColor Fg() const { return TermColor{static_cast<uint32_t>(packed & kColorMask)}; }
+    constexpr TermColor Bg() const { return TermColor{static_cast<uint32_t>((packed >> 26) & kColorMask)}; }
+    constexpr uint64_t Flags() const { return packed >> 52; }
+
+    constexpr Style Foreground(TermColor color) const {
+        return Style{(packed & ~kColorMask) | color.packed};
+    }
+    constexpr Style Background(TermColor color) const {
+        return Style{(packed & ~(kColorMask << 26)) | (uint64_t{color.packed} << 26)};
+    }
+    constexpr Style Bold() const { return Style{packed | (kBold << 52)}; }
+    constexpr Style Dim() const { return Style{packed | (kDim << 52)}; }
+    constexpr Style Italic() const { return Style{packed | (kItalic << 52)}; }
+    constexpr Style Underline() const { return Style{packed | (kUnderline << 52)}; }
+
+    constexpr bool operator==(const Style&) const = default;
+
+    static constexpr uint64_t kColorMask = (uint64_t{1} << 26) - 1;
+};
+
+/**
+ * @struct EscapeCode
+ * @brief 定长缓冲区中的一个 SGR 转义序列，可在编译期构造
+ */
+struct EscapeCode {
+    char data[48] = {};
+    uint8_t size = 0;
+
+    constexpr std::string_view View() const { return std::string_view(data, size); }
+};
+
+namespace color_printer_detail {
+
+/**
+ * @brief xterm 默认的16色调色板
+ */
+inline constexpr uint8_t kBasicPalette[16][3] = {
+    {0, 0, 0},       {205, 0, 0},     {0, 205, 0},     {205, 205, 0},
+    {0, 0, 238},     {205, 0, 205},   {0, 205, 205},   {229, 229, 229},
+    {127, 127, 127}, {255, 0, 0},     {0, 255, 0},     {255, 255, 0},
+    {92, 92, 255},   {255, 0, 255},   {0, 255, 255},   {255, 255, 255}};
+
+inline constexpr uint8_t kCubeLevels[6] = {0, 95, 135, 175, 215, 255};
+
+constexpr uint8_t CubeIndex(uint8_t value) {
+    return value < 48 ? 0 : value < 115 ? 1 : static_cast<uint8_t>((value - 35) / 40);
+}
+
+/**
+ * @brief 24位颜色对应的256色索引（6x6x6 色立方或24级灰阶中较近的一个）
+ */
+constexpr uint8_t RgbTo256(uint32_t rgb) {
+    const int red = static_cast<int>(rgb >> 16);
+    const int green = static_cast<int>((rgb >> 8) & 0xFF);
+    const int blue = static_cast<int>(rgb & 0xFF);
+    const uint8_t r = CubeIndex(static_cast<uint8_t>(red));
+    const uint8_t g = CubeIndex(static_cast<uint8_t>(green));
+    const uint8_t b = CubeIndex(static_cast<uint8_t>(blue));
+    const int cube_distance = (kCubeLevels[r] - red) * (kCubeLevels[r] - red) +
+                              (kCubeLevels[g] - green) * (kCubeLevels[g] - green) +
+                              (kCubeLevels[b] - blue) * (kCubeLevels[b] - blue);
+    const int average = (red + green + blue) / 3;
+    const int gray = average < 8 ? 0 : average > 238 ? 23 : (average - 8) / 10;
+    const int level = 8 + gray * 10;
+    const int gray_distance = (level - red) * (level - red) + (level - green) * (level - green) +
+                              (level - blue) * (level - blue);
+    return gray_distance < cube_distance ? static_cast<uint8_t>(232 + gray)
+                                         : static_cast<uint8_t>(16 + 36 * r + 6 * g + b);
+}
+
+/**
+ * @brief 256色索引对应的24位颜色
+ */
+constexpr uint32_t IndexedToRgb(uint8_t index) {
+    if (index < 16) {
+        return (uint32_t{kBasicPalette[index][0]} << 16) | (uint32_t{kBasicPalette[index][1]} << 8) |
+               kBasicPalette[index][2];
+    }
+    if (index >= 232) {
+        const uint32_t level = 8 + (index - 232u) * 10;
+        return (level << 16) | (level << 8) | level;
+    }
+    const int cube = index - 16;
+    return (uint32_t{kCubeLevels[cube / 36]} << 16) | (uint32_t{kCubeLevels[cube / 6 % 6]} << 8) |
+           kCubeLevels[cube % 6];
+}
+
+/**
+ * @brief 24位颜色在16色调色板中最近的一种
+ */
+constexpr uint8_t RgbTo16(uint32_t rgb) {
+    const int red = static_cast<int>(rgb >> 16);
+    const int green = static_cast<int>((rgb >> 8) & 0xFF);
+    const int blue = static_cast<int>(rgb & 0xFF);
+    uint8_t best = 0;
+    int best_distance = 1 << 30;
+    for (uint8_t i = 0; i < 16; i++) {
+        const int dr = kBasicPalette[i][0] - red;
+        const int dg = kBasicPalette[i][1] - green;
+        const int db = kBasicPalette[i][2] - blue;
+        const int distance = dr * dr + dg * dg + db * db;
+        if (distance < best_distance) {
+            best = i;
+            best_distance = distance;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief 把颜色降级到终端支持的深度
+ */
+constexpr TermColor Downgrade(TermColor color, ColorDepth depth) {
+    switch (color.Kind()) {
+        case TermColor::kRgb:
+            if (depth == ColorDepth::TRUECOLOR) {
+                return color;
+            }
+            return depth == ColorDepth::INDEXED256 ? TermColor::Indexed(RgbTo256(color.Value()))
+                                                   : TermColor::Basic(RgbTo16(color.Value()));
+        case TermColor::kIndexed:
+            if (depth != ColorDepth::BASIC16 || color.Value() < 16) {
+                return color.Value() < 16 ? TermColor::Basic(static_cast<uint8_t>(color.Value())) : color;
+            }
+            return TermColor::Basic(RgbTo16(IndexedToRgb(static_cast<uint8_t>(color.Value()))));
+        default:
+            return color;
+    }
+}
+
+constexpr void AppendText(EscapeCode& code, std::string_view text) {
+    for (const char c : text) {
+        code.data[code.size++] = c;
+    }
+}
+
+constexpr void AppendNumber(EscapeCode& code, uint32_t value) {
+    char digits[4] = {};
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count > 0) {
+        code.data[code.size++] = digits[--count];
+    }
+}
+
+/**
+ * @brief 追加一个颜色参数（不含分隔符）
+ */
+constexpr void AppendColor(EscapeCode& code, TermColor color, bool background) {
+    const uint32_t value = color.Value();
+    switch (color.Kind()) {
+        case TermColor::kBasic:
+            AppendNumber(code, (value < 8 ? 30 + value : 90 + value - 8) + (background ? 10 : 0));
+            break;
+        case TermColor::kIndexed:
+            AppendText(code, background ? "48;5;" : "38;5;");
+            AppendNumber(code, value);
+            break;
+        default:
+            AppendText(code, background ? "48;2;" : "38;2;");
+            AppendNumber(code, value >> 16);
+            AppendText(code, ";");
+            AppendNumber(code, (value >> 8) & 0xFF);
+            AppendText(code, ";");
+            AppendNumber(code, value & 0xFF);
+            break;
+    }
+}
+
+} // namespace color_printer_detail
+
+/**
+ * @brief 生成样式在给定颜色深度下的 SGR 序列；没有任何属性的样式为空序列
+ */
+constexpr EscapeCode BuildEscape(Style style, ColorDepth depth) {
+    EscapeCode code;
+    const TermColor fg = color_printer_detail::Downgrade(style.Fg(), depth);
+    const TermColor bg = color_printer_detail::Downgrade(style.Bg(), depth);
+    const uint64_t flags = style.Flags();
+    if (fg.Kind() == TermColor::kDefault && bg.Kind() == TermColor::kDefault && flags == 0) {
+        return code;
+    }
+    color_printer_detail::AppendText(code, "\033[");
+    bool first = true;
+    auto separate = [&]() {
+        if (!first) {
+            color_printer_detail::AppendText(code, ";");
+        }
+        first = false;
+    };
+    constexpr uint32_t kFlagCodes[4] = {1, 2, 3, 4};  // 粗体、暗淡、斜体、下划线
+    for (int bit = 0; bit < 4; bit++) {
+        if (flags & (uint64_t{1} << bit)) {
+            separate();
+            color_printer_detail::AppendNumber(code, kFlagCodes[bit]);
+        }
+    }
+    if (fg.Kind() != TermColor::kDefault) {
+        separate();
+        color_printer_detail::AppendColor(code, fg, false);
+    }
+    if (bg.Kind() != TermColor::kDefault) {
+        separate();
+        color_printer_detail::AppendColor(code, bg, true);
+    }
+    color_printer_detail::AppendText(code, "m");
+    return code;
+}
+
+/**
+ * @brief 与样式前景色最接近的 PrintColor，用于 LogRecord::color 等只认识7种颜色的地方
+ *        黑色与默认颜色视为 WHITE
+ */
+constexpr PrintColor NearestPrintColor(Style style) {
+    const TermColor fg = color_printer_detail::Downgrade(style.Fg(), ColorDepth::BASIC16);
+    if (fg.Kind() == TermColor::kDefault) {
+        return PrintColor::WHITE;
+    }
+    const uint32_t index = fg.Value() & 7;
+    return index == 0 ? PrintColor::WHITE : static_cast<PrintColor>(index - 1);
+}
+
+/**
+ * @brief 常量样式在各颜色深度下的 SGR 序列，编译期生成，按 ColorDepth 取下标
+ */
+template <Style S>
+inline constexpr std::array<EscapeCode, 3> kStyleEscapes = {
+    BuildEscape(S, ColorDepth::BASIC16), BuildEscape(S, ColorDepth::INDEXED256),
+    BuildEscape(S, ColorDepth::TRUECOLOR)};
+
+#endif // COLOR_PRINTER_STYLE_H
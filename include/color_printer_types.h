@@ -0,0 +1,39 @@
+/**
+ * @file color_printer_types.h
+ * @brief 彩色打印库的基础类型
+ *        颜色、日志级别等在打印器与输出端之间共享的定义
+ */
+
+#ifndef COLOR_PRINTER_TYPES_H
+#define COLOR_PRINTER_TYPES_H
+
+/**
+ * @enum PrintColor
+ * @brief 打印颜色枚举类
+ */
+enum class PrintColor {
+    RED,
+    GREEN,
+    YELLOW,
+    BLUE,
+    MAGENTA,
+    CYAN,
+    WHITE
+};
+
+/**
+ * @enum LogLevel
+ * @brief 日志级别枚举类
+ *        由消息类型字符串推断（见 ColorPrinter::LevelFromType），
+ *        用于决定消息走同步通道还是后台批量通道
+ */
+enum class LogLevel {
+    DEBUG,
+    INFO,
+    OK,
+    WARNING,
+    ERROR,
+    FATAL
+};
+
+#endif // COLOR_PRINTER_TYPES_H
@@ -4,8 +4,734 @@
  */
 
 #include "color_printer.h"
+#include "color_printer_footer_sink.h"
+#include "color_printer_internal.h"
+#include "color_printer_snapshot.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief 所有打印器交给输出端的批次数，静默状态指示器据此判断期间是否有其他消息输出
+ */
+std::atomic<uint64_t> g_batches_written{0};
+
+std::atomic<int> g_indicator_frame_rate{30};
+
+/**
+ * @brief 直接写终端的指示器绘制互斥执行；g_indicator_draws 为累计绘制次数，
+ *        各指示器据此判断自己上次绘制之后是否有别的指示器（其他线程或其他 StatusIndicator）改写过这一行
+ */
+std::mutex g_indicator_mutex;
+uint64_t g_indicator_draws = 0;
+
+/**
+ * @brief 7种 PrintColor 的颜色代码，编译期生成
+ */
+constexpr std::array<EscapeCode, 7> kPrintColorEscapes = {
+    BuildEscape(Style::Of(PrintColor::RED), ColorDepth::BASIC16),
+    BuildEscape(Style::Of(PrintColor::GREEN), ColorDepth::BASIC16),
+    BuildEscape(Style::Of(PrintColor::YELLOW), ColorDepth::BASIC16),
+    BuildEscape(Style::Of(PrintColor::BLUE), ColorDepth::BASIC16),
+    BuildEscape(Style::Of(PrintColor::MAGENTA), ColorDepth::BASIC16),
+    BuildEscape(Style::Of(PrintColor::CYAN), ColorDepth::BASIC16),
+    BuildEscape(Style::Of(PrintColor::WHITE), ColorDepth::BASIC16)};
+
+std::string_view PrintColorEscape(PrintColor color) {
+    const size_t index = static_cast<size_t>(color);
+    return index < kPrintColorEscapes.size() ? kPrintColorEscapes[index].View() : std::string_view("\033[0m");
+}
+
+/**
+ * @brief 根据 COLORTERM 与 TERM 环境变量检测终端的颜色深度
+ */
+ColorDepth DetectColorDepth() {
+    const char* colorterm = std::getenv("COLORTERM");
+    if (colorterm != nullptr && (std::strcmp(colorterm, "truecolor") == 0 || std::strcmp(colorterm, "24bit") == 0)) {
+        return ColorDepth::TRUECOLOR;
+    }
+    const char* term = std::getenv("TERM");
+    if (term != nullptr && std::strstr(term, "direct") != nullptr) {
+        return ColorDepth::TRUECOLOR;
+    }
+    if (term != nullptr && std::strstr(term, "256color") != nullptr) {
+        return ColorDepth::INDEXED256;
+    }
+    return ColorDepth::BASIC16;
+}
+
+std::atomic<ColorDepth> g_color_depth{DetectColorDepth()};
+
+/**
+ * @brief 运行时样式的转义序列：每个线程一张直接映射的查找表，未命中时生成并替换该槽位
+ *        返回的视图在本线程下一次调用前有效
+ */
+std::string_view CachedStyleEscape(Style style) {
+    struct Entry {
+        uint64_t key = ~uint64_t{0};
+        EscapeCode code;
+    };
+    thread_local std::array<Entry, 64> cache;
+
+    const ColorDepth depth = g_color_depth.load(std::memory_order_relaxed);
+    const uint64_t key = style.packed | (static_cast<uint64_t>(depth) << 56);
+    Entry& entry = cache[(key * 0x9E3779B97F4A7C15ull) >> 58];
+    if (entry.key != key) {
+        entry.key = key;
+        entry.code = BuildEscape(style, depth);
+    }
+    return entry.code.View();
+}
+
+/**
+ * @brief 按 std::ostream 默认格式（%g，6位有效数字）格式化浮点数
+ */
+template <typename T>
+std::string FormatFloating(T value) {
+    char buffer[64];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+    return std::string(buffer, result.ptr);
+}
+
+/**
+ * @brief 追加本地时间 "YYYY-MM-DD HH:MM:SS.mmm "
+ *        每个线程缓存最近一秒的格式化结果，同一秒内只需追加毫秒
+ */
+void AppendTimestamp(std::string& out) {
+    thread_local time_t cached_second = -1;
+    thread_local char cached_text[20];
+
+    const auto now = std::chrono::system_clock::now();
+    const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    const time_t second = static_cast<time_t>(millis / 1000);
+    if (second != cached_second) {
+        tm local_time;
+        localtime_r(&second, &local_time);
+        strftime(cached_text, sizeof(cached_text), "%Y-%m-%d %H:%M:%S", &local_time);
+        cached_second = second;
+    }
+    const int fraction = static_cast<int>(millis % 1000);
+    out.append(cached_text, 19);
+    out += '.';
+    out += static_cast<char>('0' + fraction / 100);
+    out += static_cast<char>('0' + fraction / 10 % 10);
+    out += static_cast<char>('0' + fraction % 10);
+    out += ' ';
+}
+
+/**
+ * @struct DrawnIndicator
+ * @brief 最近一次绘制的静默状态指示器：屏幕上已有的点数，以及绘制时的输出批次数
+ */
+struct DrawnIndicator {
+    const void* owner = nullptr;
+    PrintColor color = PrintColor::WHITE;
+    int dots = 0;
+    uint64_t batches = 0;
+    uint64_t draw = 0;  ///< 绘制后的 g_indicator_draws
+    std::chrono::steady_clock::time_point drawn_at;
+};
+
+/**
+ * @brief 同一指示器距上次绘制是否还不到一帧（见 SetIndicatorFrameRate）
+ */
+bool IndicatorThrottled(const DrawnIndicator& drawn, const void* owner, PrintColor color,
+                        std::chrono::steady_clock::time_point now) {
+    const int frame_rate = g_indicator_frame_rate.load(std::memory_order_relaxed);
+    return drawn.owner == owner && drawn.color == color && frame_rate > 0 &&
+           now - drawn.drawn_at < std::chrono::nanoseconds(std::chrono::seconds(1)) / frame_rate;
+}
+
+/**
+ * @brief 把指示器画成 dots 个点
+ *        屏幕上的内容仍是同一指示器画的前缀时（期间没有其他消息，也没有其他指示器绘制过）只追加新增的点，
+ *        否则回到行首清除整行后重绘
+ *        与消息一样直接 write 到描述符，不经过 std::cout 的缓冲区
+ */
+void DrawIndicator(DrawnIndicator& drawn, const void* owner, PrintColor color, int dots,
+                   std::chrono::steady_clock::time_point now) {
+    dots = std::clamp(dots, 0, 100);
+    // 有状态页脚时画在页脚里，由页脚与消息协调输出
+    if (color_printer_detail::ShowIndicatorInFooter(color, dots)) {
+        drawn.owner = owner;
+        drawn.color = color;
+        drawn.dots = dots;
+        drawn.drawn_at = now;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_indicator_mutex);
+    const bool same = drawn.owner == owner && drawn.color == color && drawn.dots <= dots &&
+                      drawn.draw == g_indicator_draws &&
+                      drawn.batches == g_batches_written.load(std::memory_order_relaxed);
+
+    // 颜色代码 + 最多100个点 + 重置代码，一次写出
+    char frame[160];
+    size_t length = 0;
+    int first_dot = drawn.dots;
+    if (!same) {
+        std::memcpy(frame, "\r\033[2K", 5);  // 回到行首并清除整行
+        length = 5;
+        first_dot = 0;
+    }
+    const std::string color_code = ColorPrinter::GetColorCode(color);
+    std::memcpy(frame + length, color_code.data(), color_code.size());
+    length += color_code.size();
+    if (!same) {
+        std::memcpy(frame + length, "[INFO] ", 7);
+        length += 7;
+    }
+    std::memset(frame + length, '.', static_cast<size_t>(dots - first_dot));
+    length += static_cast<size_t>(dots - first_dot);
+    std::memcpy(frame + length, "\033[0m", 4);
+    length += 4;
+    std::cout.flush();  // 保持与调用者自己的 std::cout 输出的先后顺序
+    color_printer_detail::WriteAll(color_printer_detail::IndicatorFd(), frame, length);
+
+    drawn.owner = owner;
+    drawn.color = color;
+    drawn.dots = dots;
+    drawn.batches = g_batches_written.load(std::memory_order_relaxed);
+    drawn.draw = ++g_indicator_draws;
+    drawn.drawn_at = now;
+}
+
+} // namespace
+
+namespace color_printer_detail {
+
+int IndicatorFd() {
+    const std::shared_ptr<LogSink> sink = ColorPrinter::Default().Sink();
+    if (const auto* fd_sink = dynamic_cast<const FdSink*>(sink.get())) {
+        return fd_sink->Fd();
+    }
+    if (const auto* footer = dynamic_cast<const FooterSink*>(sink.get())) {
+        return footer->Fd();
+    }
+    return STDOUT_FILENO;
+}
+
+} // namespace color_printer_detail
+
+/**
+ * @class ColorPrinter::Printer::Impl
+ * @brief 打印器的输出通道（双通道输出）
+ *        同步通道：级别不低于阈值的消息在调用线程上直接写入输出端
+ *        批量通道：其余消息追加到队列，由后台线程按批（最多 batch_bytes）写出
+ *
+ *        顺序保证：后台线程在持有写锁的情况下取批并写出；同步通道先从队列中
+ *        摘走本线程尚未被取走的消息，再获取写锁写出，因此同一线程内的消息顺序不变，
+ *        而同步消息最多只需等待一个正在写出的批次，不会排在整个积压队列之后
+ *
+ *        协程支持：队列已满时，PrintAsync 的消息连同协程句柄一起挂在 parked_prints_ 上，
+ *        腾出空间后按先后顺序入队并恢复协程；FlushAsync 记录目标序号，
+ *        写出的行数达到该序号后恢复。阻塞式 Submit 也会排在已挂起的消息之后，
+ *        因此入队顺序与接收顺序一致
+ *        未设置调度钩子时协程由专用的恢复线程恢复，输出线程从不运行用户代码
+ */
+class ColorPrinter::Printer::Impl {
+public:
+    using ConfigCell = color_printer_detail::SnapshotCell<PrinterConfig>;
+
+    Impl(std::shared_ptr<LogSink> sink, const PrinterOptions& options)
+        : options_(options), config_(MakeInitialConfig(std::move(sink), options)) {
+        if (options_.deferred) {
+            SetDeferred(true);
+        }
+    }
+
+    ~Impl() {
+        StopWatching();
+        SetDeferred(false);
+        Flush();
+        StopResumer();
+    }
+
+    ConfigCell::ReadGuard ReadConfig() const {
+        return config_.Read();
+    }
+
+    /**
+     * @brief 复制当前输出端的指针后立即释放快照
+     *
+     * 写出可能阻塞任意久，若持有读守卫会让 UpdateConfig 的宽限期一直等待。
+     */
+    std::shared_ptr<LogSink> CurrentSink() const {
+        return ReadConfig()->sink;
+    }
+
+    /**
+     * @brief 基于当前配置修改并发布新快照
+     */
+    void UpdateConfig(const std::function<void(PrinterConfig&)>& edit) {
+        std::lock_guard<std::mutex> update_lock(update_mutex_);
+        auto next = std::make_unique<PrinterConfig>(*config_.Read());
+        const std::shared_ptr<LogSink> previous_sink = next->sink;
+        edit(*next);
+        if (!next->sink) {
+            next->sink = previous_sink;
+        }
+        config_.Publish(std::move(next));
+    }
+
+    bool WatchConfigFile(const std::string& path, ColorPrinter::Printer& printer) {
+        std::lock_guard<std::mutex> watcher_lock(watcher_mutex_);
+        watcher_.reset();
+        watcher_ = std::make_unique<color_printer_detail::ConfigFileWatcher>(
+            path, [this, &printer](const std::string& text) { ApplyConfigText(text, printer); });
+        return watcher_->Start();
+    }
+
+    void StopWatching() {
+        std::lock_guard<std::mutex> watcher_lock(watcher_mutex_);
+        watcher_.reset();
+    }
+
+    void Submit(const RenderedLine& line, bool sync) {
+        if (!sync && deferred_.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+            // 队列积压过多时阻塞生产者，避免内存无限增长
+            space_cv_.wait(queue_lock, [this] { return HasSpaceLocked() || !running_; });
+            if (running_) {
+                EnqueueLocked(std::this_thread::get_id(), line);
+                return;
+            }
+        }
+        WriteSync(line);
+    }
+
+    /**
+     * @brief 非阻塞提交，返回false表示队列已满需要挂起
+     */
+    bool TryAccept(const RenderedLine& line, bool sync) {
+        if (!sync && deferred_.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+            if (running_) {
+                if (!HasSpaceLocked()) {
+                    return false;
+                }
+                EnqueueLocked(std::this_thread::get_id(), line);
+                return true;
+            }
+        }
+        WriteSync(line);
+        return true;
+    }
+
+    /**
+     * @brief 挂起一条消息直到队列腾出空间，返回false表示无需挂起（已被接收）
+     */
+    bool ParkPrint(RenderedLine& line, std::coroutine_handle<> handle) {
+        std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+        if (!running_) {
+            queue_lock.unlock();
+            WriteSync(line);
+            return false;
+        }
+        if (HasSpaceLocked()) {
+            EnqueueLocked(std::this_thread::get_id(), line);
+            return false;
+        }
+        parked_prints_.push_back({handle, std::move(line), std::this_thread::get_id()});
+        queue_cv_.notify_one();
+        return true;
+    }
+
+    bool FlushReady() {
+        std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+        return FlushTargetLocked() <= written_total_;
+    }
+
+    /**
+     * @brief 挂起协程直到当前已提交的消息全部写出，返回false表示无需挂起
+     */
+    bool ParkFlush(std::coroutine_handle<> handle) {
+        std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+        const uint64_t target = FlushTargetLocked();
+        if (target <= written_total_) {
+            return false;
+        }
+        flush_waiters_.push_back({handle, target});
+        queue_cv_.notify_one();
+        return true;
+    }
+
+    void SetScheduler(std::function<void(std::coroutine_handle<>)> scheduler) {
+        std::lock_guard<std::mutex> scheduler_lock(scheduler_mutex_);
+        scheduler_ = std::move(scheduler);
+    }
+
+    void SetDeferred(bool enabled) {
+        std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+        if (enabled == running_) {
+            return;
+        }
+        running_ = enabled;
+        deferred_.store(enabled, std::memory_order_release);
+        if (enabled) {
+            worker_ = std::thread(&Impl::WorkerLoop, this);
+            return;
+        }
+        queue_cv_.notify_all();
+        space_cv_.notify_all();
+        queue_lock.unlock();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+        Drain();
+    }
+
+    void Flush() {
+        Drain();
+        std::lock_guard<std::mutex> write_lock(write_mutex_);
+        CurrentSink()->Flush();
+    }
+
+private:
+    struct PendingLine {
+        std::thread::id owner;
+        size_t offset;
+        uint32_t length;  // 为0表示已被同步通道提前带走
+        uint32_t type_offset;
+        uint32_t type_length;
+        uint32_t message_offset;
+        uint32_t message_length;
+        uint16_t escape_head;
+        uint16_t escape_tail;
+        PrintColor color;
+        LogLevel level;
+    };
+
+    struct ParkedPrint {
+        std::coroutine_handle<> handle;
+        RenderedLine line;
+        std::thread::id owner;
+    };
+
+    struct FlushWaiter {
+        std::coroutine_handle<> handle;
+        uint64_t target;  // written_total_ 达到该值后恢复
+    };
+
+    static constexpr size_t kCompactLines = 4096;
+
+    static std::unique_ptr<const PrinterConfig> MakeInitialConfig(std::shared_ptr<LogSink> sink,
+                                                                  const PrinterOptions& options) {
+        auto config = std::make_unique<PrinterConfig>();
+        config->sink = std::move(sink);
+        config->sync_level = options.sync_level;
+        return config;
+    }
+
+    /**
+     * @brief 应用监视到的配置文件内容；解析失败时保留原配置
+     */
+    void ApplyConfigText(const std::string& text, ColorPrinter::Printer& printer) {
+        std::string error;
+        bool parsed = false;
+        UpdateConfig([&](PrinterConfig& config) { parsed = ParseConfig(text, config, &error); });
+        if (!parsed) {
+            printer.PrintColoredMessage(PrintColor::YELLOW, "WARNING", "配置文件解析失败，保留原配置: %s", error.c_str());
+        }
+    }
+
+    static PendingLine MakePending(std::thread::id owner, size_t offset, const RenderedLine& line) {
+        return {owner, offset, static_cast<uint32_t>(line.text.size()),
+                line.type_offset, line.type_length, line.message_offset, line.message_length,
+                line.escape_head, line.escape_tail, line.color, line.level};
+    }
+
+    bool HasSpaceLocked() const {
+        return parked_prints_.empty() && pending_bytes_ < options_.max_pending_bytes;
+    }
+
+    uint64_t FlushTargetLocked() const {
+        return enqueued_total_ + parked_prints_.size();
+    }
+
+    void EnqueueLocked(std::thread::id owner, const RenderedLine& line) {
+        queue_lines_.push_back(MakePending(owner, queue_bytes_.size(), line));
+        queue_bytes_ += line.text;
+        pending_bytes_ += line.text.size();
+        enqueued_total_++;
+        if (pending_bytes_ >= options_.batch_bytes) {
+            queue_cv_.notify_one();
+        }
+    }
+
+    void WriteSync(const RenderedLine& line) {
+        std::string bytes;
+        std::vector<PendingLine> lines;
+        {
+            std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+            TakeOwnLinesLocked(bytes, lines);
+        }
+        lines.push_back(MakePending(std::this_thread::get_id(), bytes.size(), line));
+        bytes += line.text;
+
+        std::lock_guard<std::mutex> write_lock(write_mutex_);
+        WriteLinesLocked(bytes, lines);
+    }
+
+    /**
+     * @brief 把一段连续的字节及其行信息转换为 LogRecord 交给输出端（需持有写锁）
+     */
+    void WriteLinesLocked(const std::string& bytes, const std::vector<PendingLine>& lines) {
+        records_.clear();
+        for (const PendingLine& pending : lines) {
+            const std::string_view line(bytes.data() + pending.offset, pending.length);
+            records_.push_back({pending.color, pending.level,
+                                line.substr(pending.type_offset, pending.type_length),
+                                line.substr(pending.message_offset, pending.message_length),
+                                line, pending.escape_head, pending.escape_tail});
+        }
+        CurrentSink()->Write(records_.data(), records_.size());
+        g_batches_written.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Drain() {
+        std::string batch;
+        std::vector<PendingLine> batch_lines;
+        while (DrainOnce(batch, batch_lines)) {
+        }
+    }
+
+    /**
+     * @brief 取出一批消息并写出，返回是否还有工作要做
+     *        先持有写锁再取批，保证取走的批次在任何后续同步写入之前落盘
+     */
+    bool DrainOnce(std::string& batch, std::vector<PendingLine>& batch_lines) {
+        std::vector<std::coroutine_handle<>> ready;
+        {
+            std::lock_guard<std::mutex> write_lock(write_mutex_);
+            batch.clear();
+            batch_lines.clear();
+            uint64_t taken = 0;
+            {
+                std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+                if (queue_head_ == queue_lines_.size() && parked_prints_.empty() && flush_waiters_.empty()) {
+                    return false;
+                }
+                TakeBatchLocked(batch, batch_lines);
+                AdmitParkedLocked(ready);
+                taken = taken_total_;
+            }
+            space_cv_.notify_all();
+            if (!batch_lines.empty()) {
+                WriteLinesLocked(batch, batch_lines);
+            }
+            {
+                std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+                written_total_ = taken;
+                CollectFlushWaitersLocked(ready);
+            }
+        }
+        Resume(ready);
+        return true;
+    }
+
+    void TakeBatchLocked(std::string& batch, std::vector<PendingLine>& batch_lines) {
+        while (queue_head_ < queue_lines_.size() && batch.size() < options_.batch_bytes) {
+            PendingLine line = queue_lines_[queue_head_++];
+            taken_total_++;
+            if (line.length == 0) {
+                continue;
+            }
+            pending_bytes_ -= line.length;
+            batch.append(queue_bytes_, line.offset, line.length);
+            line.offset = batch.size() - line.length;
+            batch_lines.push_back(line);
+        }
+        CompactLocked();
+    }
+
+    /**
+     * @brief 队列腾出空间后，按挂起顺序接收协程提交的消息
+     */
+    void AdmitParkedLocked(std::vector<std::coroutine_handle<>>& ready) {
+        size_t admitted = 0;
+        while (admitted < parked_prints_.size() && pending_bytes_ < options_.max_pending_bytes) {
+            ParkedPrint& parked = parked_prints_[admitted++];
+            queue_lines_.push_back(MakePending(parked.owner, queue_bytes_.size(), parked.line));
+            queue_bytes_ += parked.line.text;
+            pending_bytes_ += parked.line.text.size();
+            enqueued_total_++;
+            ready.push_back(parked.handle);
+        }
+        parked_prints_.erase(parked_prints_.begin(), parked_prints_.begin() + static_cast<std::ptrdiff_t>(admitted));
+    }
+
+    void CollectFlushWaitersLocked(std::vector<std::coroutine_handle<>>& ready) {
+        auto done = std::stable_partition(flush_waiters_.begin(), flush_waiters_.end(),
+                                          [this](const FlushWaiter& waiter) { return waiter.target > written_total_; });
+        for (auto it = done; it != flush_waiters_.end(); ++it) {
+            ready.push_back(it->handle);
+        }
+        flush_waiters_.erase(done, flush_waiters_.end());
+    }
+
+    /**
+     * @brief 在不持有任何锁的情况下恢复协程
+     */
+    void Resume(const std::vector<std::coroutine_handle<>>& handles) {
+        if (handles.empty()) {
+            return;
+        }
+        std::function<void(std::coroutine_handle<>)> scheduler;
+        {
+            std::lock_guard<std::mutex> scheduler_lock(scheduler_mutex_);
+            scheduler = scheduler_;
+        }
+        if (scheduler) {
+            for (std::coroutine_handle<> handle : handles) {
+                scheduler(handle);
+            }
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> resume_lock(resume_mutex_);
+            resume_queue_.insert(resume_queue_.end(), handles.begin(), handles.end());
+            if (!resumer_.joinable()) {
+                resumer_ = std::thread([this] { ResumerLoop(); });
+            }
+        }
+        resume_cv_.notify_one();
+    }
+
+    /**
+     * @brief 默认的恢复线程：按交来的先后顺序恢复协程，首次需要时才启动
+     */
+    void ResumerLoop() {
+        std::vector<std::coroutine_handle<>> handles;
+        std::unique_lock<std::mutex> resume_lock(resume_mutex_);
+        while (true) {
+            resume_cv_.wait(resume_lock, [this] { return !resume_queue_.empty() || resume_stopping_; });
+            if (resume_queue_.empty()) {
+                return;
+            }
+            handles.swap(resume_queue_);
+            resume_lock.unlock();
+            for (std::coroutine_handle<> handle : handles) {
+                handle.resume();
+            }
+            handles.clear();
+            resume_lock.lock();
+        }
+    }
+
+    /**
+     * @brief 恢复完已交来的协程后停止恢复线程
+     */
+    void StopResumer() {
+        {
+            std::lock_guard<std::mutex> resume_lock(resume_mutex_);
+            resume_stopping_ = true;
+        }
+        resume_cv_.notify_one();
+        if (resumer_.joinable()) {
+            resumer_.join();
+        }
+    }
+
+    void TakeOwnLinesLocked(std::string& bytes, std::vector<PendingLine>& lines) {
+        const std::thread::id self = std::this_thread::get_id();
+        for (size_t i = queue_head_; i < queue_lines_.size(); i++) {
+            PendingLine& line = queue_lines_[i];
+            if (line.length != 0 && line.owner == self) {
+                PendingLine own = line;
+                own.offset = bytes.size();
+                lines.push_back(own);
+                bytes.append(queue_bytes_, line.offset, line.length);
+                pending_bytes_ -= line.length;
+                line.length = 0;
+            }
+        }
+    }
+
+    void CompactLocked() {
+        if (queue_head_ == queue_lines_.size()) {
+            queue_lines_.clear();
+            queue_bytes_.clear();
+            queue_head_ = 0;
+        } else if (queue_head_ >= kCompactLines && queue_head_ * 2 >= queue_lines_.size()) {
+            // 队列一直未清空时，丢弃已取走的前缀，防止缓冲区无限增长
+            const size_t base = queue_lines_[queue_head_].offset;
+            queue_bytes_.erase(0, base);
+            queue_lines_.erase(queue_lines_.begin(), queue_lines_.begin() + static_cast<std::ptrdiff_t>(queue_head_));
+            for (PendingLine& line : queue_lines_) {
+                line.offset -= base;
+            }
+            queue_head_ = 0;
+        }
+    }
+
+    void WorkerLoop() {
+        std::string batch;
+        std::vector<PendingLine> batch_lines;
+        std::unique_lock<std::mutex> queue_lock(queue_mutex_);
+        while (running_) {
+            queue_cv_.wait_for(queue_lock, options_.flush_interval, [this] {
+                return !running_ || pending_bytes_ >= options_.batch_bytes ||
+                       !parked_prints_.empty() || !flush_waiters_.empty();
+            });
+            if (queue_head_ == queue_lines_.size() && parked_prints_.empty() && flush_waiters_.empty()) {
+                continue;
+            }
+            queue_lock.unlock();
+            DrainOnce(batch, batch_lines);
+            queue_lock.lock();
+        }
+    }
+
+    const PrinterOptions options_;
+    ConfigCell config_;
+    std::mutex update_mutex_;  // 串行化配置的读-改-写
+    std::atomic<bool> deferred_{false};
+
+    std::mutex write_mutex_;            // 串行化对输出端的写入
+    std::vector<LogRecord> records_;    // 写出时复用的记录数组（受 write_mutex_ 保护）
+    std::mutex queue_mutex_;            // 保护以下队列状态
+    std::condition_variable queue_cv_;  // 唤醒后台线程
+    std::condition_variable space_cv_;  // 队列腾出空间
+    std::string queue_bytes_;
+    std::vector<PendingLine> queue_lines_;
+    size_t queue_head_ = 0;
+    size_t pending_bytes_ = 0;
+    uint64_t enqueued_total_ = 0;  // 累计入队的行数
+    uint64_t taken_total_ = 0;     // 累计被取走（或被同步通道带走）的行数
+    uint64_t written_total_ = 0;   // 累计已写出的行数
+    std::vector<ParkedPrint> parked_prints_;
+    std::vector<FlushWaiter> flush_waiters_;
+    bool running_ = false;
+    std::thread worker_;
+
+    std::mutex scheduler_mutex_;
+    std::function<void(std::coroutine_handle<>)> scheduler_;
+
+    std::mutex resume_mutex_;  // 保护以下恢复线程的状态
+    std::condition_variable resume_cv_;
+    std::vector<std::coroutine_handle<>> resume_queue_;
+    bool resume_stopping_ = false;
+    std::thread resumer_;
+
+    std::mutex watcher_mutex_;
+    std::unique_ptr<color_printer_detail::ConfigFileWatcher> watcher_;
+};
 
 /**
  * @brief 打印彩色字符串（const char*版本）
@@ -18,20 +744,7 @@
 void ColorPrinter::PrintColoredMessage(PrintColor color,
                                       const std::string& type,
                                       const char* message) {
-    std::string color_code = GetColorCode(color);
-    const std::string reset_code = "\033[0m";
-
-    // 检查消息是否包含格式化占位符
-    std::string msg_str(message);
-    bool hasFormatSpecifier = (msg_str.find('%') != std::string::npos);
-
-    if (!hasFormatSpecifier) {
-        // 纯字符串，直接打印
-        std::cout << color_code << "[" << type << "] " << msg_str << reset_code << std::endl;
-    } else {
-        // 包含格式化占位符，但没有提供参数，当作纯字符串处理
-        std::cout << color_code << "[" << type << "] " << msg_str << reset_code << std::endl;
-    }
+    Default().PrintColoredMessage(color, type, message);
 }
 
 /**
@@ -45,19 +758,34 @@ void ColorPrinter::PrintColoredMessage(PrintColor color,
 void ColorPrinter::PrintColoredMessage(PrintColor color,
                                       const std::string& type,
                                       const std::string& message) {
-    std::string color_code = GetColorCode(color);
-    const std::string reset_code = "\033[0m";
+    Default().PrintColoredMessage(color, type, message);
+}
 
-    // 检查消息是否包含格式化占位符
-    bool hasFormatSpecifier = (message.find('%') != std::string::npos);
+/**
+ * @brief 打印彩色字符串（std::string_view版本）
+ *        处理不以'\0'结尾的片段，例如从缓冲区中切出的一行，无需先拷贝成std::string
+ *
+ * @param color 颜色类型 (PrintColor枚举)
+ * @param type 消息类型
+ * @param message 要打印的消息内容
+ */
+void ColorPrinter::PrintColoredMessage(PrintColor color,
+                                      const std::string& type,
+                                      std::string_view message) {
+    Default().PrintColoredMessage(color, type, message);
+}
 
-    if (!hasFormatSpecifier) {
-        // 纯字符串，直接打印
-        std::cout << color_code << "[" << type << "] " << message << reset_code << std::endl;
-    } else {
-        // 包含格式化占位符，但没有提供参数，当作纯字符串处理
-        std::cout << color_code << "[" << type << "] " << message << reset_code << std::endl;
-    }
+/**
+ * @brief 以任意样式打印消息
+ *
+ * @param style 样式（颜色按当前颜色深度降级）
+ * @param type 消息类型
+ * @param message 要打印的消息内容
+ */
+void ColorPrinter::PrintStyledMessage(Style style,
+                                      const std::string& type,
+                                      std::string_view message) {
+    Default().PrintStyledMessage(style, type, message);
 }
 
 /**
@@ -71,11 +799,7 @@ void ColorPrinter::PrintColoredMessage(PrintColor color,
 void ColorPrinter::PrintColoredMessage(PrintColor color,
                                       const std::string& type,
                                       bool value) {
-    std::string color_code = GetColorCode(color);
-    const std::string reset_code = "\033[0m";
-
-    // 打印彩色消息，使用用户要求的格式
-    std::cout << color_code << "[" << type << "] " << (value ? "true" : "false") << reset_code << std::endl;
+    Default().PrintColoredMessage(color, type, value);
 }
 
 /**
@@ -88,11 +812,7 @@ void ColorPrinter::PrintColoredMessage(PrintColor color,
 void ColorPrinter::PrintColoredMessage(PrintColor color,
                                       const std::string& type,
                                       char value) {
-    std::string color_code = GetColorCode(color);
-    const std::string reset_code = "\033[0m";
-
-    // 打印彩色消息，使用用户要求的格式
-    std::cout << color_code << "[" << type << "] " << value << reset_code << std::endl;
+    Default().PrintColoredMessage(color, type, value);
 }
 
 /**
@@ -105,11 +825,7 @@ void ColorPrinter::PrintColoredMessage(PrintColor color,
 void ColorPrinter::PrintColoredMessage(PrintColor color,
                                       const std::string& type,
                                       int value) {
-    std::string color_code = GetColorCode(color);
-    const std::string reset_code = "\033[0m";
-
-    // 打印彩色消息，使用用户要求的格式
-    std::cout << color_code << "[" << type << "] " << value << reset_code << std::endl;
+    Default().PrintColoredMessage(color, type, value);
 }
 
 /**
@@ -122,11 +838,7 @@ void ColorPrinter::PrintColoredMessage(PrintColor color,
 void ColorPrinter::PrintColoredMessage(PrintColor color,
                                       const std::string& type,
                                       float value) {
-    std::string color_code = GetColorCode(color);
-    const std::string reset_code = "\033[0m";
-
-    // 打印彩色消息，使用用户要求的格式
-    std::cout << color_code << "[" << type << "] " << value << reset_code << std::endl;
+    Default().PrintColoredMessage(color, type, value);
 }
 
 /**
@@ -139,11 +851,7 @@ void ColorPrinter::PrintColoredMessage(PrintColor color,
 void ColorPrinter::PrintColoredMessage(PrintColor color,
                                       const std::string& type,
                                       double value) {
-    std::string color_code = GetColorCode(color);
-    const std::string reset_code = "\033[0m";
-
-    // 打印彩色消息，使用用户要求的格式
-    std::cout << color_code << "[" << type << "] " << value << reset_code << std::endl;
+    Default().PrintColoredMessage(color, type, value);
 }
 
 /**
@@ -153,26 +861,358 @@ void ColorPrinter::PrintColoredMessage(PrintColor color,
  * @return ANSI颜色代码
  */
 std::string ColorPrinter::GetColorCode(PrintColor color) {
-    switch (color) {
-        case PrintColor::RED:
-            return "\033[31m";  // 红色
-        case PrintColor::GREEN:
-            return "\033[32m";  // 绿色
-        case PrintColor::YELLOW:
-            return "\033[33m";  // 黄色
-        case PrintColor::BLUE:
-            return "\033[34m";  // 蓝色
-        case PrintColor::MAGENTA:
-            return "\033[35m";  // 品红
-        case PrintColor::CYAN:
-            return "\033[36m";  // 青色
-        case PrintColor::WHITE:
-            return "\033[37m";  // 白色
+    return std::string(PrintColorEscape(color));
+}
+
+std::string ColorPrinter::GetStyleCode(Style style) {
+    return std::string(CachedStyleEscape(style));
+}
+
+ColorDepth ColorPrinter::GetColorDepth() {
+    return g_color_depth.load(std::memory_order_relaxed);
+}
+
+void ColorPrinter::SetColorDepth(ColorDepth depth) {
+    g_color_depth.store(depth, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 获取日志级别的默认颜色
+ *
+ * @param level 日志级别
+ * @return 默认颜色
+ */
+PrintColor ColorPrinter::DefaultColorForLevel(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG:
+            return PrintColor::CYAN;
+        case LogLevel::INFO:
+            return PrintColor::GREEN;
+        case LogLevel::OK:
+            return PrintColor::BLUE;
+        case LogLevel::WARNING:
+            return PrintColor::YELLOW;
+        case LogLevel::ERROR:
+            return PrintColor::RED;
+        case LogLevel::FATAL:
+            return PrintColor::MAGENTA;
         default:
-            return "\033[0m";   // 默认颜色（重置）
+            return PrintColor::WHITE;
+    }
+}
+
+/**
+ * @brief 渲染一行完整的消息（颜色代码、类型前缀、正文、重置代码与换行）
+ *
+ * @param color 颜色类型 (PrintColor枚举)
+ * @param type 消息类型
+ * @param message 已格式化的消息内容
+ * @param colored 是否输出颜色代码与重置代码
+ * @return 渲染结果，可直接交给输出端
+ */
+ColorPrinter::RenderedLine ColorPrinter::RenderLine(std::string_view escape,
+                                                    PrintColor color,
+                                                    const std::string& type,
+                                                    std::string_view message,
+                                                    bool colored,
+                                                    bool timestamp) {
+    const std::string_view color_code = colored ? escape : std::string_view();
+    const std::string_view reset_code = colored ? "\033[0m" : "";
+
+    RenderedLine rendered;
+    rendered.color = color;
+    rendered.level = LevelFromType(type);
+
+    rendered.escape_head = static_cast<uint16_t>(color_code.size());
+    rendered.escape_tail = static_cast<uint16_t>(reset_code.size());
+
+    std::string& line = rendered.text;
+    line.reserve(color_code.size() + type.size() + message.size() + reset_code.size() + 32);
+    line += color_code;
+    if (timestamp) {
+        AppendTimestamp(line);
+    }
+    line += '[';
+    rendered.type_offset = static_cast<uint32_t>(line.size());
+    rendered.type_length = static_cast<uint32_t>(type.size());
+    line += type;
+    line += "] ";
+    rendered.message_offset = static_cast<uint32_t>(line.size());
+    rendered.message_length = static_cast<uint32_t>(message.size());
+    line += message;
+    line += reset_code;
+    line += '\n';
+    return rendered;
+}
+
+/**
+ * @brief 根据消息类型字符串推断日志级别（不区分大小写）
+ *
+ * @param type 消息类型
+ * @return 对应的日志级别
+ */
+LogLevel ColorPrinter::LevelFromType(std::string_view type) {
+    char upper[16];
+    if (type.size() >= sizeof(upper)) {
+        return LogLevel::INFO;
+    }
+    for (size_t i = 0; i < type.size(); i++) {
+        upper[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(type[i])));
+    }
+    const std::string_view name(upper, type.size());
+
+    if (name == "ERROR" || name == "ERR") {
+        return LogLevel::ERROR;
+    }
+    if (name == "WARNING" || name == "WARN") {
+        return LogLevel::WARNING;
+    }
+    if (name == "DEBUG" || name == "TRACE") {
+        return LogLevel::DEBUG;
+    }
+    if (name == "OK" || name == "SUCCESS") {
+        return LogLevel::OK;
+    }
+    if (name == "FATAL" || name == "CRITICAL" || name == "PANIC") {
+        return LogLevel::FATAL;
+    }
+    return LogLevel::INFO;
+}
+
+/**
+ * @brief 开启或关闭默认打印器的延迟输出（双通道模型）
+ *
+ * @param enabled 是否开启延迟输出
+ */
+void ColorPrinter::SetDeferredOutput(bool enabled) {
+    Default().SetDeferredOutput(enabled);
+}
+
+/**
+ * @brief 设置默认打印器同步通道的级别阈值
+ *
+ * @param level 同步阈值
+ */
+void ColorPrinter::SetSyncLevel(LogLevel level) {
+    Default().SetSyncLevel(level);
+}
+
+/**
+ * @brief 将默认打印器后台通道中尚未写出的消息立即写出
+ */
+void ColorPrinter::Flush() {
+    Default().Flush();
+}
+
+/**
+ * @brief 协程版本的彩色打印（默认打印器）
+ *
+ * @param color 颜色类型 (PrintColor枚举)
+ * @param type 消息类型
+ * @param message 要打印的消息内容
+ * @return 可 co_await 的对象
+ */
+ColorPrinter::PrintAwaitable ColorPrinter::PrintAsync(PrintColor color,
+                                                      const std::string& type,
+                                                      const std::string& message) {
+    return Default().PrintAsync(color, type, message);
+}
+
+/**
+ * @brief 协程版本的 Flush（默认打印器）
+ *
+ * @return 可 co_await 的对象
+ */
+ColorPrinter::FlushAwaitable ColorPrinter::FlushAsync() {
+    return Default().FlushAsync();
+}
+
+/**
+ * @brief 设置默认打印器协程恢复的调度钩子
+ *
+ * @param scheduler 调度函数
+ */
+void ColorPrinter::SetAsyncScheduler(std::function<void(std::coroutine_handle<>)> scheduler) {
+    Default().SetAsyncScheduler(std::move(scheduler));
+}
+
+/**
+ * @brief 获取默认打印器（输出到标准输出）
+ *
+ * @return 默认打印器
+ */
+ColorPrinter::Printer& ColorPrinter::Default() {
+    static Printer printer(std::make_shared<FdSink>(STDOUT_FILENO));
+    return printer;
+}
+
+ColorPrinter::Printer::Printer(std::shared_ptr<LogSink> sink, PrinterOptions options)
+    : impl_(std::make_unique<Impl>(std::move(sink), options)) {
+}
+
+ColorPrinter::Printer::~Printer() = default;
+
+void ColorPrinter::Printer::PrintColoredMessage(PrintColor color, const std::string& type, const char* message) {
+    // 没有提供格式化参数时，即使包含'%'也当作纯字符串处理
+    Emit(color, type, message);
+}
+
+void ColorPrinter::Printer::PrintColoredMessage(PrintColor color, const std::string& type, const std::string& message) {
+    Emit(color, type, message);
+}
+
+void ColorPrinter::Printer::PrintStyledMessage(Style style, const std::string& type, std::string_view message) {
+    Emit(CachedStyleEscape(style), NearestPrintColor(style), type, message);
+}
+
+void ColorPrinter::Printer::PrintColoredMessage(PrintColor color, const std::string& type, std::string_view message) {
+    Emit(color, type, message);
+}
+
+void ColorPrinter::Printer::PrintColoredMessage(PrintColor color, const std::string& type, bool value) {
+    Emit(color, type, value ? "true" : "false");
+}
+
+void ColorPrinter::Printer::PrintColoredMessage(PrintColor color, const std::string& type, char value) {
+    Emit(color, type, std::string_view(&value, 1));
+}
+
+void ColorPrinter::Printer::PrintColoredMessage(PrintColor color, const std::string& type, int value) {
+    char buffer[16];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    Emit(color, type, std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+}
+
+void ColorPrinter::Printer::PrintColoredMessage(PrintColor color, const std::string& type, float value) {
+    Emit(color, type, FormatFloating(value));
+}
+
+void ColorPrinter::Printer::PrintColoredMessage(PrintColor color, const std::string& type, double value) {
+    Emit(color, type, FormatFloating(value));
+}
+
+ColorPrinter::PrintAwaitable ColorPrinter::Printer::PrintAsync(PrintColor color,
+                                                               const std::string& type,
+                                                               const std::string& message) {
+    bool sync = false;
+    RenderedLine line = Render(color, type, message, sync);
+    return PrintAwaitable(*this, std::move(line), sync);
+}
+
+ColorPrinter::FlushAwaitable ColorPrinter::Printer::FlushAsync() {
+    return FlushAwaitable(*this);
+}
+
+void ColorPrinter::Printer::SetDeferredOutput(bool enabled) {
+    impl_->SetDeferred(enabled);
+}
+
+void ColorPrinter::Printer::SetSyncLevel(LogLevel level) {
+    impl_->UpdateConfig([level](PrinterConfig& config) { config.sync_level = level; });
+}
+
+void ColorPrinter::Printer::Flush() {
+    impl_->Flush();
+}
+
+void ColorPrinter::Printer::SetAsyncScheduler(std::function<void(std::coroutine_handle<>)> scheduler) {
+    impl_->SetScheduler(std::move(scheduler));
+}
+
+std::shared_ptr<LogSink> ColorPrinter::Printer::Sink() const {
+    return impl_->CurrentSink();
+}
+
+ColorPrinter::PrinterConfig ColorPrinter::Printer::Config() const {
+    return *impl_->ReadConfig();
+}
+
+void ColorPrinter::Printer::SetConfig(PrinterConfig config) {
+    impl_->UpdateConfig([&config](PrinterConfig& current) { current = std::move(config); });
+}
+
+void ColorPrinter::Printer::UpdateConfig(const std::function<void(PrinterConfig&)>& edit) {
+    impl_->UpdateConfig(edit);
+}
+
+bool ColorPrinter::Printer::WatchConfigFile(const std::string& path) {
+    return impl_->WatchConfigFile(path, *this);
+}
+
+void ColorPrinter::Printer::StopWatchingConfigFile() {
+    impl_->StopWatching();
+}
+
+ColorPrinter::RenderedLine ColorPrinter::Printer::Render(PrintColor color,
+                                                         const std::string& type,
+                                                         std::string_view message,
+                                                         bool& sync) const {
+    return Render(PrintColorEscape(color), color, type, message, sync);
+}
+
+ColorPrinter::RenderedLine ColorPrinter::Printer::Render(std::string_view escape,
+                                                         PrintColor color,
+                                                         const std::string& type,
+                                                         std::string_view message,
+                                                         bool& sync) const {
+    // 整条消息只读取一次配置快照
+    const auto config = impl_->ReadConfig();
+    const LogLevel level = LevelFromType(type);
+    if (level < config->min_level) {
+        return RenderedLine{};
+    }
+    sync = level >= config->sync_level;
+    const std::optional<PrintColor>& override_color = config->level_colors[static_cast<size_t>(level)];
+    if (override_color) {
+        escape = PrintColorEscape(*override_color);
+        color = *override_color;
+    }
+    return RenderLine(escape, color, type, message, config->colored && config->sink->WantsColor(), config->timestamp);
+}
+
+void ColorPrinter::Printer::Emit(PrintColor color, const std::string& type, std::string_view message) {
+    Emit(PrintColorEscape(color), color, type, message);
+}
+
+void ColorPrinter::Printer::Emit(std::string_view escape,
+                                 PrintColor color,
+                                 const std::string& type,
+                                 std::string_view message) {
+    bool sync = false;
+    RenderedLine line = Render(escape, color, type, message, sync);
+    if (!line.text.empty()) {
+        impl_->Submit(line, sync);
     }
 }
 
+/**
+ * @brief 队列有空间（或走同步通道）时直接接收消息，无需挂起
+ */
+bool ColorPrinter::PrintAwaitable::await_ready() {
+    return line_.text.empty() || printer_->impl_->TryAccept(line_, sync_);
+}
+
+/**
+ * @brief 队列已满时挂起协程，返回false表示在此期间已被接收
+ */
+bool ColorPrinter::PrintAwaitable::await_suspend(std::coroutine_handle<> handle) {
+    return printer_->impl_->ParkPrint(line_, handle);
+}
+
+/**
+ * @brief 之前提交的消息已全部写出时无需挂起
+ */
+bool ColorPrinter::FlushAwaitable::await_ready() {
+    return printer_->impl_->FlushReady();
+}
+
+/**
+ * @brief 挂起协程直到之前提交的消息全部写出，返回false表示在此期间已写出
+ */
+bool ColorPrinter::FlushAwaitable::await_suspend(std::coroutine_handle<> handle) {
+    return printer_->impl_->ParkFlush(handle);
+}
+
 /**
  * @brief 格式化字符串（基础情况）
  *
@@ -208,24 +1248,115 @@ std::string ColorPrinter::FormatString(const std::string& format) {
  *       这允许在多个地方独立使用，每个地方维护自己的计数器状态
  */
 void ColorPrinter::PrintSilentStatusIndicator(PrintColor color, bool isSilent, int& countRef) {
+    thread_local DrawnIndicator drawn;
+
     // 当处于静默状态时打印累积的点号，最多打印100个点，达到100个后清空并重新开始循环
-    if (isSilent) {
-        countRef++;
+    if (!isSilent) {
+        return;
+    }
+    countRef++;
+    if (countRef < 1 || countRef > 100) {
+        countRef = 1;  // 重置为1，开始新的循环（调用者传入越界的计数时同样）；屏幕在下一次绘制时整行重绘
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (!IndicatorThrottled(drawn, &countRef, color, now)) {
+        DrawIndicator(drawn, &countRef, color, countRef, now);
+    }
+}
+
+/**
+ * @brief 设置静默状态指示器的最大刷新帧率
+ *
+ * @param frames_per_second 每秒最多刷新的次数，0 表示每次调用都刷新
+ */
+void ColorPrinter::SetIndicatorFrameRate(int frames_per_second) {
+    g_indicator_frame_rate.store(frames_per_second > 0 ? frames_per_second : 0, std::memory_order_relaxed);
+}
+
+/**
+ * @class ColorPrinter::StatusIndicator::Impl
+ * @brief 按线程分片的计数，以及抢到绘制权的线程使用的绘制状态
+ */
+class ColorPrinter::StatusIndicator::Impl {
+public:
+    static constexpr unsigned kShards = 64;
+
+    explicit Impl(PrintColor color) : color_(color) {}
+
+    void Tick() {
+        shards_[color_printer_detail::ThreadReaderShard() % kShards].ticks.fetch_add(1, std::memory_order_relaxed);
 
-        // 如果count超过100，清空并重置
-        if (countRef > 100) {
-            std::cout << "\r                      \r" << std::flush;  // 清空行（"[INFO] " + 100个"."）
-            countRef = 1;  // 重置为1，开始新的循环
+        // 未到下一帧时只读一次共享的时间点；到了之后只有交换成功的线程绘制，其余线程直接返回
+        const auto now = std::chrono::steady_clock::now();
+        if (now.time_since_epoch().count() < next_frame_.load(std::memory_order_relaxed) ||
+            drawing_.exchange(true, std::memory_order_acquire)) {
+            return;
         }
+        const uint64_t ticks = Ticks();
+        if (ticks > 0 && !IndicatorThrottled(drawn_, this, color_, now)) {
+            DrawIndicator(drawn_, this, color_, static_cast<int>((ticks - 1) % 100) + 1, now);
+        }
+        const int frame_rate = g_indicator_frame_rate.load(std::memory_order_relaxed);
+        const auto interval = frame_rate > 0 ? std::chrono::nanoseconds(std::chrono::seconds(1)) / frame_rate
+                                             : std::chrono::nanoseconds(0);
+        next_frame_.store((now + interval).time_since_epoch().count(), std::memory_order_relaxed);
+        drawing_.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief 等待正在绘制的线程结束后，按当前计数绘制一次
+     */
+    void Flush() {
+        while (drawing_.exchange(true, std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        const uint64_t ticks = Ticks();
+        if (ticks > 0) {
+            DrawIndicator(drawn_, this, color_, static_cast<int>((ticks - 1) % 100) + 1,
+                          std::chrono::steady_clock::now());
+        }
+        drawing_.store(false, std::memory_order_release);
+    }
 
-        // 回到行首，重新打印完整的当前状态
-        std::string color_code = GetColorCode(color);
-        std::cout << "\r" << color_code << "[INFO] ";
-        for (int i = 0; i < countRef; i++) {
-            std::cout << ".";
+    uint64_t Ticks() const {
+        uint64_t ticks = 0;
+        for (const Shard& shard : shards_) {
+            ticks += shard.ticks.load(std::memory_order_relaxed);
         }
-        std::cout << "\033[0m" << std::flush;
+        return ticks;
     }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> ticks{0};
+    };
+
+    const PrintColor color_;
+    Shard shards_[kShards];
+    alignas(64) std::atomic<int64_t> next_frame_{0};
+    std::atomic<bool> drawing_{false};
+    DrawnIndicator drawn_;  // 只由持有绘制权的线程访问
+};
+
+ColorPrinter::StatusIndicator::StatusIndicator(PrintColor color)
+    : impl_(std::make_unique<Impl>(color)) {
+}
+
+ColorPrinter::StatusIndicator::~StatusIndicator() {
+    impl_->Flush();
+}
+
+void ColorPrinter::StatusIndicator::Tick() {
+    impl_->Tick();
+}
+
+void ColorPrinter::StatusIndicator::Flush() {
+    impl_->Flush();
+}
+
+uint64_t ColorPrinter::StatusIndicator::Ticks() const {
+    return impl_->Ticks();
 }
 
 /**
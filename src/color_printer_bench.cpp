@@ -0,0 +1,143 @@
+//
+// 文件输出性能测试：对比 RotatingFileSink 的 write 与 io_uring 两种写法
+// 统计总吞吐量以及调用方单次 Write 的延迟分布
+// 另外统计 FdSink 带颜色输出时省去的颜色代码字节数
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+#include "color_printer.h"
+#include "color_printer_file_sink.h"
+
+
+struct BenchResult {
+    double seconds;
+    double p50_us;
+    double p99_us;
+    double max_us;
+};
+
+static BenchResult RunOnce(const std::string& path, bool io_uring, size_t lines, size_t line_bytes,
+                           size_t buffer_bytes, bool* using_uring) {
+    ::unlink(path.c_str());
+
+    RotatingFileOptions options;
+    options.path = path;
+    options.io_uring = io_uring;
+    options.buffer_bytes = buffer_bytes;
+    options.preallocate = false;
+
+    std::string line(line_bytes - 1, 'x');
+    line += '\n';
+    LogRecord record{PrintColor::WHITE, LogLevel::INFO, "INFO", line, line};
+
+    std::vector<double> latencies;
+    latencies.reserve(lines);
+    const auto start = std::chrono::steady_clock::now();
+    {
+        RotatingFileSink sink(options);
+        *using_uring = sink.UsingIoUring();
+        for (size_t i = 0; i < lines; i++) {
+            const auto before = std::chrono::steady_clock::now();
+            sink.Write(&record, 1);
+            const auto after = std::chrono::steady_clock::now();
+            latencies.push_back(std::chrono::duration<double, std::micro>(after - before).count());
+        }
+        sink.Flush();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    ::unlink(path.c_str());
+
+    std::sort(latencies.begin(), latencies.end());
+    BenchResult result;
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.p50_us = latencies[latencies.size() / 2];
+    result.p99_us = latencies[latencies.size() * 99 / 100];
+    result.max_us = latencies.back();
+    return result;
+}
+
+struct EscapeResult {
+    uint64_t written;
+    uint64_t saved;
+};
+
+/**
+ * @brief 经批量通道向带颜色的 FdSink 打印 lines 行（大部分为 INFO，每16行夹一条 WARNING），
+ *        返回实际写出的字节数与省去的颜色代码字节数
+ */
+static EscapeResult RunColored(const std::string& path, size_t lines) {
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return {0, 0};
+    }
+    auto sink = std::make_shared<FdSink>(fd, true);
+    {
+        ColorPrinter::Printer printer{sink, {.deferred = true}};
+        for (size_t i = 0; i < lines; i++) {
+            if (i % 16 == 15) {
+                printer.PrintColoredMessage(PrintColor::YELLOW, "WARNING", "queue depth %zu", i);
+            } else {
+                printer.PrintColoredMessage(PrintColor::GREEN, "INFO", "processed item %zu", i);
+            }
+        }
+        printer.Flush();
+    }
+    struct stat info;
+    const uint64_t written = ::fstat(fd, &info) == 0 ? static_cast<uint64_t>(info.st_size) : 0;
+    ::close(fd);
+    ::unlink(path.c_str());
+    return {written, sink->EscapeBytesSaved()};
+}
+
+int main(int argc, char *argv[])
+{
+    std::string path = "color_printer_bench.log";
+    size_t lines = 2000000;
+    size_t line_bytes = 100;
+    size_t buffer_bytes = 256 * 1024;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--path") == 0) {
+            path = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--lines") == 0) {
+            lines = std::strtoull(argv[i + 1], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--line-bytes") == 0) {
+            line_bytes = std::max<size_t>(std::strtoull(argv[i + 1], nullptr, 10), 2);
+        } else if (std::strcmp(argv[i], "--buffer-bytes") == 0) {
+            buffer_bytes = std::strtoull(argv[i + 1], nullptr, 10);
+        } else {
+            std::fprintf(stderr, "用法: %s [--path 文件] [--lines 行数] [--line-bytes 每行字节数] [--buffer-bytes 缓冲区字节数]\n",
+                         argv[0]);
+            return 2;
+        }
+    }
+    lines = std::max<size_t>(lines, 1);
+
+    std::printf("%-10s %10s %12s %10s %10s %10s\n", "后端", "秒", "MB/s", "p50(us)", "p99(us)", "max(us)");
+    for (const bool io_uring : {false, true}) {
+        bool using_uring = false;
+        const BenchResult result = RunOnce(path, io_uring, lines, line_bytes, buffer_bytes, &using_uring);
+        if (io_uring && !using_uring) {
+            ColorPrinter::PrintColoredMessage(PrintColor::YELLOW, "WARNING", "io_uring 不可用，以下结果为回退到 write 的数据");
+        }
+        const double megabytes = static_cast<double>(lines * line_bytes) / (1024.0 * 1024.0);
+        std::printf("%-10s %10.3f %12.1f %10.2f %10.2f %10.2f\n", io_uring ? "io_uring" : "write",
+                    result.seconds, megabytes / result.seconds, result.p50_us, result.p99_us, result.max_us);
+    }
+
+    const EscapeResult colored = RunColored(path, lines);
+    const uint64_t unoptimized = colored.written + colored.saved;
+    std::printf("\n彩色输出（FdSink）：写出 %llu 字节，省去颜色代码 %llu 字节（占原输出的 %.1f%%）\n",
+                static_cast<unsigned long long>(colored.written), static_cast<unsigned long long>(colored.saved),
+                unoptimized > 0 ? 100.0 * static_cast<double>(colored.saved) / static_cast<double>(unoptimized) : 0.0);
+    return 0;
+}
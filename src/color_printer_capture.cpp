@@ -0,0 +1,250 @@
+/**
+ * @file color_printer_capture.cpp
+ * @brief ColorPrinter::OutputCapture 的实现
+ */
+
+#include "color_printer_capture.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kReadBufferBytes = 256 * 1024;
+
+void CloseIfOpen(int& fd) {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+/**
+ * @brief 把调用者自己的流缓冲写出，保证重定向前后的先后顺序
+ */
+void FlushStandardStreams() {
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(stdout);
+    std::fflush(stderr);
+}
+
+} // namespace
+
+ColorPrinter::OutputCapture::OutputCapture(CaptureOptions options)
+    : OutputCapture(Default(), std::move(options)) {}
+
+ColorPrinter::OutputCapture::OutputCapture(Printer& printer, CaptureOptions options)
+    : printer_(printer), options_(std::move(options)) {
+    active_ = Start();
+}
+
+ColorPrinter::OutputCapture::~OutputCapture() {
+    if (active_) {
+        Restore();
+    }
+}
+
+/**
+ * @brief 为 target_fd 创建管道并保存其副本，此时尚未重定向
+ */
+bool ColorPrinter::OutputCapture::OpenPipe(Channel& channel, int target_fd) {
+    int fds[2];
+    if (::pipe2(fds, O_CLOEXEC) != 0) {
+        return false;
+    }
+    ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    ::fcntl(fds[1], F_SETPIPE_SZ, static_cast<int>(options_.pipe_bytes));  // 失败时保留默认容量
+    channel.read_fd = fds[0];
+    channel.write_fd = fds[1];
+    channel.target_fd = target_fd;
+    channel.saved_fd = ::fcntl(target_fd, F_DUPFD_CLOEXEC, 3);
+    return channel.saved_fd >= 0;
+}
+
+/**
+ * @brief 创建管道并重定向；打印器的输出端若写被捕获的描述符，先改为写入其副本
+ *        输出端不支持改写（FooterSink、自定义输出端等）时放弃捕获，否则打印器的输出会经管道回到自身
+ */
+bool ColorPrinter::OutputCapture::Start() {
+    if (!options_.capture_stdout && !options_.capture_stderr) {
+        return false;
+    }
+    stop_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    bool ok = stop_fd_ >= 0;
+    if (ok && options_.capture_stdout) {
+        channels_[0].color = options_.stdout_color;
+        channels_[0].type = options_.stdout_type;
+        ok = OpenPipe(channels_[0], STDOUT_FILENO);
+    }
+    if (ok && options_.capture_stderr) {
+        channels_[1].color = options_.stderr_color;
+        channels_[1].type = options_.stderr_type;
+        ok = OpenPipe(channels_[1], STDERR_FILENO);
+    }
+
+    std::shared_ptr<LogSink> sink = printer_.Sink();
+    std::shared_ptr<LogSink> replacement = sink;
+    for (const Channel& channel : channels_) {
+        if (ok && channel.saved_fd >= 0 && replacement->WritesToFd(channel.target_fd)) {
+            replacement = replacement->RebindFd(channel.target_fd, channel.saved_fd);
+            ok = replacement != nullptr;
+        }
+    }
+    if (!ok) {
+        for (Channel& channel : channels_) {
+            CloseIfOpen(channel.read_fd);
+            CloseIfOpen(channel.write_fd);
+            CloseIfOpen(channel.saved_fd);
+        }
+        CloseIfOpen(stop_fd_);
+        return false;
+    }
+
+    printer_.Flush();
+    if (replacement != sink) {
+        original_sink_ = sink;
+        printer_.UpdateConfig([&replacement](PrinterConfig& config) { config.sink = replacement; });
+    }
+
+    FlushStandardStreams();
+    for (Channel& channel : channels_) {
+        if (channel.write_fd >= 0) {
+            ::dup2(channel.write_fd, channel.target_fd);
+            CloseIfOpen(channel.write_fd);
+        }
+    }
+
+    reader_ = std::thread([this] { Run(); });
+    return true;
+}
+
+/**
+ * @brief 读取线程：等待任一管道可读，一次读取尽可能多的数据后按行输出
+ *        收到停止信号后把管道中剩余的内容（包括不完整的最后一行）全部输出再退出
+ */
+void ColorPrinter::OutputCapture::Run() {
+    std::unique_ptr<char[]> buffer(new char[kReadBufferBytes]);
+    for (;;) {
+        pollfd fds[3];
+        Channel* owners[2];
+        nfds_t used = 0;
+        for (Channel& channel : channels_) {
+            if (channel.read_fd >= 0) {
+                owners[used] = &channel;
+                fds[used++] = pollfd{channel.read_fd, POLLIN, 0};
+            }
+        }
+        fds[used] = pollfd{stop_fd_, POLLIN, 0};
+        if (::poll(fds, used + 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (nfds_t i = 0; i < used; i++) {
+            if (fds[i].revents != 0 && !Drain(*owners[i], buffer.get(), kReadBufferBytes)) {
+                CloseIfOpen(owners[i]->read_fd);
+            }
+        }
+        if (fds[used].revents != 0) {
+            break;
+        }
+    }
+
+    for (Channel& channel : channels_) {
+        if (channel.read_fd >= 0) {
+            Drain(channel, buffer.get(), kReadBufferBytes);
+        }
+        if (!channel.partial.empty()) {
+            EmitLine(channel, channel.partial);
+            channel.partial.clear();
+        }
+    }
+}
+
+/**
+ * @brief 读到管道暂时为空为止
+ *
+ * @return 管道写端已全部关闭或出错时返回false
+ */
+bool ColorPrinter::OutputCapture::Drain(Channel& channel, char* buffer, size_t size) {
+    for (;;) {
+        const ssize_t length = ::read(channel.read_fd, buffer, size);
+        if (length > 0) {
+            EmitLines(channel, buffer, static_cast<size_t>(length));
+            continue;
+        }
+        if (length < 0 && errno == EINTR) {
+            continue;
+        }
+        return length < 0 && errno == EAGAIN;
+    }
+}
+
+/**
+ * @brief 用 memchr 找换行；上次剩下的半行与本次开头拼接，其余的行直接以视图输出，不拷贝
+ */
+void ColorPrinter::OutputCapture::EmitLines(Channel& channel, const char* data, size_t length) {
+    const char* const end = data + length;
+    while (data < end) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', static_cast<size_t>(end - data)));
+        if (newline == nullptr) {
+            channel.partial.append(data, static_cast<size_t>(end - data));
+            if (channel.partial.size() >= options_.max_line_bytes) {
+                EmitLine(channel, channel.partial);
+                channel.partial.clear();
+            }
+            return;
+        }
+        if (channel.partial.empty()) {
+            EmitLine(channel, std::string_view(data, static_cast<size_t>(newline - data)));
+        } else {
+            channel.partial.append(data, static_cast<size_t>(newline - data));
+            EmitLine(channel, channel.partial);
+            channel.partial.clear();
+        }
+        data = newline + 1;
+    }
+}
+
+void ColorPrinter::OutputCapture::EmitLine(Channel& channel, std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    printer_.Emit(channel.color, channel.type, line);
+}
+
+/**
+ * @brief 恢复 fd 1 / fd 2，通知读取线程输出剩余内容后退出，最后换回原输出端
+ */
+void ColorPrinter::OutputCapture::Restore() {
+    FlushStandardStreams();
+    for (Channel& channel : channels_) {
+        if (channel.saved_fd >= 0) {
+            ::dup2(channel.saved_fd, channel.target_fd);
+        }
+    }
+
+    const uint64_t one = 1;
+    [[maybe_unused]] ssize_t ignored = ::write(stop_fd_, &one, sizeof(one));
+    reader_.join();
+
+    printer_.Flush();
+    if (original_sink_) {
+        printer_.UpdateConfig([this](PrinterConfig& config) { config.sink = original_sink_; });
+        original_sink_.reset();
+    }
+    for (Channel& channel : channels_) {
+        CloseIfOpen(channel.read_fd);
+        CloseIfOpen(channel.saved_fd);
+    }
+    CloseIfOpen(stop_fd_);
+    active_ = false;
+}
@@ -0,0 +1,348 @@
+//
+// 日志着色工具：color_printer_cat [--color|--no-color] [文件...]
+// 读取日志文件（或标准输入），按行识别级别标记（"[INFO]"、"[ERROR]"，或行首附近的 ERROR、WARN 等大写单词），
+// 以该级别的默认颜色重新输出；识别不出级别的行原样输出
+// 普通文件用 mmap 按窗口读取（预读下一窗口、释放已输出的页），管道用大块 read；换行和 '[' 用 SSE2 一次扫描16字节
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "color_printer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+constexpr size_t kOutputBytes = 1024 * 1024;
+constexpr size_t kReadBytes = 4 * 1024 * 1024;
+constexpr size_t kHeadBytes = 64;          // 只在行首这么多字节内寻找级别标记
+constexpr size_t kDirectWriteBytes = 256 * 1024;  // 连续不着色的内容超过该长度时直接从输入写出
+constexpr size_t kMapWindowBytes = 32 * 1024 * 1024;  // 映射的文件每次处理的字节数
+
+/**
+ * @class Colorizer
+ * @brief 按行着色并把结果攒成大块写出
+ *        不着色的行不逐行拷贝：记下连续区间，遇到需要着色的行时一次性追加（区间很大时直接写出）
+ */
+class Colorizer {
+public:
+    Colorizer(int out_fd, bool colored) : out_fd_(out_fd), colored_(colored) {
+        buffer_.reserve(kOutputBytes + 4096);
+        for (int level = 0; level <= static_cast<int>(LogLevel::FATAL); level++) {
+            codes_[level] = ColorPrinter::GetColorCode(ColorPrinter::DefaultColorForLevel(static_cast<LogLevel>(level)));
+        }
+    }
+
+    /**
+     * @brief 处理一段数据，返回已处理到的位置
+     *        at_end 为false时末尾不完整的行不处理，由调用者保留到下一块
+     */
+    const char* Process(const char* begin, const char* end, bool at_end) {
+        plain_start_ = begin;
+        const char* line_start = begin;
+        const char* bracket = nullptr;  // 当前行第一个 '['（仅限行首 kHeadBytes 字节内）
+        const char* position = begin;
+#if defined(__SSE2__)
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i open = _mm_set1_epi8('[');
+        for (; end - position >= 16; position += 16) {
+            const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(position));
+            const unsigned newlines = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+            const unsigned brackets = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, open)));
+            if (newlines == 0 && (brackets == 0 || bracket != nullptr)) {
+                continue;  // 行中间的块：没有需要处理的位置
+            }
+            unsigned events = newlines | brackets;
+            while (events != 0) {
+                const unsigned bit = static_cast<unsigned>(__builtin_ctz(events));
+                events &= events - 1;
+                const char* at = position + bit;
+                if (newlines & (1u << bit)) {
+                    Line(line_start, at, bracket);
+                    line_start = at + 1;
+                    bracket = nullptr;
+                } else if (bracket == nullptr && at - line_start < static_cast<ptrdiff_t>(kHeadBytes)) {
+                    bracket = at;
+                }
+            }
+        }
+#endif
+        for (; position < end; position++) {
+            if (*position == '\n') {
+                Line(line_start, position, bracket);
+                line_start = position + 1;
+                bracket = nullptr;
+            } else if (*position == '[' && bracket == nullptr &&
+                       position - line_start < static_cast<ptrdiff_t>(kHeadBytes)) {
+                bracket = position;
+            }
+        }
+        if (at_end && line_start < end) {
+            Line(line_start, end, bracket);
+            line_start = end;
+        }
+        AppendPlain(line_start);
+        return line_start;
+    }
+
+    bool Finish() {
+        return Drain();
+    }
+
+    bool Ok() const { return ok_; }
+
+private:
+    /**
+     * @brief 处理一行 [begin, end)，end 指向换行符（最后一行可能没有换行）
+     */
+    void Line(const char* begin, const char* end, const char* bracket) {
+        LogLevel level;
+        if (!colored_ || !DetectLevel(begin, end, bracket, level)) {
+            return;  // 留在不着色区间中
+        }
+        AppendPlain(begin);
+        const std::string& code = codes_[static_cast<int>(level)];
+        buffer_.append(code);
+        buffer_.append(begin, static_cast<size_t>(end - begin));
+        buffer_.append("\033[0m");
+        plain_start_ = end;  // 换行符（若有）并入下一段不着色区间
+        if (buffer_.size() >= kOutputBytes) {
+            Drain();
+        }
+    }
+
+    /**
+     * @brief 识别一行的级别：先看行首范围内的方括号标记，再看行首范围内的大写单词
+     */
+    static bool DetectLevel(const char* begin, const char* end, const char* bracket, LogLevel& level) {
+        const char* head_end = end - begin > static_cast<ptrdiff_t>(kHeadBytes) ? begin + kHeadBytes : end;
+        while (bracket != nullptr) {
+            const char* close = static_cast<const char*>(std::memchr(bracket + 1, ']', static_cast<size_t>(end - bracket - 1)));
+            if (close == nullptr) {
+                break;
+            }
+            if (KnownLevel(std::string_view(bracket + 1, static_cast<size_t>(close - bracket - 1)), level)) {
+                return true;
+            }
+            bracket = close + 1 < head_end
+                          ? static_cast<const char*>(std::memchr(close + 1, '[', static_cast<size_t>(head_end - close - 1)))
+                          : nullptr;
+        }
+        for (const char* position = begin; position < head_end;) {
+            if (*position < 'A' || *position > 'Z') {
+                position++;
+                continue;
+            }
+            const char* word = position;
+            while (position < end && *position >= 'A' && *position <= 'Z') {
+                position++;
+            }
+            const bool bounded = (word == begin || !IsWordChar(word[-1])) && (position == end || !IsWordChar(*position));
+            if (bounded && KnownLevel(std::string_view(word, static_cast<size_t>(position - word)), level)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static bool IsWordChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    /**
+     * @brief 是否是 LevelFromType 认识的级别名（LevelFromType 对未知名称返回 INFO，需要区分）
+     */
+    static bool KnownLevel(std::string_view token, LogLevel& level) {
+        if (token.size() < 2 || token.size() > 8) {
+            return false;
+        }
+        level = ColorPrinter::LevelFromType(token);
+        return level != LogLevel::INFO || (token.size() == 4 && ::strncasecmp(token.data(), "INFO", 4) == 0);
+    }
+
+    /**
+     * @brief 把 [plain_start_, until) 这段不着色的内容追加到输出
+     */
+    void AppendPlain(const char* until) {
+        const size_t length = static_cast<size_t>(until - plain_start_);
+        if (length >= kDirectWriteBytes) {
+            Drain();
+            WriteAll(plain_start_, length);
+        } else if (length > 0) {
+            buffer_.append(plain_start_, length);
+        }
+        plain_start_ = until;
+    }
+
+    bool Drain() {
+        WriteAll(buffer_.data(), buffer_.size());
+        buffer_.clear();
+        return ok_;
+    }
+
+    void WriteAll(const char* data, size_t length) {
+        while (ok_ && length > 0) {
+            const ssize_t written = ::write(out_fd_, data, length);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ok_ = false;
+                return;
+            }
+            data += written;
+            length -= static_cast<size_t>(written);
+        }
+    }
+
+    int out_fd_;
+    bool colored_;
+    bool ok_ = true;
+    std::string buffer_;
+    std::string codes_[static_cast<int>(LogLevel::FATAL) + 1];
+    const char* plain_start_ = nullptr;
+};
+
+/**
+ * @brief 普通文件：整体映射，按窗口处理
+ *        不用 MAP_POPULATE：那会在输出第一行之前把整个文件读入内存。页面按需调入，
+ *        处理一个窗口前对下一个窗口发出 MADV_WILLNEED，已写出的页用 MADV_DONTNEED 释放，
+ *        常驻内存约为两个窗口，与文件大小无关
+ */
+bool ColorizeMapped(int fd, size_t size, Colorizer& colorizer) {
+    if (size == 0) {
+        return true;
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+    const size_t page_mask = static_cast<size_t>(::sysconf(_SC_PAGESIZE)) - 1;
+    const char* const data = static_cast<const char*>(mapped);
+    const char* const end = data + size;
+    const char* position = data;
+    size_t released = 0;  // [data, data + released) 的页已释放
+    size_t window = kMapWindowBytes;
+    while (position < end) {
+        const char* limit = static_cast<size_t>(end - position) > window ? position + window : end;
+        if (limit < end) {
+            const size_t ahead = static_cast<size_t>(limit - data) & ~page_mask;
+            ::madvise(const_cast<char*>(data) + ahead, std::min(window, size - ahead), MADV_WILLNEED);
+        }
+        const char* done = colorizer.Process(position, limit, limit == end);
+        colorizer.Finish();  // 释放页面前写出所有指向它们的内容
+        if (done == position) {
+            window *= 2;  // 整个窗口中没有换行：扩大窗口，直到包含这一行的结尾
+            continue;
+        }
+        position = done;
+        window = kMapWindowBytes;
+        const size_t consumed = static_cast<size_t>(done - data) & ~page_mask;
+        if (consumed > released) {
+            ::madvise(const_cast<char*>(data) + released, consumed - released, MADV_DONTNEED);
+            released = consumed;
+        }
+    }
+    ::munmap(mapped, size);
+    return true;
+}
+
+/**
+ * @brief 管道等不能映射的输入：大块读取，不完整的行移到缓冲区开头
+ */
+bool ColorizeStream(int fd, Colorizer& colorizer) {
+    std::unique_ptr<char[]> buffer(new char[kReadBytes]);
+    size_t filled = 0;
+    for (;;) {
+        const ssize_t length = ::read(fd, buffer.get() + filled, kReadBytes - filled);
+        if (length < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        const bool at_end = length == 0;
+        filled += static_cast<size_t>(length);
+        // 缓冲区已满仍没有换行时当作一整行处理
+        const bool forced = filled == kReadBytes;
+        const char* data = buffer.get();
+        const char* done = colorizer.Process(data, data + filled, at_end || forced);
+        colorizer.Finish();
+        const size_t remaining = static_cast<size_t>(data + filled - done);
+        std::memmove(buffer.get(), done, remaining);
+        filled = remaining;
+        if (at_end) {
+            return true;
+        }
+    }
+}
+
+bool ColorizeFd(int fd, Colorizer& colorizer) {
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode) &&
+        ColorizeMapped(fd, static_cast<size_t>(info.st_size), colorizer)) {
+        return true;
+    }
+    return ColorizeStream(fd, colorizer);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int colored = -1;
+    int first_path = argc;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--color") == 0) {
+            colored = 1;
+        } else if (std::strcmp(argv[i], "--no-color") == 0) {
+            colored = 0;
+        } else if (argv[i][0] == '-' && argv[i][1] == '-') {
+            std::fprintf(stderr, "用法: %s [--color|--no-color] [文件...]\n", argv[0]);
+            return 2;
+        } else {
+            first_path = i;
+            break;
+        }
+    }
+    if (colored < 0) {
+        colored = isatty(STDOUT_FILENO) ? 1 : 0;
+    }
+
+    Colorizer colorizer(STDOUT_FILENO, colored != 0);
+    int status = 0;
+    if (first_path == argc) {
+        if (!ColorizeFd(STDIN_FILENO, colorizer)) {
+            status = 1;
+        }
+    }
+    for (int i = first_path; i < argc; i++) {
+        const bool from_stdin = std::strcmp(argv[i], "-") == 0;
+        const int fd = from_stdin ? STDIN_FILENO : ::open(argv[i], O_RDONLY | O_CLOEXEC);
+        if (fd < 0 || !ColorizeFd(fd, colorizer)) {
+            ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无法读取: %s", argv[i]);
+            status = 1;
+        }
+        if (fd >= 0 && !from_stdin) {
+            ::close(fd);
+        }
+    }
+    if (!colorizer.Finish()) {
+        status = 1;
+    }
+    return status;
+}
@@ -0,0 +1,150 @@
+//
+// 共享内存日志总线的收集进程：创建总线，按顺序取出各进程写入的行，着色后写到真正的目的地
+// 各进程只需把打印器的输出端设为 ShmBusSink（或配置 sink = shm:<名称>）
+//
+
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include "color_printer.h"
+#include "color_printer_shm_sink.h"
+
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void OnSignal(int) {
+    g_stop = 1;
+}
+
+static bool WriteOut(int fd, std::string& buffer) {
+    size_t offset = 0;
+    while (offset < buffer.size()) {
+        const ssize_t written = ::write(fd, buffer.data() + offset, buffer.size() - offset);
+        if (written <= 0) {
+            return false;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    buffer.clear();
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string name = "/color_printer_bus";
+    uint64_t size_mb = 64;
+    const char* output_path = nullptr;
+    int colored = -1;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--name") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            size_mb = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--color") == 0) {
+            colored = 1;
+        } else if (std::strcmp(argv[i], "--no-color") == 0) {
+            colored = 0;
+        } else {
+            std::fprintf(stderr, "用法: %s [--name /总线名] [--size MB] [--output 文件] [--color|--no-color]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    int out_fd = STDOUT_FILENO;
+    if (output_path != nullptr) {
+        out_fd = ::open(output_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (out_fd < 0) {
+            ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无法打开输出文件: %s", output_path);
+            return 1;
+        }
+    }
+    if (colored < 0) {
+        colored = isatty(out_fd) ? 1 : 0;
+    }
+
+    ShmBusHeader* bus = ShmBusSink::Create(name, size_mb * 1024 * 1024);
+    if (bus == nullptr) {
+        ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无法创建共享内存总线: %s", name.c_str());
+        return 1;
+    }
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::string buffer;
+    buffer.reserve(1024 * 1024);
+    auto on_record = [&](PrintColor color, LogLevel, std::string_view line) {
+        if (colored) {
+            buffer += ColorPrinter::GetColorCode(color);
+            buffer.append(line.substr(0, line.size() - 1));
+            buffer += "\033[0m\n";
+        } else {
+            buffer.append(line);
+        }
+    };
+
+    // 同一位置长时间停在尚未写完（或尚未写入记录头）的记录上，说明写入它的进程已经退出
+    constexpr auto kStuckTimeout = std::chrono::seconds(1);
+    uint64_t stuck_tail = UINT64_MAX;
+    uint64_t stuck_head = ShmBusSink::kNotStuck;
+    auto stuck_since = std::chrono::steady_clock::now();
+    bool ok = true;
+    while (ok) {
+        const bool stopping = g_stop != 0;
+        size_t records = 0;
+        bool skip = false;
+        const uint64_t tail = bus->tail.load(std::memory_order_relaxed);
+        if (tail == stuck_tail && std::chrono::steady_clock::now() - stuck_since > kStuckTimeout) {
+            skip = true;
+        }
+        records = ShmBusSink::Drain(bus, 1024 * 1024, skip ? stuck_head : ShmBusSink::kNotStuck, on_record);
+        if (!buffer.empty() && (buffer.size() >= 256 * 1024 || records == 0)) {
+            ok = WriteOut(out_fd, buffer);
+        }
+        if (records > 0 || skip) {
+            stuck_tail = UINT64_MAX;
+            continue;
+        }
+        if (stopping) {
+            break;
+        }
+        const uint64_t head = bus->head.load(std::memory_order_acquire);
+        if (head != bus->tail.load(std::memory_order_relaxed)) {
+            if (stuck_tail != tail) {
+                stuck_tail = tail;
+                stuck_head = head;
+                stuck_since = std::chrono::steady_clock::now();
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        } else {
+            ShmBusSink::WaitForData(bus, 100);
+        }
+    }
+    if (!buffer.empty()) {
+        WriteOut(out_fd, buffer);
+    }
+
+    const uint64_t dropped = bus->dropped.load(std::memory_order_relaxed);
+    if (dropped > 0) {
+        ColorPrinter::PrintColoredMessage(PrintColor::YELLOW, "WARNING", "共享内存总线丢弃了 %llu 条消息",
+                                          static_cast<unsigned long long>(dropped));
+    }
+    const uint64_t resync_bytes = bus->resync_bytes.load(std::memory_order_relaxed);
+    if (resync_bytes > 0) {
+        ColorPrinter::PrintColoredMessage(PrintColor::YELLOW, "WARNING",
+                                          "跳过写入进程已退出的记录时丢弃了 %llu 字节（其中的消息条数未知）",
+                                          static_cast<unsigned long long>(resync_bytes));
+    }
+    ShmBusSink::Remove(name, bus);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+//
+// 本地日志收集端：接收 NetworkSink 发出的批次，统计吞吐量与丢失的消息，可选择把消息输出到标准输出
+// 只用于测试与本机调试，不依赖任何外部服务
+//
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include "color_printer.h"
+#include "color_printer_network_sink.h"
+
+
+static volatile sig_atomic_t g_stop = 0;
+
+static void OnSignal(int) {
+    g_stop = 1;
+}
+
+struct CollectorStats {
+    uint64_t frames = 0;
+    uint64_t records = 0;
+    uint64_t bytes = 0;
+    uint64_t lost = 0;        // 按序号空缺统计
+    uint64_t duplicated = 0;  // 序号回退（重发）
+    uint64_t bad_frames = 0;
+    std::unordered_map<uint64_t, uint64_t> next_record;  // stream_id -> 期望的下一个序号
+};
+
+/**
+ * @brief 处理一个完整的帧
+ */
+static void HandleFrame(const NetworkFrameHeader& header, const char* payload, bool print, CollectorStats& stats) {
+    stats.frames++;
+    stats.records += header.record_count;
+    stats.bytes += sizeof(header) + header.payload_bytes;
+    auto [entry, inserted] = stats.next_record.try_emplace(header.stream_id, 0);
+    uint64_t& expected = entry->second;
+    if (header.first_record > expected) {
+        stats.lost += header.first_record - expected;
+    } else if (header.first_record < expected) {
+        stats.duplicated += std::min<uint64_t>(expected - header.first_record, header.record_count);
+    }
+    expected = std::max(expected, header.first_record + header.record_count);
+    if (print) {
+        size_t offset = 0;
+        while (offset < header.payload_bytes) {
+            const ssize_t written = ::write(STDOUT_FILENO, payload + offset, header.payload_bytes - offset);
+            if (written <= 0) {
+                break;
+            }
+            offset += static_cast<size_t>(written);
+        }
+    }
+}
+
+static bool ValidHeader(const NetworkFrameHeader& header) {
+    return std::memcmp(header.magic, NetworkFrameHeader::kMagic, sizeof(header.magic)) == 0;
+}
+
+static void PrintStats(const CollectorStats& stats, double seconds) {
+    std::fprintf(stderr, "批次 %llu  消息 %llu  字节 %llu  丢失 %llu  重复 %llu  坏帧 %llu  %.1f 条/秒  %.2f MB/秒\n",
+                 static_cast<unsigned long long>(stats.frames), static_cast<unsigned long long>(stats.records),
+                 static_cast<unsigned long long>(stats.bytes), static_cast<unsigned long long>(stats.lost),
+                 static_cast<unsigned long long>(stats.duplicated), static_cast<unsigned long long>(stats.bad_frames),
+                 seconds > 0 ? static_cast<double>(stats.records) / seconds : 0.0,
+                 seconds > 0 ? static_cast<double>(stats.bytes) / seconds / (1024.0 * 1024.0) : 0.0);
+}
+
+int main(int argc, char *argv[])
+{
+    bool udp = false;
+    bool print = false;
+    uint16_t port = 5140;
+    std::string bind_address = "127.0.0.1";
+    uint64_t expect = 0;
+    long idle_exit_ms = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--udp") == 0) {
+            udp = true;
+        } else if (std::strcmp(argv[i], "--tcp") == 0) {
+            udp = false;
+        } else if (std::strcmp(argv[i], "--print") == 0) {
+            print = true;
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = static_cast<uint16_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--bind") == 0 && i + 1 < argc) {
+            bind_address = argv[++i];
+        } else if (std::strcmp(argv[i], "--expect") == 0 && i + 1 < argc) {
+            expect = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--idle-exit") == 0 && i + 1 < argc) {
+            idle_exit_ms = std::strtol(argv[++i], nullptr, 10);
+        } else {
+            std::fprintf(stderr,
+                         "用法: %s [--tcp|--udp] [--port 端口] [--bind 地址] [--print]\n"
+                         "          [--expect 消息数] [--idle-exit 毫秒]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (::inet_pton(AF_INET, bind_address.c_str(), &address.sin_addr) != 1) {
+        ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无效的地址: %s", bind_address.c_str());
+        return 2;
+    }
+    const int listen_fd = ::socket(AF_INET, (udp ? SOCK_DGRAM : SOCK_STREAM) | SOCK_CLOEXEC, 0);
+    const int reuse = 1;
+    ::setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (udp) {
+        const int receive_buffer = 8 * 1024 * 1024;
+        ::setsockopt(listen_fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+    }
+    if (listen_fd < 0 || ::bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        (!udp && ::listen(listen_fd, 16) != 0)) {
+        ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无法监听 %s:%u", bind_address.c_str(),
+                                          static_cast<unsigned>(port));
+        return 1;
+    }
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+    ColorPrinter::PrintColoredMessage(PrintColor::GREEN, "INFO", "收集端已在 %s %s:%u 上监听", udp ? "UDP" : "TCP",
+                                      bind_address.c_str(), static_cast<unsigned>(port));
+    ColorPrinter::Flush();
+
+    CollectorStats stats;
+    std::vector<pollfd> descriptors{{listen_fd, POLLIN, 0}};
+    std::vector<std::string> buffers{std::string()};  // 与 descriptors 对应，TCP 连接上未处理完的数据
+    std::vector<char> chunk(1024 * 1024);
+    const auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    auto last_activity = start;
+
+    while (!g_stop && (expect == 0 || stats.records + stats.lost < expect)) {
+        const int ready = ::poll(descriptors.data(), descriptors.size(), 200);
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_report >= std::chrono::seconds(1)) {
+            PrintStats(stats, std::chrono::duration<double>(now - start).count());
+            last_report = now;
+        }
+        if (ready <= 0) {
+            if (idle_exit_ms > 0 && stats.frames > 0 && now - last_activity >= std::chrono::milliseconds(idle_exit_ms)) {
+                break;
+            }
+            continue;
+        }
+        last_activity = now;
+
+        if (udp) {
+            // 每个数据报是一个完整的帧
+            while (true) {
+                const ssize_t received = ::recv(listen_fd, chunk.data(), chunk.size(), MSG_DONTWAIT);
+                if (received <= 0) {
+                    break;
+                }
+                NetworkFrameHeader header;
+                if (static_cast<size_t>(received) < sizeof(header)) {
+                    stats.bad_frames++;
+                    continue;
+                }
+                std::memcpy(&header, chunk.data(), sizeof(header));
+                if (!ValidHeader(header) || sizeof(header) + header.payload_bytes != static_cast<size_t>(received)) {
+                    stats.bad_frames++;
+                    continue;
+                }
+                HandleFrame(header, chunk.data() + sizeof(header), print, stats);
+            }
+            continue;
+        }
+
+        if (descriptors[0].revents & POLLIN) {
+            const int client = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0) {
+                descriptors.push_back({client, POLLIN, 0});
+                buffers.emplace_back();
+            }
+        }
+        for (size_t i = 1; i < descriptors.size(); i++) {
+            if (descriptors[i].revents == 0) {
+                continue;
+            }
+            const ssize_t received = ::recv(descriptors[i].fd, chunk.data(), chunk.size(), 0);
+            bool closed = received <= 0;
+            if (!closed) {
+                std::string& buffer = buffers[i];
+                buffer.append(chunk.data(), static_cast<size_t>(received));
+                size_t offset = 0;
+                while (buffer.size() - offset >= sizeof(NetworkFrameHeader)) {
+                    NetworkFrameHeader header;
+                    std::memcpy(&header, buffer.data() + offset, sizeof(header));
+                    if (!ValidHeader(header)) {
+                        stats.bad_frames++;
+                        closed = true;  // 流已错位，断开该连接
+                        break;
+                    }
+                    if (buffer.size() - offset < sizeof(header) + header.payload_bytes) {
+                        break;
+                    }
+                    HandleFrame(header, buffer.data() + offset + sizeof(header), print, stats);
+                    offset += sizeof(header) + header.payload_bytes;
+                }
+                buffer.erase(0, offset);
+            }
+            if (closed) {
+                ::close(descriptors[i].fd);
+                descriptors.erase(descriptors.begin() + static_cast<long>(i));
+                buffers.erase(buffers.begin() + static_cast<long>(i));
+                i--;
+            }
+        }
+    }
+
+    PrintStats(stats, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    for (const pollfd& descriptor : descriptors) {
+        ::close(descriptor.fd);
+    }
+    return stats.lost == 0 ? 0 : 3;
+}
@@ -0,0 +1,433 @@
+/**
+ * @file color_printer_compressed_sink.cpp
+ * @brief 块压缩文件输出端的实现
+ */
+
+#include "color_printer_compressed_sink.h"
+#include "color_printer_internal.h"
+#include "color_printer_lz.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifdef COLOR_PRINTER_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+uint32_t Fnv1a(const void* data, size_t length) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+uint32_t HeaderCheck(const CompressedBlockHeader& header) {
+    return Fnv1a(&header, offsetof(CompressedBlockHeader, header_check));
+}
+
+bool PreadAll(int fd, char* data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        const ssize_t count = ::pread(fd, data, length, static_cast<off_t>(offset));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        data += count;
+        length -= static_cast<size_t>(count);
+        offset += static_cast<uint64_t>(count);
+    }
+    return true;
+}
+
+double ThreadCpuSeconds() {
+    timespec now;
+    ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) / 1e9;
+}
+
+/**
+ * @brief 解压一个块到 dst（长度为 header.raw_bytes）
+ */
+bool DecodeBlock(const CompressedBlockHeader& header, const char* payload, char* dst) {
+    switch (static_cast<CompressionCodec>(header.codec)) {
+    case CompressionCodec::NONE:
+        if (header.stored_bytes != header.raw_bytes) {
+            return false;
+        }
+        std::memcpy(dst, payload, header.raw_bytes);
+        return true;
+    case CompressionCodec::LZ:
+        return color_printer_detail::LzDecompress(payload, header.stored_bytes, dst, header.raw_bytes);
+    case CompressionCodec::ZLIB: {
+#ifdef COLOR_PRINTER_HAVE_ZLIB
+        uLongf raw_bytes = header.raw_bytes;
+        return ::uncompress(reinterpret_cast<Bytef*>(dst), &raw_bytes, reinterpret_cast<const Bytef*>(payload),
+                            header.stored_bytes) == Z_OK && raw_bytes == header.raw_bytes;
+#else
+        return false;  // 构建时没有 zlib
+#endif
+    }
+    }
+    return false;
+}
+
+/**
+ * @brief 准备在有效块之后追加
+ *        有效块之后的内容只有像是崩溃时写了一半的块（以帧头魔数或其前缀开头）才截掉；
+ *        其他内容说明文件不是压缩日志或被别的程序改写过，拒绝打开，不破坏原有数据
+ *
+ * @param fd 以读写方式打开的文件
+ * @param valid_bytes ReadBlockIndex 得到的有效块总字节数
+ * @return 可以从 valid_bytes 处继续追加时返回true
+ */
+bool PrepareAppend(int fd, uint64_t valid_bytes) {
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        return false;
+    }
+    const uint64_t file_bytes = static_cast<uint64_t>(info.st_size);
+    if (file_bytes > valid_bytes) {
+        char tail[sizeof(CompressedBlockHeader::kMagic)];
+        const size_t tail_bytes = static_cast<size_t>(std::min<uint64_t>(sizeof(tail), file_bytes - valid_bytes));
+        const bool partial_block = PreadAll(fd, tail, tail_bytes, valid_bytes) &&
+                                   std::memcmp(tail, CompressedBlockHeader::kMagic, tail_bytes) == 0;
+        if (!partial_block || ::ftruncate(fd, static_cast<off_t>(valid_bytes)) != 0) {
+            return false;
+        }
+    }
+    return ::lseek(fd, static_cast<off_t>(valid_bytes), SEEK_SET) >= 0;
+}
+
+} // namespace
+
+CompressedFileSink::CompressedFileSink(CompressedFileOptions options)
+    : options_(std::move(options)), codec_(options_.codec) {
+#ifndef COLOR_PRINTER_HAVE_ZLIB
+    if (codec_ == CompressionCodec::ZLIB) {
+        codec_ = CompressionCodec::LZ;
+    }
+#endif
+    std::vector<CompressedBlockHeader> blocks;
+    uint64_t valid_bytes = 0;
+    if (ReadBlockIndex(options_.path, blocks, &valid_bytes) && !blocks.empty()) {
+        raw_offset_ = blocks.back().raw_offset + blocks.back().raw_bytes;
+    }
+    fd_ = ::open(options_.path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ >= 0 && !PrepareAppend(fd_, valid_bytes)) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    active_.reserve(options_.block_bytes);
+    compressor_ = std::thread(&CompressedFileSink::CompressorLoop, this);
+}
+
+CompressedFileSink::~CompressedFileSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SubmitActiveLocked();
+        stop_ = true;
+    }
+    compressor_cv_.notify_one();
+    compressor_.join();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+/**
+ * @brief 把一批行拷贝进当前块；块只在行边界处结束
+ */
+void CompressedFileSink::Write(const LogRecord* records, size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < count; i++) {
+        const std::string_view line = records[i].line;
+        if (!active_.empty() && active_.size() + line.size() > options_.block_bytes) {
+            HandOffActiveLocked(lock);
+        }
+        active_.append(line);
+        if (active_.size() >= options_.block_bytes) {
+            HandOffActiveLocked(lock);
+        }
+    }
+}
+
+void CompressedFileSink::Flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    SubmitActiveLocked();
+    const uint64_t target = submitted_;
+    compressor_cv_.notify_one();
+    done_cv_.wait(lock, [this, target] { return written_ >= target; });
+}
+
+CompressionStats CompressedFileSink::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+/**
+ * @brief 把当前块交给压缩线程，积压达到上限时等待
+ */
+void CompressedFileSink::HandOffActiveLocked(std::unique_lock<std::mutex>& lock) {
+    done_cv_.wait(lock, [this] { return full_.size() < options_.max_blocks; });
+    SubmitActiveLocked();
+    compressor_cv_.notify_one();
+}
+
+void CompressedFileSink::SubmitActiveLocked() {
+    if (active_.empty()) {
+        return;
+    }
+    full_.push_back(std::move(active_));
+    submitted_++;
+    if (spare_.empty()) {
+        active_ = std::string();
+        active_.reserve(options_.block_bytes);
+    } else {
+        active_ = std::move(spare_.back());
+        spare_.pop_back();
+    }
+}
+
+void CompressedFileSink::CompressorLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto next_flush = std::chrono::steady_clock::now() + options_.flush_interval;
+    while (true) {
+        compressor_cv_.wait_until(lock, next_flush, [this] { return stop_ || !full_.empty(); });
+        const auto now = std::chrono::steady_clock::now();
+        if (full_.empty() && now >= next_flush) {
+            SubmitActiveLocked();
+            next_flush = now + options_.flush_interval;
+        }
+        if (full_.empty()) {
+            if (stop_) {
+                break;
+            }
+            continue;
+        }
+
+        std::string block = std::move(full_.front());
+        full_.pop_front();
+        lock.unlock();
+        CompressBlock(block);
+        block.clear();
+        lock.lock();
+        spare_.push_back(std::move(block));
+        written_++;
+        done_cv_.notify_all();
+    }
+}
+
+/**
+ * @brief 压缩一个块并连同帧头一次写出；压缩后不变小的块原样存储
+ */
+void CompressedFileSink::CompressBlock(const std::string& block) {
+    const double cpu_before = ThreadCpuSeconds();
+    CompressionCodec codec = codec_;
+    compressed_.clear();
+    if (codec == CompressionCodec::LZ) {
+        color_printer_detail::LzCompress(block.data(), block.size(), compressed_);
+    }
+#ifdef COLOR_PRINTER_HAVE_ZLIB
+    if (codec == CompressionCodec::ZLIB) {
+        uLongf compressed_bytes = ::compressBound(block.size());
+        compressed_.resize(compressed_bytes);
+        if (::compress2(reinterpret_cast<Bytef*>(compressed_.data()), &compressed_bytes,
+                        reinterpret_cast<const Bytef*>(block.data()), block.size(), options_.zlib_level) == Z_OK) {
+            compressed_.resize(compressed_bytes);
+        } else {
+            codec = CompressionCodec::NONE;
+        }
+    }
+#endif
+    if (codec == CompressionCodec::NONE || compressed_.size() >= block.size()) {
+        codec = CompressionCodec::NONE;
+    }
+    const char* payload = codec == CompressionCodec::NONE ? block.data() : compressed_.data();
+    const size_t payload_bytes = codec == CompressionCodec::NONE ? block.size() : compressed_.size();
+
+    CompressedBlockHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CompressedBlockHeader::kMagic, sizeof(header.magic));
+    header.codec = static_cast<uint8_t>(codec);
+    header.raw_bytes = static_cast<uint32_t>(block.size());
+    header.stored_bytes = static_cast<uint32_t>(payload_bytes);
+    header.raw_offset = raw_offset_;
+    header.checksum = Fnv1a(payload, payload_bytes);
+    header.header_check = HeaderCheck(header);
+    const double cpu_seconds = ThreadCpuSeconds() - cpu_before;
+
+    if (fd_ >= 0) {
+        iovec segments[2] = {{&header, sizeof(header)}, {const_cast<char*>(payload), payload_bytes}};
+        color_printer_detail::WriteVAll(fd_, segments, 2);
+    }
+    raw_offset_ += block.size();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.blocks++;
+    stats_.raw_bytes += block.size();
+    stats_.stored_bytes += sizeof(header) + payload_bytes;
+    stats_.cpu_seconds += cpu_seconds;
+}
+
+/**
+ * @brief 依次读取帧头并跳过块数据；中间的块只校验帧头，最后一个块另外校验数据
+ *        （崩溃只可能破坏文件尾部，打开大文件时不必读完全部数据）
+ */
+bool CompressedFileSink::ReadBlockIndex(const std::string& path, std::vector<CompressedBlockHeader>& blocks,
+                                        uint64_t* valid_bytes) {
+    blocks.clear();
+    if (valid_bytes != nullptr) {
+        *valid_bytes = 0;
+    }
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    const uint64_t file_bytes = static_cast<uint64_t>(info.st_size);
+    uint64_t offset = 0;
+    uint64_t raw_offset = 0;
+    while (offset + sizeof(CompressedBlockHeader) <= file_bytes) {
+        CompressedBlockHeader header;
+        if (!PreadAll(fd, reinterpret_cast<char*>(&header), sizeof(header), offset) ||
+            std::memcmp(header.magic, CompressedBlockHeader::kMagic, sizeof(header.magic)) != 0 ||
+            header.header_check != HeaderCheck(header) ||
+            offset + sizeof(header) + header.stored_bytes > file_bytes ||
+            (!blocks.empty() && header.raw_offset != raw_offset)) {
+            break;
+        }
+        blocks.push_back(header);
+        raw_offset = header.raw_offset + header.raw_bytes;
+        offset += sizeof(header) + header.stored_bytes;
+    }
+    if (!blocks.empty()) {
+        const CompressedBlockHeader& last = blocks.back();
+        std::string payload(last.stored_bytes, '\0');
+        const uint64_t last_offset = offset - last.stored_bytes - sizeof(last);
+        if (!PreadAll(fd, payload.data(), payload.size(), last_offset + sizeof(last)) ||
+            Fnv1a(payload.data(), payload.size()) != last.checksum) {
+            blocks.pop_back();
+            offset = last_offset;
+        }
+    }
+    ::close(fd);
+    if (valid_bytes != nullptr) {
+        *valid_bytes = offset;
+    }
+    return true;
+}
+
+/**
+ * @brief 工作线程并行解压，解压结果放在环形的槽里；调用线程按块的顺序交给 consumer
+ *        工作线程最多领先调用线程 2 × threads 个块，内存占用与文件大小无关
+ */
+bool CompressedFileSink::Decompress(const std::string& path, const std::function<bool(std::string_view)>& consumer,
+                                    unsigned threads) {
+    std::vector<CompressedBlockHeader> blocks;
+    if (!ReadBlockIndex(path, blocks)) {
+        return false;
+    }
+    if (blocks.empty()) {
+        return true;
+    }
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    // 各块在文件中的位置可以由帧头算出
+    std::vector<uint64_t> file_offsets(blocks.size());
+    uint64_t file_offset = 0;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        file_offsets[i] = file_offset;
+        file_offset += sizeof(CompressedBlockHeader) + blocks[i].stored_bytes;
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, blocks.size()));
+
+    struct Slot {
+        std::string data;
+        bool ready = false;
+    };
+    const size_t slot_count = static_cast<size_t>(threads) * 2;
+    std::vector<Slot> slots(slot_count);
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t next = 0;     // 下一个待解压的块
+    size_t emitted = 0;  // 已交给 consumer 的块数
+    bool ok = true;
+
+    auto worker = [&]() {
+        std::string payload;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cv.wait(lock, [&] { return !ok || next >= blocks.size() || next < emitted + slot_count; });
+            if (!ok || next >= blocks.size()) {
+                return;
+            }
+            const size_t i = next++;
+            Slot& slot = slots[i % slot_count];
+            lock.unlock();
+            const CompressedBlockHeader& header = blocks[i];
+            payload.resize(header.stored_bytes);
+            slot.data.resize(header.raw_bytes);
+            const bool decoded = PreadAll(fd, payload.data(), payload.size(), file_offsets[i] + sizeof(header)) &&
+                                 Fnv1a(payload.data(), payload.size()) == header.checksum &&
+                                 DecodeBlock(header, payload.data(), slot.data.data());
+            lock.lock();
+            if (decoded) {
+                slot.ready = true;
+            } else {
+                ok = false;
+            }
+            cv.notify_all();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(worker);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (ok && emitted < blocks.size()) {
+            Slot& slot = slots[emitted % slot_count];
+            cv.wait(lock, [&] { return !ok || slot.ready; });
+            if (!ok) {
+                break;
+            }
+            lock.unlock();
+            const bool more = consumer(slot.data);
+            lock.lock();
+            slot.ready = false;
+            emitted++;
+            ok = more;
+            cv.notify_all();
+        }
+    }
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    ::close(fd);
+    return ok;
+}
@@ -0,0 +1,271 @@
+/**
+ * @file color_printer_config.cpp
+ * @brief 打印器配置的解析与热加载
+ */
+
+#include "color_printer.h"
+#include "color_printer_file_sink.h"
+#include "color_printer_journal_sink.h"
+#include "color_printer_shm_sink.h"
+#include "color_printer_internal.h"
+#include "color_printer_snapshot.h"
+
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+
+std::string_view Trim(std::string_view text) {
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::toupper(static_cast<unsigned char>(a[i])) != std::toupper(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ParseBool(std::string_view text, bool& value) {
+    if (EqualsIgnoreCase(text, "true") || EqualsIgnoreCase(text, "on") || text == "1") {
+        value = true;
+        return true;
+    }
+    if (EqualsIgnoreCase(text, "false") || EqualsIgnoreCase(text, "off") || text == "0") {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+bool ParseLevel(std::string_view text, LogLevel& level) {
+    static constexpr std::string_view kNames[] = {"DEBUG", "INFO", "OK", "WARNING", "ERROR", "FATAL"};
+    for (size_t i = 0; i < std::size(kNames); i++) {
+        if (EqualsIgnoreCase(text, kNames[i])) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ParseColor(std::string_view text, PrintColor& color) {
+    static constexpr std::string_view kNames[] = {"RED", "GREEN", "YELLOW", "BLUE", "MAGENTA", "CYAN", "WHITE"};
+    for (size_t i = 0; i < std::size(kNames); i++) {
+        if (EqualsIgnoreCase(text, kNames[i])) {
+            color = static_cast<PrintColor>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+namespace color_printer_detail {
+
+unsigned ThreadReaderShard() {
+    static std::atomic<unsigned> next_shard{0};
+    thread_local const unsigned shard = next_shard.fetch_add(1, std::memory_order_relaxed);
+    return shard;
+}
+
+ConfigFileWatcher::ConfigFileWatcher(std::string path, std::function<void(const std::string&)> on_change)
+    : path_(std::move(path)), on_change_(std::move(on_change)) {
+    const size_t slash = path_.rfind('/');
+    directory_ = slash == std::string::npos ? "." : (slash == 0 ? "/" : path_.substr(0, slash));
+    file_name_ = slash == std::string::npos ? path_ : path_.substr(slash + 1);
+}
+
+ConfigFileWatcher::~ConfigFileWatcher() {
+    if (stop_fd_ >= 0) {
+        const uint64_t one = 1;
+        (void)::write(stop_fd_, &one, sizeof(one));
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (inotify_fd_ >= 0) {
+        ::close(inotify_fd_);
+    }
+    if (stop_fd_ >= 0) {
+        ::close(stop_fd_);
+    }
+}
+
+bool ConfigFileWatcher::Start() {
+    inotify_fd_ = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    stop_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (inotify_fd_ < 0 || stop_fd_ < 0) {
+        return false;
+    }
+    if (inotify_add_watch(inotify_fd_, directory_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+        return false;
+    }
+    if (::access(path_.c_str(), R_OK) != 0) {
+        return false;
+    }
+    Reload();
+    thread_ = std::thread(&ConfigFileWatcher::Run, this);
+    return true;
+}
+
+void ConfigFileWatcher::Run() {
+    alignas(inotify_event) char buffer[16 * (sizeof(inotify_event) + NAME_MAX + 1)];
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+    while (true) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        if (fds[1].revents != 0) {
+            return;
+        }
+        bool changed = false;
+        ssize_t length;
+        while ((length = ::read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+            for (char* cursor = buffer; cursor < buffer + length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+                if (event->len > 0 && file_name_ == event->name) {
+                    changed = true;
+                }
+                cursor += sizeof(inotify_event) + event->len;
+            }
+        }
+        if (changed) {
+            Reload();
+        }
+    }
+}
+
+void ConfigFileWatcher::Reload() {
+    FILE* file = std::fopen(path_.c_str(), "rb");
+    if (file == nullptr) {
+        return;  // 文件正被替换，等待下一次事件
+    }
+    std::string text;
+    char chunk[4096];
+    size_t count;
+    while ((count = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text.append(chunk, count);
+    }
+    std::fclose(file);
+    on_change_(text);
+}
+
+} // namespace color_printer_detail
+
+/**
+ * @brief 解析文本格式的打印器配置
+ *
+ * @param text 配置文本
+ * @param config 输入为基础配置，输出为解析后的配置
+ * @param error 解析失败时写入错误描述（可为空）
+ * @return 解析成功返回true；失败时 config 不变
+ */
+bool ColorPrinter::ParseConfig(std::string_view text, PrinterConfig& config, std::string* error) {
+    PrinterConfig parsed = config;
+    size_t line_number = 0;
+    auto fail = [&](std::string_view reason) {
+        if (error != nullptr) {
+            *error = "第" + std::to_string(line_number) + "行: " + std::string(reason);
+        }
+        return false;
+    };
+
+    while (!text.empty()) {
+        line_number++;
+        const size_t end = text.find('\n');
+        std::string_view line = Trim(text.substr(0, end));
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        const size_t equals = line.find('=');
+        if (equals == std::string_view::npos) {
+            return fail("缺少'='");
+        }
+        const std::string_view key = Trim(line.substr(0, equals));
+        const std::string_view value = Trim(line.substr(equals + 1));
+
+        if (key == "min_level") {
+            if (!ParseLevel(value, parsed.min_level)) {
+                return fail("未知的日志级别");
+            }
+        } else if (key == "sync_level") {
+            if (!ParseLevel(value, parsed.sync_level)) {
+                return fail("未知的日志级别");
+            }
+        } else if (key == "colored") {
+            if (!ParseBool(value, parsed.colored)) {
+                return fail("应为 true 或 false");
+            }
+        } else if (key == "timestamp") {
+            if (!ParseBool(value, parsed.timestamp)) {
+                return fail("应为 true 或 false");
+            }
+        } else if (key.substr(0, 6) == "color.") {
+            LogLevel level;
+            if (!ParseLevel(key.substr(6), level)) {
+                return fail("未知的日志级别");
+            }
+            PrintColor color;
+            if (EqualsIgnoreCase(value, "none")) {
+                parsed.level_colors[static_cast<size_t>(level)].reset();
+            } else if (ParseColor(value, color)) {
+                parsed.level_colors[static_cast<size_t>(level)] = color;
+            } else {
+                return fail("未知的颜色");
+            }
+        } else if (key == "sink") {
+            if (parsed.sink && value == parsed.sink_spec) {
+                continue;  // 描述未变：保留现有输出端（及其打开的文件、连接）
+            }
+            if (value == "stdout") {
+                parsed.sink = std::make_shared<FdSink>(STDOUT_FILENO);
+            } else if (value == "stderr") {
+                parsed.sink = std::make_shared<FdSink>(STDERR_FILENO);
+            } else if (value.substr(0, 5) == "file:" && value.size() > 5) {
+                RotatingFileOptions options;
+                options.path = std::string(value.substr(5));
+                parsed.sink = std::make_shared<RotatingFileSink>(std::move(options));
+            } else if (value.substr(0, 4) == "shm:" && value.size() > 4) {
+                parsed.sink = std::make_shared<ShmBusSink>(std::string(value.substr(4)));
+            } else if (value == "journal") {
+                parsed.sink = std::make_shared<JournalSink>();
+            } else if (value == "syslog") {
+                JournalOptions options;
+                options.protocol = JournalProtocol::SYSLOG;
+                parsed.sink = std::make_shared<JournalSink>(std::move(options));
+            } else {
+                return fail("未知的输出端");
+            }
+            parsed.sink_spec = std::string(value);
+        } else {
+            return fail("未知的配置项");
+        }
+    }
+
+    config = std::move(parsed);
+    return true;
+}
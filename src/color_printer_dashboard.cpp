@@ -0,0 +1,541 @@
+/**
+ * @file color_printer_dashboard.cpp
+ * @brief ColorPrinter::Dashboard 的实现
+ */
+
+#include "color_printer.h"
+#include "color_printer_footer_sink.h"
+#include "color_printer_internal.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sys/ioctl.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr int kBarCells = 20;
+constexpr int kMaxLabelWidth = 24;
+constexpr int kMergeGap = 3;  // 两段变化之间相同的字符不超过这么多时直接重写，比移动光标更省字节
+
+/**
+ * @struct Cell
+ * @brief 屏幕上的一格：UTF-8 字符与颜色（0 为默认颜色，否则为 PrintColor + 1）
+ *        宽字符占两格，第二格的 width 为0
+ */
+struct Cell {
+    char bytes[4] = {' ', 0, 0, 0};
+    uint8_t length = 1;
+    uint8_t width = 1;
+    uint8_t color = 0;
+
+    bool operator==(const Cell& other) const {
+        return length == other.length && width == other.width && color == other.color &&
+               std::memcmp(bytes, other.bytes, length) == 0;
+    }
+    bool operator!=(const Cell& other) const { return !(*this == other); }
+};
+
+using Line = std::vector<Cell>;
+
+/**
+ * @brief 把 UTF-8 文本按格追加到一行，超过 max_width 列的部分截断
+ */
+void AppendText(Line& line, std::string_view text, uint8_t color, size_t max_width) {
+    size_t i = 0;
+    while (i < text.size() && line.size() < max_width) {
+        const unsigned char lead = static_cast<unsigned char>(text[i]);
+        size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 1;
+        length = std::min(length, text.size() - i);
+        uint32_t codepoint = length == 1 ? lead : lead & (0xFF >> (length + 1));
+        for (size_t k = 1; k < length; k++) {
+            codepoint = (codepoint << 6) | (static_cast<unsigned char>(text[i + k]) & 0x3F);
+        }
+        const bool wide = color_printer_detail::IsWideCodepoint(codepoint);
+        if (wide && line.size() + 2 > max_width) {
+            break;
+        }
+        Cell cell;
+        std::memcpy(cell.bytes, text.data() + i, length);
+        cell.length = static_cast<uint8_t>(length);
+        cell.width = wide ? 2 : 1;
+        cell.color = color;
+        line.push_back(cell);
+        if (wide) {
+            Cell tail;
+            tail.length = 0;
+            tail.width = 0;
+            tail.color = color;
+            line.push_back(tail);
+        }
+        i += length;
+    }
+}
+
+} // namespace
+
+namespace color_printer_detail {
+
+bool IsWideCodepoint(uint32_t codepoint) {
+    return (codepoint >= 0x1100 && codepoint <= 0x115F) || (codepoint >= 0x2E80 && codepoint <= 0xA4CF) ||
+           (codepoint >= 0xAC00 && codepoint <= 0xD7A3) || (codepoint >= 0xF900 && codepoint <= 0xFAFF) ||
+           (codepoint >= 0xFE30 && codepoint <= 0xFE4F) || (codepoint >= 0xFF00 && codepoint <= 0xFF60) ||
+           (codepoint >= 0xFFE0 && codepoint <= 0xFFE6) || (codepoint >= 0x1F300 && codepoint <= 0x1FAFF) ||
+           (codepoint >= 0x20000 && codepoint <= 0x3FFFD);
+}
+
+size_t DisplayWidth(std::string_view text) {
+    Line line;
+    AppendText(line, text, 0, SIZE_MAX);
+    return line.size();
+}
+
+size_t PrefixForWidth(std::string_view text, size_t max_width) {
+    Line line;
+    AppendText(line, text, 0, max_width);
+    size_t bytes = 0;
+    for (const Cell& cell : line) {
+        bytes += cell.length;
+    }
+    return bytes;
+}
+
+size_t TerminalWidth(int fd) {
+    winsize size = {};
+    if (::ioctl(fd, TIOCGWINSZ, &size) == 0 && size.ws_col > 0) {
+        return size.ws_col;
+    }
+    return 80;
+}
+
+size_t TerminalHeight(int fd) {
+    winsize size = {};
+    if (::ioctl(fd, TIOCGWINSZ, &size) == 0) {
+        return size.ws_row;
+    }
+    return 0;
+}
+
+} // namespace color_printer_detail
+
+/**
+ * @struct ColorPrinter::Dashboard::Row::State
+ * @brief 一行的数据；done 由工作线程无锁累加，其余字段由 mutex 保护
+ */
+struct ColorPrinter::Dashboard::Row::State {
+    alignas(64) std::atomic<uint64_t> done{0};
+    std::atomic<uint64_t> total{0};
+    alignas(64) std::mutex mutex;
+    std::string label;
+    std::string state;
+    PrintColor color = PrintColor::GREEN;
+    color_printer_detail::RateMeter rate;  // 只由绘制线程访问
+};
+
+void ColorPrinter::Dashboard::Row::Advance(uint64_t count) {
+    state_->done.fetch_add(count, std::memory_order_relaxed);
+}
+
+void ColorPrinter::Dashboard::Row::SetTotal(uint64_t total) {
+    state_->total.store(total, std::memory_order_relaxed);
+}
+
+void ColorPrinter::Dashboard::Row::SetState(PrintColor color, std::string state) {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->color = color;
+    state_->state = std::move(state);
+}
+
+/**
+ * @class ColorPrinter::Dashboard::Impl
+ * @brief 行数据、上一帧的屏幕内容与绘制线程
+ *        绘制后光标总是停在面板下方一行的行首；第 i 行位于其上方 (行数 - i) 行
+ *        有活动的 FooterSink 时各行交给页脚绘制，结束时最终状态写在页脚上方
+ */
+class ColorPrinter::Dashboard::Impl {
+public:
+    explicit Impl(std::chrono::milliseconds frame_interval)
+        : frame_interval_(frame_interval), fd_(color_printer_detail::IndicatorFd()), interactive_(isatty(fd_) != 0),
+          colored_(ColorPrinter::Default().Sink()->WantsColor()) {
+        if (interactive_) {
+            renderer_ = std::thread([this] { Run(); });
+        }
+    }
+
+    ~Impl() {
+        Finish();
+    }
+
+    Row::State* AddRow(std::string label, uint64_t total, PrintColor color) {
+        auto state = std::make_unique<Row::State>();
+        state->label = std::move(label);
+        state->total.store(total, std::memory_order_relaxed);
+        state->color = color;
+        state->rate.Update(0, std::chrono::steady_clock::now());
+        std::lock_guard<std::mutex> lock(rows_mutex_);
+        rows_.push_back(std::move(state));
+        return rows_.back().get();
+    }
+
+    void Finish() {
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex_);
+            if (finished_) {
+                return;
+            }
+            finished_ = true;
+        }
+        stop_cv_.notify_all();
+        if (renderer_.joinable()) {
+            renderer_.join();
+        }
+        if (!interactive_) {
+            PrintFinal(false);
+        } else if (color_printer_detail::ShowLinesInFooter(this, {})) {
+            PrintFinal(true);
+        } else {
+            Render();
+        }
+    }
+
+private:
+    void Run() {
+        std::unique_lock<std::mutex> lock(stop_mutex_);
+        while (!stop_cv_.wait_for(lock, frame_interval_, [this] { return finished_; })) {
+            lock.unlock();
+            Render();
+            lock.lock();
+        }
+    }
+
+    std::vector<Row::State*> SnapshotRows() {
+        std::lock_guard<std::mutex> lock(rows_mutex_);
+        std::vector<Row::State*> rows;
+        rows.reserve(rows_.size());
+        for (const auto& row : rows_) {
+            rows.push_back(row.get());
+        }
+        return rows;
+    }
+
+    /**
+     * @brief 生成一行："名称 │进度条│ 百分比 数量 速率 状态"
+     */
+    Line Layout(Row::State& row, size_t label_width, size_t width, std::chrono::steady_clock::time_point now) {
+        const uint64_t done = row.done.load(std::memory_order_relaxed);
+        const uint64_t total = row.total.load(std::memory_order_relaxed);
+        row.rate.Update(done, now);
+        std::string state;
+        PrintColor color;
+        {
+            std::lock_guard<std::mutex> lock(row.mutex);
+            state = row.state;
+            color = row.color;
+        }
+        const uint8_t row_color = static_cast<uint8_t>(static_cast<int>(color) + 1);
+
+        Line line;
+        line.reserve(std::min<size_t>(width, 256));
+        AppendText(line, row.label, 0, std::min(width, label_width));
+        while (line.size() < label_width && line.size() < width) {
+            line.emplace_back();
+        }
+        std::string text = " ";
+        if (total > 0) {
+            const double fraction = std::min(1.0, static_cast<double>(done) / static_cast<double>(total));
+            color_printer_detail::AppendProgressBar(text, fraction, kBarCells);
+            AppendText(line, text, row_color, width);
+            char percent[16];
+            std::snprintf(percent, sizeof(percent), " %5.1f%%", fraction * 100.0);
+            text = percent;
+            text += "  ";
+            text += color_printer_detail::FormatCount(static_cast<double>(done));
+            text += '/';
+            text += color_printer_detail::FormatCount(static_cast<double>(total));
+        } else {
+            text += color_printer_detail::FormatCount(static_cast<double>(done));
+        }
+        text += "  ";
+        text += color_printer_detail::FormatCount(row.rate.Rate());
+        text += "/s";
+        AppendText(line, text, 0, width);
+        if (!state.empty()) {
+            AppendText(line, "  ", 0, width);
+            AppendText(line, state, row_color, width);
+        }
+        return line;
+    }
+
+    /**
+     * @brief 生成新的一帧并与上一帧比较，只输出变化的部分，整帧一次写出
+     *        有活动的页脚时整帧交给页脚，不直接写出
+     */
+    void Render() {
+        const std::vector<Row::State*> rows = SnapshotRows();
+        const auto now = std::chrono::steady_clock::now();
+        const size_t width = color_printer_detail::TerminalWidth(fd_) - 1;  // 不写最后一列，避免终端自动换行
+        size_t label_width = 0;
+        for (const Row::State* row : rows) {
+            label_width = std::max(label_width, color_printer_detail::DisplayWidth(row->label));
+        }
+        label_width = std::min<size_t>(label_width, kMaxLabelWidth);
+
+        // 面板高于终端时，光标无法回到已滚出屏幕的行：只画最后几行，其余汇总为第一行
+        const size_t height = color_printer_detail::TerminalHeight(fd_);
+        const size_t max_lines = height > 1 ? height - 1 : SIZE_MAX;  // 留出面板下方光标所在的一行
+        size_t first = 0;
+        std::vector<Line> next;
+        if (rows.size() > max_lines) {
+            first = rows.size() - (max_lines - 1);
+            Line summary;
+            AppendText(summary, "… 另有 " + std::to_string(first) + " 行未显示", 0, width);
+            next.push_back(std::move(summary));
+        }
+        next.reserve(next.size() + rows.size() - first);
+        for (size_t i = first; i < rows.size(); i++) {
+            next.push_back(Layout(*rows[i], label_width, width, now));
+        }
+
+        std::vector<std::string> lines;
+        lines.reserve(next.size());
+        for (const Line& line : next) {
+            lines.push_back(LineText(line));
+        }
+        if (color_printer_detail::ShowLinesInFooter(this, std::move(lines))) {
+            screen_.clear();  // 页脚移除后直接绘制时从光标处重新画起
+            return;
+        }
+
+        frame_.clear();
+        pen_color_ = 0;
+        const bool repaint = width != width_;
+        width_ = width;
+        const size_t home = screen_.size();  // 光标所在行（面板下方）
+        size_t cursor_line = home;
+        size_t cursor_column = 0;
+        if (next.size() < screen_.size()) {
+            // 终端变矮、面板行数减少：清除整个面板后重画
+            MoveTo(cursor_line, cursor_column, 0, 0);
+            frame_ += "\033[J";
+            screen_.clear();
+        }
+        for (size_t i = 0; i < screen_.size(); i++) {
+            if (repaint) {
+                MoveTo(cursor_line, cursor_column, i, 0);
+                frame_ += "\033[2K";
+                WriteCells(next[i], 0, next[i].size(), cursor_column);
+                continue;
+            }
+            DiffLine(screen_[i], next[i], i, cursor_line, cursor_column);
+        }
+        // 新增的行写在面板下方，换行时终端自然滚动
+        if (next.size() > screen_.size()) {
+            MoveTo(cursor_line, cursor_column, screen_.size(), 0);
+            for (size_t i = screen_.size(); i < next.size(); i++) {
+                WriteCells(next[i], 0, next[i].size(), cursor_column);
+                SetColor(0);
+                frame_ += "\r\n";
+            }
+            cursor_line = next.size();
+            cursor_column = 0;
+        }
+        SetColor(0);
+        MoveTo(cursor_line, cursor_column, next.size(), 0);
+        screen_ = std::move(next);
+
+        if (!frame_.empty()) {
+            std::cout.flush();  // 保持与调用者自己的 std::cout 输出的先后顺序
+            color_printer_detail::WriteAll(fd_, frame_.data(), frame_.size());
+        }
+    }
+
+    /**
+     * @brief 一行的文字与颜色代码（交给页脚绘制）
+     */
+    std::string LineText(const Line& line) {
+        frame_.clear();
+        pen_color_ = 0;
+        size_t column = 0;
+        WriteCells(line, 0, line.size(), column);
+        SetColor(0);
+        return frame_;
+    }
+
+    /**
+     * @brief 一行不带颜色代码的文字
+     */
+    static std::string PlainText(const Line& line) {
+        std::string text;
+        for (const Cell& cell : line) {
+            text.append(cell.bytes, cell.width == 0 ? 0 : cell.length);
+        }
+        return text;
+    }
+
+    /**
+     * @brief 比较同一行的新旧内容，相距很近的变化合并成一段重写；新内容更短时清除行尾
+     */
+    void DiffLine(const Line& before, const Line& after, size_t row, size_t& cursor_line, size_t& cursor_column) {
+        const size_t length = std::max(before.size(), after.size());
+        size_t column = 0;
+        while (column < length) {
+            if (column < before.size() && column < after.size() && before[column] == after[column]) {
+                column++;
+                continue;
+            }
+            size_t start = column;
+            size_t end = column + 1;
+            size_t same = 0;
+            for (size_t k = end; k < length && same <= kMergeGap; k++) {
+                if (k < before.size() && k < after.size() && before[k] == after[k]) {
+                    same++;
+                } else {
+                    end = k + 1;
+                    same = 0;
+                }
+            }
+            // 不从宽字符的后半格开始，也不在它的前半格结束
+            if (start > 0 && start < after.size() && after[start].width == 0) {
+                start--;
+            }
+            if (end < after.size() && after[end].width == 0) {
+                end++;
+            }
+            if (start < after.size()) {
+                MoveTo(cursor_line, cursor_column, row, start);
+                WriteCells(after, start, std::min(end, after.size()), cursor_column);
+            }
+            if (end > after.size() && before.size() > after.size()) {
+                MoveTo(cursor_line, cursor_column, row, std::max(start, after.size()));
+                SetColor(0);
+                frame_ += "\033[K";
+            }
+            column = end;
+        }
+    }
+
+    void WriteCells(const Line& line, size_t begin, size_t end, size_t& cursor_column) {
+        for (size_t i = begin; i < end; i++) {
+            const Cell& cell = line[i];
+            if (cell.width == 0) {
+                continue;  // 宽字符的后半格已随前半格写出
+            }
+            SetColor(cell.color);
+            frame_.append(cell.bytes, cell.length);
+        }
+        cursor_column = end;
+    }
+
+    void SetColor(uint8_t color) {
+        if (!colored_ || color == pen_color_) {
+            return;
+        }
+        frame_ += color == 0 ? std::string("\033[0m") : GetColorCode(static_cast<PrintColor>(color - 1));
+        pen_color_ = color;
+    }
+
+    /**
+     * @brief 用相对的上下移动和绝对列号把光标从 (line, column) 移到 (target_line, target_column)
+     */
+    void MoveTo(size_t& line, size_t& column, size_t target_line, size_t target_column) {
+        char move[32];
+        if (target_line < line) {
+            std::snprintf(move, sizeof(move), "\033[%zuA", line - target_line);
+            frame_ += move;
+        } else if (target_line > line) {
+            std::snprintf(move, sizeof(move), "\033[%zuB", target_line - line);
+            frame_ += move;
+        }
+        if (target_column != column || target_line != line) {
+            if (target_column == 0) {
+                frame_ += '\r';
+            } else {
+                std::snprintf(move, sizeof(move), "\033[%zuG", target_column + 1);
+                frame_ += move;
+            }
+        }
+        line = target_line;
+        column = target_column;
+    }
+
+    /**
+     * @brief 输出端不是终端或面板画在页脚中时：每行输出一次最终状态
+     *
+     * @param above_footer 为true时逐行写在页脚上方，按行的颜色着色
+     */
+    void PrintFinal(bool above_footer) {
+        const std::vector<Row::State*> rows = SnapshotRows();
+        const auto now = std::chrono::steady_clock::now();
+        size_t label_width = 0;
+        for (const Row::State* row : rows) {
+            label_width = std::max(label_width, color_printer_detail::DisplayWidth(row->label));
+        }
+        label_width = std::min<size_t>(label_width, kMaxLabelWidth);
+        frame_.clear();
+        pen_color_ = 0;
+        for (Row::State* row : rows) {
+            const Line line = Layout(*row, label_width, SIZE_MAX, now);
+            if (above_footer) {
+                PrintColor color;
+                {
+                    std::lock_guard<std::mutex> lock(row->mutex);
+                    color = row->color;
+                }
+                if (color_printer_detail::WriteAboveFooter(color, PlainText(line))) {
+                    continue;
+                }
+            }
+            size_t column = 0;
+            WriteCells(line, 0, line.size(), column);
+            SetColor(0);
+            frame_ += '\n';
+        }
+        if (frame_.empty()) {
+            return;
+        }
+        std::cout.flush();
+        color_printer_detail::WriteAll(fd_, frame_.data(), frame_.size());
+    }
+
+    const std::chrono::milliseconds frame_interval_;
+    const int fd_;
+    const bool interactive_;
+    const bool colored_;
+
+    std::mutex rows_mutex_;
+    std::deque<std::unique_ptr<Row::State>> rows_;
+
+    // 以下只由绘制线程访问（Finish 在绘制线程结束后才访问）
+    std::vector<Line> screen_;
+    size_t width_ = 0;
+    std::string frame_;
+    uint8_t pen_color_ = 0;
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool finished_ = false;
+    std::thread renderer_;
+};
+
+ColorPrinter::Dashboard::Dashboard(std::chrono::milliseconds frame_interval)
+    : impl_(std::make_unique<Impl>(frame_interval)) {
+}
+
+ColorPrinter::Dashboard::~Dashboard() = default;
+
+ColorPrinter::Dashboard::Row ColorPrinter::Dashboard::AddRow(std::string label, uint64_t total, PrintColor color) {
+    return Row(impl_->AddRow(std::move(label), total, color));
+}
+
+void ColorPrinter::Dashboard::Finish() {
+    impl_->Finish();
+}
@@ -0,0 +1,105 @@
+/**
+ * @file color_printer_fanout_sink.cpp
+ * @brief 分发输出端的实现
+ */
+
+#include "color_printer_fanout_sink.h"
+
+void FanOutSink::Add(std::shared_ptr<LogSink> sink, LogLevel min_level) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const bool colored = sink->WantsColor();
+    targets_.push_back({std::move(sink), min_level, colored});
+    if (colored) {
+        any_colored_.store(true, std::memory_order_relaxed);
+    }
+}
+
+void FanOutSink::Write(const LogRecord* records, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const LogRecord* plain = nullptr;  // 第一个不带颜色的输出端需要时才生成
+    for (const Target& target : targets_) {
+        const LogRecord* source = records;
+        if (!target.colored) {
+            if (plain == nullptr) {
+                plain = PlainRecords(records, count);
+            }
+            source = plain;
+        }
+        if (target.min_level == LogLevel::DEBUG) {
+            target.sink->Write(source, count);
+            continue;
+        }
+        filtered_.clear();
+        for (size_t i = 0; i < count; i++) {
+            if (source[i].level >= target.min_level) {
+                filtered_.push_back(source[i]);
+            }
+        }
+        if (!filtered_.empty()) {
+            target.sink->Write(filtered_.data(), filtered_.size());
+        }
+    }
+}
+
+bool FanOutSink::WritesToFd(int fd) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Target& target : targets_) {
+        if (target.sink->WritesToFd(fd)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<LogSink> FanOutSink::RebindFd(int from_fd, int to_fd) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto rebound = std::make_shared<FanOutSink>();
+    for (const Target& target : targets_) {
+        std::shared_ptr<LogSink> sink = target.sink;
+        if (sink->WritesToFd(from_fd)) {
+            sink = sink->RebindFd(from_fd, to_fd);
+            if (!sink) {
+                return nullptr;
+            }
+        }
+        rebound->Add(std::move(sink), target.min_level);
+    }
+    return rebound;
+}
+
+void FanOutSink::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const Target& target : targets_) {
+        target.sink->Flush();
+    }
+}
+
+/**
+ * @brief 生成去掉颜色代码的记录
+ *        整批都不带颜色时直接返回原记录；否则把各行跳过颜色代码的部分拼接到一个缓冲区，
+ *        类型与正文的视图仍指向原始字节
+ */
+const LogRecord* FanOutSink::PlainRecords(const LogRecord* records, size_t count) {
+    size_t total = 0;
+    bool colored = false;
+    for (size_t i = 0; i < count; i++) {
+        total += records[i].line.size() - records[i].escape_head - records[i].escape_tail;
+        colored = colored || records[i].escape_head != 0 || records[i].escape_tail != 0;
+    }
+    if (!colored) {
+        return records;
+    }
+
+    plain_bytes_.clear();
+    plain_bytes_.reserve(total);  // 一次分配，之后的视图不会失效
+    plain_records_.assign(records, records + count);
+    for (LogRecord& record : plain_records_) {
+        const size_t start = plain_bytes_.size();
+        plain_bytes_.append(record.Plain());
+        plain_bytes_.push_back('\n');
+        record.line = std::string_view(plain_bytes_.data() + start, plain_bytes_.size() - start);
+        record.escape_head = 0;
+        record.escape_tail = 0;
+    }
+    return plain_records_.data();
+}
@@ -0,0 +1,410 @@
+/**
+ * @file color_printer_file_sink.cpp
+ * @brief 轮转文件输出端的实现
+ */
+
+#include "color_printer_file_sink.h"
+#include "color_printer_internal.h"
+#include "color_printer_uring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr unsigned kUringEntries = 64;
+constexpr size_t kMaxRequestBytes = size_t(1) << 30;
+
+/**
+ * @brief 在指定偏移处完整写入，用于 io_uring 短写或请求失败后的补写
+ */
+void PwriteAll(int fd, const char* data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        const ssize_t written = ::pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+}
+
+} // namespace
+
+RotatingFileSink::RotatingFileSink(RotatingFileOptions options)
+    : options_(std::move(options)) {
+    if (options_.io_uring) {
+        SetUpUring();
+    }
+    if (spare_.empty()) {
+        active_.reserve(options_.buffer_bytes);
+    } else {
+        active_ = std::move(spare_.back());
+        spare_.pop_back();
+    }
+    writer_ = std::thread(&RotatingFileSink::WriterLoop, this);
+}
+
+RotatingFileSink::~RotatingFileSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SubmitActiveLocked();
+        stop_ = true;
+    }
+    writer_cv_.notify_one();
+    writer_.join();
+}
+
+/**
+ * @brief 把一批行拷贝进当前缓冲区，写满时交给写线程
+ */
+void RotatingFileSink::Write(const LogRecord* records, size_t count) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < count; i++) {
+        const std::string_view line = records[i].line;
+        if (!active_.empty() && active_.size() + line.size() > active_.capacity()) {
+            HandOffActiveLocked(lock);  // 不让缓冲区扩容，保持（注册过的）地址不变
+        }
+        active_.append(line);
+        if (active_.size() >= options_.buffer_bytes) {
+            HandOffActiveLocked(lock);
+        }
+    }
+}
+
+/**
+ * @brief 把当前缓冲区交给写线程，积压达到上限时等待
+ */
+void RotatingFileSink::HandOffActiveLocked(std::unique_lock<std::mutex>& lock) {
+    done_cv_.wait(lock, [this] { return full_.size() < options_.max_buffers; });
+    SubmitActiveLocked();
+    writer_cv_.notify_one();
+}
+
+void RotatingFileSink::Flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    SubmitActiveLocked();
+    const uint64_t target = submitted_;
+    writer_cv_.notify_one();
+    done_cv_.wait(lock, [this, target] { return written_ >= target; });
+}
+
+void RotatingFileSink::SubmitActiveLocked() {
+    if (active_.empty()) {
+        return;
+    }
+    full_.push_back(std::move(active_));
+    submitted_++;
+    if (spare_.empty()) {
+        active_ = std::string();
+        active_.reserve(options_.buffer_bytes);
+    } else {
+        active_ = std::move(spare_.back());
+        spare_.pop_back();
+    }
+}
+
+void RotatingFileSink::WriterLoop() {
+    OpenFile();
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto next_flush = std::chrono::steady_clock::now() + options_.flush_interval;
+    while (true) {
+        auto deadline = next_flush;
+        if (options_.rotate_interval.count() > 0) {
+            deadline = std::min(deadline, opened_at_ + options_.rotate_interval);
+        }
+        if (uring_ != nullptr && !in_flight_.empty() && full_.empty() && !stop_) {
+            // 没有新缓冲区时在锁外等待已提交的写请求完成
+            lock.unlock();
+            ReapCompletions(1);
+            lock.lock();
+            RetireCompletedLocked();
+            continue;
+        }
+        writer_cv_.wait_until(lock, deadline, [this] { return stop_ || !full_.empty(); });
+
+        const auto now = std::chrono::steady_clock::now();
+        if (full_.empty() && now >= next_flush) {
+            SubmitActiveLocked();
+            next_flush = now + options_.flush_interval;
+        }
+        if (full_.empty()) {
+            if (stop_) {
+                break;
+            }
+            if (options_.rotate_interval.count() > 0 && now >= opened_at_ + options_.rotate_interval) {
+                lock.unlock();
+                if (file_bytes_ > 0) {
+                    Rotate();
+                } else {
+                    opened_at_ = now;
+                }
+                lock.lock();
+            }
+            continue;
+        }
+
+        std::string buffer = std::move(full_.front());
+        full_.pop_front();
+        lock.unlock();
+        if (uring_ != nullptr) {
+            // 缓冲区在写请求全部完成前留在 in_flight_ 中，完成后按提交顺序归还
+            while (in_flight_.size() >= std::max<size_t>(options_.max_buffers, 1)) {
+                ReapCompletions(1);
+                lock.lock();
+                RetireCompletedLocked();
+                lock.unlock();
+            }
+            current_buffer_index_ = -1;
+            for (size_t index = 0; index < registered_.size(); index++) {
+                if (registered_[index].first == buffer.data() && registered_[index].second == buffer.capacity()) {
+                    current_buffer_index_ = static_cast<int>(index);
+                    break;
+                }
+            }
+            in_flight_.push_back(InFlightBuffer{std::move(buffer), 0});
+            WriteBuffer(in_flight_.back().data);
+            SubmitChain();
+            ReapCompletions(0);
+            lock.lock();
+            RetireCompletedLocked();
+            continue;
+        }
+        WriteBuffer(buffer);
+        buffer.clear();
+        lock.lock();
+        spare_.push_back(std::move(buffer));
+        written_++;
+        done_cv_.notify_all();
+    }
+    lock.unlock();
+    if (uring_ != nullptr) {
+        DrainInFlight();
+    }
+    CloseFile();
+}
+
+/**
+ * @brief 写出一个缓冲区，必要时在行边界处轮转
+ */
+void RotatingFileSink::WriteBuffer(const std::string& buffer) {
+    if (options_.rotate_interval.count() > 0 && file_bytes_ > 0 &&
+        std::chrono::steady_clock::now() >= opened_at_ + options_.rotate_interval) {
+        Rotate();
+    }
+
+    size_t offset = 0;
+    while (offset < buffer.size()) {
+        size_t chunk = buffer.size() - offset;
+        if (options_.max_file_bytes > 0) {
+            if (file_bytes_ >= options_.max_file_bytes) {
+                Rotate();
+            }
+            const size_t room = options_.max_file_bytes - file_bytes_;
+            if (chunk > room) {
+                // 在不超过上限的最后一个换行处切分；单行超过上限时整行写入
+                const size_t cut = buffer.rfind('\n', offset + room - 1);
+                if (cut != std::string::npos && cut >= offset) {
+                    chunk = cut + 1 - offset;
+                } else if (file_bytes_ > 0) {
+                    Rotate();
+                    continue;
+                } else {
+                    const size_t line_end = buffer.find('\n', offset);
+                    chunk = (line_end == std::string::npos ? buffer.size() : line_end + 1) - offset;
+                }
+            }
+        }
+        WriteChunk(buffer.data() + offset, chunk);
+        offset += chunk;
+    }
+}
+
+void RotatingFileSink::WriteChunk(const char* data, size_t length) {
+    if (fd_ < 0) {
+        OpenFile();
+        if (fd_ < 0) {
+            return;  // 无法打开文件，丢弃
+        }
+    }
+    if (uring_ != nullptr) {
+        // 异步请求之间不保证完成顺序，用显式偏移代替 O_APPEND
+        const uint64_t buffer_seq = retired_seq_ + in_flight_.size() - 1;
+        while (length > 0) {
+            const size_t piece = std::min(length, kMaxRequestBytes);
+            chain_.push_back(PendingWrite{buffer_seq, data, piece, file_bytes_});
+            data += piece;
+            length -= piece;
+            file_bytes_ += piece;
+        }
+        return;
+    }
+    color_printer_detail::WriteAll(fd_, data, length);
+    file_bytes_ += length;
+}
+
+void RotatingFileSink::OpenFile() {
+    const int append = uring_ != nullptr ? 0 : O_APPEND;
+    fd_ = ::open(options_.path.c_str(), O_WRONLY | O_CREAT | append | O_CLOEXEC, 0644);
+    opened_at_ = std::chrono::steady_clock::now();
+    file_bytes_ = 0;
+    if (fd_ < 0) {
+        return;
+    }
+    struct stat info;
+    if (::fstat(fd_, &info) == 0) {
+        file_bytes_ = static_cast<size_t>(info.st_size);
+    }
+    if (options_.preallocate && options_.max_file_bytes > file_bytes_) {
+        // 只分配块不改变文件大小，读者不会看到尾部的空洞；关闭时截掉未用的部分
+        ::fallocate(fd_, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(file_bytes_),
+                    static_cast<off_t>(options_.max_file_bytes - file_bytes_));
+    }
+}
+
+void RotatingFileSink::CloseFile() {
+    if (fd_ < 0) {
+        return;
+    }
+    if (options_.preallocate && options_.max_file_bytes > 0) {
+        (void)::ftruncate(fd_, static_cast<off_t>(file_bytes_));
+    }
+    ::close(fd_);
+    fd_ = -1;
+}
+
+/**
+ * @brief 关闭当前文件，依次重命名历史文件（超出保留个数的被覆盖），再打开新文件
+ */
+void RotatingFileSink::Rotate() {
+    if (uring_ != nullptr) {
+        SubmitChain();
+        DrainInFlight();
+    }
+    CloseFile();
+    const std::string& path = options_.path;
+    if (options_.max_files == 0) {
+        ::unlink(path.c_str());
+    } else {
+        for (size_t index = options_.max_files - 1; index >= 1; index--) {
+            const std::string from = path + "." + std::to_string(index);
+            const std::string to = path + "." + std::to_string(index + 1);
+            std::rename(from.c_str(), to.c_str());
+        }
+        std::rename(path.c_str(), (path + ".1").c_str());
+    }
+    OpenFile();
+    if (options_.on_rotated && options_.max_files > 0) {
+        options_.on_rotated(path + ".1");
+    }
+}
+
+/**
+ * @brief 创建 io_uring 并预先分配、注册缓冲区池
+ *        池的大小覆盖 当前缓冲区 + 积压的缓冲区 + 正在写的缓冲区
+ */
+void RotatingFileSink::SetUpUring() {
+    const size_t pool = options_.max_buffers * 2 + 2;
+    std::vector<iovec> buffers;
+    buffers.reserve(pool);
+    for (size_t i = 0; i < pool; i++) {
+        std::string buffer;
+        buffer.reserve(options_.buffer_bytes);
+        buffers.push_back(iovec{buffer.data(), buffer.capacity()});
+        registered_.emplace_back(buffer.data(), buffer.capacity());
+        spare_.push_back(std::move(buffer));  // 移动不改变堆上数据的地址
+    }
+    uring_ = color_printer_detail::UringWriter::Create(kUringEntries, buffers);
+    if (uring_ == nullptr) {
+        registered_.clear();
+        spare_.clear();
+    } else if (!uring_->HasFixedBuffers()) {
+        registered_.clear();
+    }
+}
+
+/**
+ * @brief 把当前缓冲区累积的写请求作为一条链提交（链内按顺序执行）
+ */
+void RotatingFileSink::SubmitChain() {
+    for (size_t i = 0; i < chain_.size(); i++) {
+        const PendingWrite& write = chain_[i];
+        while (uring_->InFlight() >= kUringEntries) {
+            uring_->Submit();
+            ReapCompletions(1);
+        }
+        uint64_t tag;
+        if (free_tags_.empty()) {
+            tag = pending_writes_.size();
+            pending_writes_.push_back(write);
+        } else {
+            tag = free_tags_.back();
+            free_tags_.pop_back();
+            pending_writes_[tag] = write;
+        }
+        const bool link = i + 1 < chain_.size();
+        if (uring_->QueueWrite(fd_, write.data, static_cast<uint32_t>(write.length), write.offset,
+                               current_buffer_index_, tag, link)) {
+            in_flight_[write.buffer_seq - retired_seq_].pending++;
+        } else {
+            free_tags_.push_back(tag);
+            PwriteAll(fd_, write.data, write.length, write.offset);
+        }
+    }
+    chain_.clear();
+    uring_->Submit();
+}
+
+/**
+ * @brief 收割完成事件；短写、被取消（链内前一个请求失败）或出错的请求用 pwrite 补写
+ *
+ * @param wait_min 至少等待的事件个数，没有未完成的请求时不等待
+ */
+void RotatingFileSink::ReapCompletions(unsigned wait_min) {
+    if (uring_->InFlight() == 0) {
+        return;
+    }
+    uring_->Reap(wait_min, [this](uint64_t tag, int result) {
+        const PendingWrite write = pending_writes_[tag];
+        free_tags_.push_back(tag);
+        const size_t done = result > 0 ? static_cast<size_t>(result) : 0;
+        if (done < write.length) {
+            PwriteAll(fd_, write.data + done, write.length - done, write.offset + done);
+        }
+        in_flight_[write.buffer_seq - retired_seq_].pending--;
+    });
+}
+
+void RotatingFileSink::DrainInFlight() {
+    while (uring_->InFlight() > 0) {
+        ReapCompletions(1);
+    }
+}
+
+/**
+ * @brief 按提交顺序归还已全部写完的缓冲区，保证 written_ 只统计连续完成的前缀
+ */
+void RotatingFileSink::RetireCompletedLocked() {
+    bool retired = false;
+    while (!in_flight_.empty() && in_flight_.front().pending == 0) {
+        std::string buffer = std::move(in_flight_.front().data);
+        in_flight_.pop_front();
+        retired_seq_++;
+        buffer.clear();
+        spare_.push_back(std::move(buffer));
+        written_++;
+        retired = true;
+    }
+    if (retired) {
+        done_cv_.notify_all();
+    }
+}
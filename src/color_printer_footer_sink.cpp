@@ -0,0 +1,311 @@
+/**
+ * @file color_printer_footer_sink.cpp
+ * @brief 状态页脚输出端的实现
+ */
+
+#include "color_printer_footer_sink.h"
+#include "color_printer.h"
+#include "color_printer_internal.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief 追加 text 中显示宽度不超过 width 列的前缀；颜色等控制序列整段保留，不占宽度
+ */
+void AppendForWidth(std::string& out, std::string_view text, size_t width) {
+    while (!text.empty()) {
+        if (text.front() == '\033') {
+            size_t end = 1;
+            if (end < text.size() && text[end] == '[') {
+                end++;
+                while (end < text.size() && !(text[end] >= 0x40 && text[end] <= 0x7E)) {
+                    end++;
+                }
+                end = std::min(end + 1, text.size());
+            }
+            out.append(text.substr(0, end));
+            text.remove_prefix(end);
+            continue;
+        }
+        const std::string_view segment = text.substr(0, text.find('\033'));
+        const size_t bytes = color_printer_detail::PrefixForWidth(segment, width);
+        out.append(segment.substr(0, bytes));
+        if (bytes < segment.size()) {
+            return;  // 已到宽度：之后只剩被截掉的文字
+        }
+        width -= color_printer_detail::DisplayWidth(segment);
+        text.remove_prefix(segment.size());
+    }
+}
+
+/**
+ * @brief 当前接管静默状态指示器的页脚（同一时刻只有一个，先创建者优先）
+ */
+std::mutex g_footer_mutex;
+FooterSink* g_active_footer = nullptr;
+
+} // namespace
+
+namespace color_printer_detail {
+
+bool ShowIndicatorInFooter(PrintColor color, int dots) {
+    std::lock_guard<std::mutex> lock(g_footer_mutex);
+    if (g_active_footer == nullptr) {
+        return false;
+    }
+    g_active_footer->SetIndicator(color, "[INFO] " + std::string(static_cast<size_t>(dots), '.'));
+    return true;
+}
+
+bool ShowLinesInFooter(const void* owner, std::vector<std::string> lines) {
+    std::lock_guard<std::mutex> lock(g_footer_mutex);
+    if (g_active_footer == nullptr) {
+        return false;
+    }
+    g_active_footer->SetOwnedLines(owner, std::move(lines));
+    return true;
+}
+
+bool WriteAboveFooter(PrintColor color, std::string_view text) {
+    std::lock_guard<std::mutex> lock(g_footer_mutex);
+    if (g_active_footer == nullptr) {
+        return false;
+    }
+    g_active_footer->WriteAbove(color, text);
+    return true;
+}
+
+} // namespace color_printer_detail
+
+FooterSink::FooterSink(int fd, bool colored, std::chrono::milliseconds frame_interval)
+    : fd_(fd), colored_(colored), interactive_(isatty(fd) != 0), frame_interval_(frame_interval) {
+    if (!interactive_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_footer_mutex);
+        if (g_active_footer == nullptr) {
+            g_active_footer = this;
+        }
+    }
+    renderer_ = std::thread([this] { Run(); });
+}
+
+FooterSink::~FooterSink() {
+    if (!interactive_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(g_footer_mutex);
+        if (g_active_footer == this) {
+            g_active_footer = nullptr;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    renderer_.join();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_.clear();
+    EraseLocked();
+    color_printer_detail::WriteAll(fd_, frame_.data(), frame_.size());
+}
+
+/**
+ * @brief 写出一批消息：清除页脚、写出消息、补回页脚，一次写出
+ *        页脚有未画出的变化且到了下一帧时顺带重绘，否则原样补回上次画出的页脚，
+ *        变化留给后台线程在下一帧重绘；静默状态指示器随本批消息结束，立即重绘去掉它
+ */
+void FooterSink::Write(const LogRecord* records, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (fd_ == STDOUT_FILENO) {
+        std::cout.flush();  // 保持与调用者自己的 std::cout 输出的先后顺序
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_.clear();
+    EraseLocked();
+    color_printer_detail::AppendLinesMinimalEscapes(frame_, records, count);
+    const auto now = std::chrono::steady_clock::now();
+    const bool indicator_shown = !indicator_.text.empty();
+    indicator_.text.clear();  // 与直接绘制时一样，指示器在下一批消息之后结束
+    if (indicator_shown || lines_removed_ || (dirty_ && now - drawn_at_ >= frame_interval_)) {
+        DrawLocked(now);
+        dirty_ = false;
+    } else {
+        AppendDrawnLocked();
+    }
+    color_printer_detail::WriteAll(fd_, frame_.data(), frame_.size());
+}
+
+void FooterSink::SetLine(size_t index, PrintColor color, std::string text) {
+    if (!interactive_) {
+        return;
+    }
+    const size_t newline = text.find('\n');
+    if (newline != std::string::npos) {
+        text.resize(newline);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index >= lines_.size()) {
+        lines_.resize(index + 1);
+    }
+    lines_[index].color = color;
+    lines_[index].text = std::move(text);
+    MarkDirtyLocked();
+}
+
+void FooterSink::SetLineCount(size_t count) {
+    if (!interactive_) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    lines_.resize(count);
+    MarkDirtyLocked();
+}
+
+void FooterSink::SetIndicator(PrintColor color, std::string_view text) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    indicator_.color = color;
+    indicator_.text.assign(text);
+    MarkDirtyLocked();
+}
+
+void FooterSink::MarkDirtyLocked() {
+    if (!dirty_) {
+        dirty_ = true;
+        cv_.notify_one();
+    }
+}
+
+/**
+ * @brief 后台线程：页脚有变化时，等到距上次重绘满一帧再重绘
+ */
+void FooterSink::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (!dirty_) {
+            cv_.wait(lock);
+            continue;
+        }
+        const auto due = drawn_at_ + frame_interval_;
+        if (std::chrono::steady_clock::now() < due) {
+            cv_.wait_until(lock, due);
+            continue;
+        }
+        frame_.clear();
+        EraseLocked();
+        DrawLocked(std::chrono::steady_clock::now());
+        dirty_ = false;
+        color_printer_detail::WriteAll(fd_, frame_.data(), frame_.size());
+    }
+}
+
+/**
+ * @brief 追加清除页脚的控制序列：回到页脚第一行的行首，清除到屏幕末尾
+ */
+void FooterSink::EraseLocked() {
+    if (drawn_lines_ == 0) {
+        return;
+    }
+    frame_ += '\r';
+    if (drawn_lines_ > 1) {
+        char up[24];
+        std::snprintf(up, sizeof(up), "\033[%zuA", drawn_lines_ - 1);
+        frame_ += up;
+    }
+    frame_ += "\033[J";
+    drawn_lines_ = 0;
+}
+
+void FooterSink::SetOwnedLines(const void* owner, std::vector<std::string> lines) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(owned_lines_.begin(), owned_lines_.end(),
+                           [owner](const auto& entry) { return entry.first == owner; });
+    if (lines.empty()) {
+        if (it == owned_lines_.end()) {
+            return;
+        }
+        owned_lines_.erase(it);
+        lines_removed_ = true;
+    } else if (it == owned_lines_.end()) {
+        owned_lines_.emplace_back(owner, std::move(lines));
+    } else {
+        it->second = std::move(lines);
+    }
+    MarkDirtyLocked();
+}
+
+void FooterSink::WriteAbove(PrintColor color, std::string_view text) {
+    std::string line;
+    LogRecord record{color, LogLevel::INFO, {}, {}, {}};
+    if (colored_) {
+        line = ColorPrinter::GetColorCode(color);
+        record.escape_head = static_cast<uint32_t>(line.size());
+    }
+    line.append(text);
+    if (colored_) {
+        line += "\033[0m";
+        record.escape_tail = 4;
+    }
+    line += '\n';
+    record.message = text;
+    record.line = line;
+    Write(&record, 1);
+}
+
+/**
+ * @brief 在光标处追加页脚各行（最后一行后不换行，光标停在行尾），并缓存画出的内容
+ *        每行截断到终端宽度减一，避免自动换行打乱行数
+ */
+void FooterSink::DrawLocked(std::chrono::steady_clock::time_point now) {
+    const size_t width = color_printer_detail::TerminalWidth(fd_) - 1;
+    lines_removed_ = false;
+    drawn_.clear();
+    drawn_line_count_ = 0;
+    auto append = [&](const Line& line) {
+        if (drawn_line_count_ > 0) {
+            drawn_ += '\n';
+        }
+        drawn_ += ColorPrinter::GetColorCode(line.color);
+        drawn_.append(line.text, 0, color_printer_detail::PrefixForWidth(line.text, width));
+        drawn_ += "\033[0m";
+        drawn_line_count_++;
+    };
+    for (const Line& line : lines_) {
+        append(line);
+    }
+    for (const auto& [owner, lines] : owned_lines_) {
+        for (const std::string& text : lines) {
+            if (drawn_line_count_ > 0) {
+                drawn_ += '\n';
+            }
+            AppendForWidth(drawn_, text, width);
+            drawn_ += "\033[0m";
+            drawn_line_count_++;
+        }
+    }
+    if (!indicator_.text.empty()) {
+        append(indicator_);
+    }
+    drawn_at_ = now;
+    AppendDrawnLocked();
+}
+
+/**
+ * @brief 在光标处追加上次画出的页脚
+ */
+void FooterSink::AppendDrawnLocked() {
+    frame_ += drawn_;
+    drawn_lines_ = drawn_line_count_;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file color_printer_internal.h
+ * @brief 库内部共享的工具函数（不安装）
+ */
+
+#ifndef COLOR_PRINTER_INTERNAL_H
+#define COLOR_PRINTER_INTERNAL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+struct iovec;
+struct LogRecord;
+
+namespace color_printer_detail {
+
+/**
+ * @brief 将缓冲区完整写入fd，处理EINTR与部分写入
+ *
+ * @return 全部写出返回true，fd出错时返回false（剩余内容被丢弃）
+ */
+bool WriteAll(int fd, const char* data, size_t length);
+
+/**
+ * @brief 将多段缓冲区通过 writev 完整写入fd，处理EINTR与部分写入
+ *        会修改 segments 中的内容
+ *
+ * @return 全部写出返回true，fd出错时返回false
+ */
+bool WriteVAll(int fd, iovec* segments, int count);
+
+/**
+ * @brief 把一批行追加到 out，并省去多余的颜色代码
+ *        相邻两行的颜色代码相同（且前一行正文中没有其他转义序列）时，
+ *        去掉前一行的重置代码和后一行的颜色代码；批末的行总带重置代码，输出结束时终端状态是干净的
+ *
+ * @return 省去的字节数
+ */
+size_t AppendLinesMinimalEscapes(std::string& out, const LogRecord* records, size_t count);
+
+/**
+ * @brief 数量的简短表示，保留三位有效数字，例如 12345 -> "12.3k"
+ */
+std::string FormatCount(double value);
+
+/**
+ * @brief 时长 "MM:SS" 或 "H:MM:SS"，无法估计时为 "--:--"
+ */
+std::string FormatDuration(double seconds);
+
+/**
+ * @brief 追加宽 cells 格的进度条（两侧带竖线，Unicode 方块字符精确到 1/8 格）
+ */
+void AppendProgressBar(std::string& out, double fraction, int cells);
+
+/**
+ * @class RateMeter
+ * @brief 指数加权平均的速率（每秒完成的数量）
+ */
+class RateMeter {
+public:
+    /**
+     * @brief 以当前累计数量更新速率
+     */
+    void Update(uint64_t done, std::chrono::steady_clock::time_point now);
+
+    double Rate() const { return rate_; }
+
+private:
+    std::chrono::steady_clock::time_point last_tick_;
+    uint64_t last_done_ = 0;
+    double rate_ = 0;
+    bool started_ = false;
+};
+
+/**
+ * @brief 是否为占两列的东亚宽字符（CJK、全角符号等）
+ */
+bool IsWideCodepoint(uint32_t codepoint);
+
+/**
+ * @brief UTF-8 文本在终端上显示不超过 max_width 列的最长前缀的字节数
+ */
+size_t PrefixForWidth(std::string_view text, size_t max_width);
+
+/**
+ * @brief UTF-8 文本在终端上的显示宽度（列数）
+ */
+size_t DisplayWidth(std::string_view text);
+
+/**
+ * @brief 指示器、进度条与面板写入的描述符：默认打印器的输出端是 FdSink 或 FooterSink 时与它相同
+ *        （OutputCapture 捕获期间即原来的终端，不会被捕获回管道），否则为标准输出
+ */
+int IndicatorFd();
+
+/**
+ * @brief fd 所在终端的列数，无法获取时为80
+ */
+size_t TerminalWidth(int fd);
+
+/**
+ * @brief fd 所在终端的行数，无法获取时为0（不限制）
+ */
+size_t TerminalHeight(int fd);
+
+/**
+ * @class ConfigFileWatcher
+ * @brief 用 inotify 监视配置文件所在目录，文件被写入、替换或重命名到该路径时回调
+ *        监视目录而不是文件本身，以便覆盖编辑器“写临时文件再重命名”的保存方式
+ */
+class ConfigFileWatcher {
+public:
+    /**
+     * @param path 配置文件路径
+     * @param on_change 回调，参数为文件的完整内容；在监视线程上调用
+     */
+    ConfigFileWatcher(std::string path, std::function<void(const std::string&)> on_change);
+
+    /**
+     * @brief 停止监视线程
+     */
+    ~ConfigFileWatcher();
+
+    ConfigFileWatcher(const ConfigFileWatcher&) = delete;
+    ConfigFileWatcher& operator=(const ConfigFileWatcher&) = delete;
+
+    /**
+     * @brief 立即加载一次并启动监视线程
+     *
+     * @return 文件可读且 inotify 可用时返回true
+     */
+    bool Start();
+
+private:
+    void Run();
+    void Reload();
+
+    std::string path_;
+    std::string directory_;
+    std::string file_name_;
+    std::function<void(const std::string&)> on_change_;
+    int inotify_fd_ = -1;
+    int stop_fd_ = -1;
+    std::thread thread_;
+};
+
+} // namespace color_printer_detail
+
+#endif // COLOR_PRINTER_INTERNAL_H
@@ -0,0 +1,259 @@
+/**
+ * @file color_printer_journal_sink.cpp
+ * @brief 系统日志输出端的实现
+ */
+
+#include "color_printer_journal_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr const char* kJournalSocket = "/run/systemd/journal/socket";
+constexpr const char* kSyslogSocket = "/dev/log";
+constexpr size_t kMaxBatch = 256;  // 单次 sendmmsg 的报文数
+
+constexpr std::string_view kColorNames[] = {"RED", "GREEN", "YELLOW", "BLUE", "MAGENTA", "CYAN", "WHITE"};
+
+/**
+ * @brief 追加一个 journald 字段；值含换行时使用 "名称\n<64位小端长度><值>\n" 的二进制形式
+ */
+void AppendField(std::string& out, std::string_view name, std::string_view value) {
+    out.append(name);
+    if (value.find('\n') == std::string_view::npos) {
+        out.push_back('=');
+        out.append(value);
+    } else {
+        out.push_back('\n');
+        uint64_t length = value.size();
+        for (int i = 0; i < 8; i++) {
+            out.push_back(static_cast<char>(length & 0xff));
+            length >>= 8;
+        }
+        out.append(value);
+    }
+    out.push_back('\n');
+}
+
+} // namespace
+
+JournalSink::JournalSink(JournalOptions options)
+    : options_(std::move(options)), identifier_(options_.identifier), active_protocol_(options_.protocol) {
+    if (identifier_.empty()) {
+        identifier_ = program_invocation_short_name;
+    }
+    Connect();
+}
+
+JournalSink::~JournalSink() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+int JournalSink::PriorityForLevel(LogLevel level) {
+    switch (level) {
+    case LogLevel::DEBUG:
+        return 7;  // LOG_DEBUG
+    case LogLevel::INFO:
+        return 6;  // LOG_INFO
+    case LogLevel::OK:
+        return 5;  // LOG_NOTICE
+    case LogLevel::WARNING:
+        return 4;  // LOG_WARNING
+    case LogLevel::ERROR:
+        return 3;  // LOG_ERR
+    case LogLevel::FATAL:
+        return 2;  // LOG_CRIT
+    }
+    return 6;
+}
+
+/**
+ * @brief (重新)连接守护进程的套接字；JOURNALD 连不上时按配置回退到 syslog
+ */
+bool JournalSink::Connect() {
+    std::string path = options_.socket_path;
+    if (path.empty()) {
+        path = options_.protocol == JournalProtocol::JOURNALD ? kJournalSocket : kSyslogSocket;
+    }
+    if (ConnectTo(path)) {
+        active_protocol_.store(options_.protocol, std::memory_order_relaxed);
+        return true;
+    }
+    if (options_.protocol != JournalProtocol::JOURNALD || !options_.syslog_fallback) {
+        return false;
+    }
+    if (ConnectTo(options_.syslog_socket_path.empty() ? kSyslogSocket : options_.syslog_socket_path)) {
+        active_protocol_.store(JournalProtocol::SYSLOG, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool JournalSink::ConnectTo(const std::string& path) {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        return false;
+    }
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.data(), path.size());
+    timeval timeout;
+    timeout.tv_sec = static_cast<time_t>(options_.send_timeout.count() / 1000);
+    timeout.tv_usec = static_cast<suseconds_t>(options_.send_timeout.count() % 1000 * 1000);
+    ::setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 按当前协议把一批消息编码为首尾相接的报文
+ */
+void JournalSink::BuildDatagrams(const LogRecord* records, size_t count) {
+    datagrams_.clear();
+    boundaries_.clear();
+    const bool journald = ActiveProtocol() == JournalProtocol::JOURNALD;
+    for (size_t i = 0; i < count; i++) {
+        boundaries_.push_back(datagrams_.size());
+        if (journald) {
+            AppendJournalMessage(records[i]);
+        } else {
+            AppendSyslogMessage(records[i]);
+        }
+    }
+    boundaries_.push_back(datagrams_.size());
+}
+
+void JournalSink::Write(const LogRecord* records, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool reconnected = false;
+    if (fd_ < 0) {
+        reconnected = true;
+        Connect();
+    }
+    BuildDatagrams(records, count);
+
+    size_t sent = 0;
+    while (sent < count) {
+        if (fd_ < 0) {
+            break;
+        }
+        const size_t batch = std::min(count - sent, kMaxBatch);
+        const size_t done = SendBatch(sent, batch);
+        sent += done;
+        if (done > 0) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            congested_ = true;
+            break;
+        }
+        if (errno == EMSGSIZE) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);  // 单条报文过大，跳过
+            sent++;
+        } else if (!reconnected && (errno == ECONNREFUSED || errno == ENOTCONN || errno == ENOENT)) {
+            reconnected = true;  // 守护进程重启过，重新连接后重试一次
+            const JournalProtocol protocol = ActiveProtocol();
+            if (!Connect()) {
+                break;
+            }
+            if (ActiveProtocol() != protocol) {
+                BuildDatagrams(records, count);  // 切换了协议，剩余的消息重新编码
+            }
+        } else {
+            break;
+        }
+    }
+    if (sent < count) {
+        dropped_.fetch_add(count - sent, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief 用一次 sendmmsg 发送 [first, first + count) 的报文
+ *
+ * @return 发送成功的报文数，0 表示第一条就失败（errno 保留错误原因）
+ */
+size_t JournalSink::SendBatch(size_t first, size_t count) {
+    iovec segments[kMaxBatch];
+    mmsghdr messages[kMaxBatch];
+    std::memset(messages, 0, sizeof(mmsghdr) * count);
+    for (size_t i = 0; i < count; i++) {
+        const size_t begin = boundaries_[first + i];
+        segments[i].iov_base = datagrams_.data() + begin;
+        segments[i].iov_len = boundaries_[first + i + 1] - begin;
+        messages[i].msg_hdr.msg_iov = &segments[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+    }
+    while (true) {
+        const int flags = MSG_NOSIGNAL | (congested_ ? MSG_DONTWAIT : 0);
+        const int sent = ::sendmmsg(fd_, messages, static_cast<unsigned>(count), flags);
+        if (sent > 0) {
+            congested_ = false;
+            return static_cast<size_t>(sent);
+        }
+        if (sent == 0) {
+            errno = EAGAIN;
+            return 0;
+        }
+        if (errno != EINTR) {
+            return 0;
+        }
+    }
+}
+
+void JournalSink::AppendJournalMessage(const LogRecord& record) {
+    AppendField(datagrams_, "MESSAGE", record.message);
+    datagrams_.append("PRIORITY=");
+    datagrams_.push_back(static_cast<char>('0' + PriorityForLevel(record.level)));
+    datagrams_.push_back('\n');
+    AppendField(datagrams_, "SYSLOG_IDENTIFIER", identifier_);
+    AppendField(datagrams_, "COLOR_PRINTER_TYPE", record.type);
+    AppendField(datagrams_, "COLOR_PRINTER_COLOR", kColorNames[static_cast<size_t>(record.color)]);
+    for (const auto& field : options_.fields) {
+        AppendField(datagrams_, field.first, field.second);
+    }
+}
+
+/**
+ * @brief "<PRI>Mmm dd hh:mm:ss 标签[pid]: [类型] 消息"
+ */
+void JournalSink::AppendSyslogMessage(const LogRecord& record) {
+    char prefix[64];
+    const time_t now = ::time(nullptr);
+    tm local;
+    ::localtime_r(&now, &local);
+    const int priority = options_.facility * 8 + PriorityForLevel(record.level);
+    const int length = std::snprintf(prefix, sizeof(prefix), "<%d>", priority);
+    datagrams_.append(prefix, static_cast<size_t>(length));
+    const size_t time_length = std::strftime(prefix, sizeof(prefix), "%b %e %H:%M:%S ", &local);
+    datagrams_.append(prefix, time_length);
+    datagrams_.append(identifier_);
+    const int pid_length = std::snprintf(prefix, sizeof(prefix), "[%d]: [", static_cast<int>(::getpid()));
+    datagrams_.append(prefix, static_cast<size_t>(pid_length));
+    datagrams_.append(record.type);
+    datagrams_.append("] ");
+    datagrams_.append(record.message);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file color_printer_logline.h
+ * @brief 解析本库输出的日志行（颜色代码、时间戳、类型），供查询与合并工具使用（库内部使用，不安装）
+ */
+
+#ifndef COLOR_PRINTER_LOGLINE_H
+#define COLOR_PRINTER_LOGLINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "color_printer.h"
+
+namespace color_printer_detail {
+
+constexpr int64_t kNoTime = INT64_MIN;
+
+/**
+ * @struct ParsedLine
+ * @brief 从一行中解析出的字段
+ */
+struct ParsedLine {
+    LogLevel level = LogLevel::INFO;
+    int64_t time = kNoTime;
+    std::string_view plain;  ///< 去掉颜色代码后的内容
+};
+
+inline bool IsDigits(const char* text, int count) {
+    for (int i = 0; i < count; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline int ParseNumber(const char* text, int count) {
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        value = value * 10 + (text[i] - '0');
+    }
+    return value;
+}
+
+/**
+ * @brief 公历日期到 1970-01-01 起的天数
+ */
+inline int64_t DaysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned year_of_era = static_cast<unsigned>(year - era * 400);
+    const unsigned day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+}
+
+/**
+ * @brief 解析 "YYYY-MM-DD HH:MM:SS[.mmm]"（日期与时间之间也可以是 'T'）
+ *        时间戳按字面值换算成毫秒，不做时区转换，只用于比较先后
+ *
+ * @return 解析出的字节数，不是时间戳时返回0
+ */
+inline size_t ParseTimestamp(const char* text, size_t length, int64_t& millis) {
+    if (length < 19 || !IsDigits(text, 4) || text[4] != '-' || !IsDigits(text + 5, 2) || text[7] != '-' ||
+        !IsDigits(text + 8, 2) || (text[10] != ' ' && text[10] != 'T') || !IsDigits(text + 11, 2) ||
+        text[13] != ':' || !IsDigits(text + 14, 2) || text[16] != ':' || !IsDigits(text + 17, 2)) {
+        return 0;
+    }
+    const int64_t days = DaysFromCivil(ParseNumber(text, 4), static_cast<unsigned>(ParseNumber(text + 5, 2)),
+                                       static_cast<unsigned>(ParseNumber(text + 8, 2)));
+    const int64_t seconds = days * 86400 + ParseNumber(text + 11, 2) * 3600 + ParseNumber(text + 14, 2) * 60 +
+                            ParseNumber(text + 17, 2);
+    millis = seconds * 1000;
+    if (length >= 23 && text[19] == '.' && IsDigits(text + 20, 3)) {
+        millis += ParseNumber(text + 20, 3);
+        return 23;
+    }
+    return 19;
+}
+
+/**
+ * @brief 解析一行："[颜色代码][时间戳 ][类型] 正文[重置代码]"
+ *        识别不出类型的行按 INFO 处理
+ */
+inline ParsedLine ParseLine(std::string_view line) {
+    ParsedLine parsed;
+    if (line.size() >= 2 && line[0] == '\033' && line[1] == '[') {
+        const size_t end = line.find('m');
+        if (end != std::string_view::npos) {
+            line.remove_prefix(end + 1);
+        }
+    }
+    if (line.size() >= 4 && line.compare(line.size() - 4, 4, "\033[0m") == 0) {
+        line.remove_suffix(4);
+    }
+    parsed.plain = line;
+
+    std::string_view rest = line;
+    const size_t stamp = ParseTimestamp(rest.data(), rest.size(), parsed.time);
+    rest.remove_prefix(stamp);
+    if (stamp > 0 && !rest.empty() && rest[0] == ' ') {
+        rest.remove_prefix(1);
+    }
+    if (!rest.empty() && rest[0] == '[') {
+        const size_t close = rest.find(']');
+        if (close != std::string_view::npos && close <= 16) {
+            parsed.level = ColorPrinter::LevelFromType(rest.substr(1, close - 1));
+        }
+    }
+    return parsed;
+}
+
+} // namespace color_printer_detail
+
+#endif // COLOR_PRINTER_LOGLINE_H
@@ -0,0 +1,169 @@
+/**
+ * @file color_printer_lz.cpp
+ * @brief 内置 LZ 块压缩的实现
+ */
+
+#include "color_printer_lz.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace color_printer_detail {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kLastLiterals = 5;     // 块末尾这么多字节总是字面量
+constexpr size_t kMatchSearchLimit = 12; // 距块末尾不足这么多字节时不再查找匹配
+constexpr size_t kMaxOffset = 65535;
+constexpr unsigned kHashBits = 14;
+
+uint32_t Read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t Hash(uint32_t value) {
+    return (value * 2654435761u) >> (32 - kHashBits);
+}
+
+void AppendLength(std::string& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(static_cast<char>(255));
+        length -= 255;
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+void AppendSequence(std::string& out, const unsigned char* literals, size_t literal_length,
+                    size_t offset, size_t match_length) {
+    const size_t literal_code = literal_length < 15 ? literal_length : 15;
+    size_t match_code = 0;
+    if (match_length > 0) {
+        match_code = match_length - kMinMatch < 15 ? match_length - kMinMatch : 15;
+    }
+    out.push_back(static_cast<char>((literal_code << 4) | match_code));
+    if (literal_code == 15) {
+        AppendLength(out, literal_length - 15);
+    }
+    out.append(reinterpret_cast<const char*>(literals), literal_length);
+    if (match_length == 0) {
+        return;
+    }
+    out.push_back(static_cast<char>(offset & 0xff));
+    out.push_back(static_cast<char>(offset >> 8));
+    if (match_code == 15) {
+        AppendLength(out, match_length - kMinMatch - 15);
+    }
+}
+
+/**
+ * @brief 读取扩展长度，越界时返回false
+ */
+bool ReadLength(const unsigned char*& in, const unsigned char* end, size_t& length) {
+    unsigned char byte;
+    do {
+        if (in >= end) {
+            return false;
+        }
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+} // namespace
+
+size_t LzCompress(const char* data, size_t length, std::string& out) {
+    const size_t start_size = out.size();
+    const unsigned char* const base = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* const end = base + length;
+    const unsigned char* anchor = base;
+
+    if (length > kMatchSearchLimit) {
+        const unsigned char* const match_limit = end - kLastLiterals;
+        const unsigned char* const search_limit = end - kMatchSearchLimit;
+        std::vector<uint32_t> table(size_t(1) << kHashBits, 0);
+        const unsigned char* in = base + 1;
+        unsigned misses = 0;
+        while (in < search_limit) {
+            const uint32_t value = Read32(in);
+            uint32_t& slot = table[Hash(value)];
+            const unsigned char* candidate = base + slot;
+            slot = static_cast<uint32_t>(in - base);
+            if (candidate >= in || static_cast<size_t>(in - candidate) > kMaxOffset || Read32(candidate) != value) {
+                in += 1 + (misses++ >> 6);  // 长时间没有匹配时加大步长，快速跳过不可压缩的数据
+                continue;
+            }
+            misses = 0;
+            // 向前扩展到上一个序列末尾，向后扩展到块末尾的字面量区之前
+            while (in > anchor && candidate > base && in[-1] == candidate[-1]) {
+                in--;
+                candidate--;
+            }
+            size_t match_length = kMinMatch;
+            while (in + match_length < match_limit && in[match_length] == candidate[match_length]) {
+                match_length++;
+            }
+            AppendSequence(out, anchor, static_cast<size_t>(in - anchor), static_cast<size_t>(in - candidate),
+                           match_length);
+            in += match_length;
+            anchor = in;
+        }
+    }
+    AppendSequence(out, anchor, static_cast<size_t>(end - anchor), 0, 0);
+    return out.size() - start_size;
+}
+
+bool LzDecompress(const char* data, size_t length, char* dst, size_t raw_length) {
+    const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* const end = in + length;
+    unsigned char* out = reinterpret_cast<unsigned char*>(dst);
+    unsigned char* const out_begin = out;
+    unsigned char* const out_end = out + raw_length;
+
+    while (in < end) {
+        const unsigned token = *in++;
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && !ReadLength(in, end, literal_length)) {
+            return false;
+        }
+        if (literal_length > static_cast<size_t>(end - in) || literal_length > static_cast<size_t>(out_end - out)) {
+            return false;
+        }
+        std::memcpy(out, in, literal_length);
+        in += literal_length;
+        out += literal_length;
+        if (in == end) {
+            break;  // 最后一个序列只有字面量
+        }
+
+        if (end - in < 2) {
+            return false;
+        }
+        const size_t offset = static_cast<size_t>(in[0]) | (static_cast<size_t>(in[1]) << 8);
+        in += 2;
+        size_t match_length = (token & 15) + kMinMatch;
+        if ((token & 15) == 15 && !ReadLength(in, end, match_length)) {
+            return false;
+        }
+        if (offset == 0 || offset > static_cast<size_t>(out - out_begin) ||
+            match_length > static_cast<size_t>(out_end - out)) {
+            return false;
+        }
+        const unsigned char* match = out - offset;
+        if (offset >= match_length) {
+            std::memcpy(out, match, match_length);
+            out += match_length;
+        } else {
+            for (size_t i = 0; i < match_length; i++) {
+                *out++ = match[i];  // 重叠的匹配（重复模式）逐字节复制
+            }
+        }
+    }
+    return out == out_end;
+}
+
+} // namespace color_printer_detail
@@ -0,0 +1,33 @@
+/**
+ * @file color_printer_lz.h
+ * @brief 内置的 LZ 块压缩（LZ4 风格的序列格式，库内部使用，不安装）
+ */
+
+#ifndef COLOR_PRINTER_LZ_H
+#define COLOR_PRINTER_LZ_H
+
+#include <cstddef>
+#include <string>
+
+namespace color_printer_detail {
+
+/**
+ * @brief 压缩一个独立的块，结果追加到 out
+ *        序列格式：标记字节（高4位字面量长度，低4位匹配长度-4）、扩展长度、字面量、2字节偏移；
+ *        最后一个序列只有字面量
+ *
+ * @return 追加的字节数
+ */
+size_t LzCompress(const char* data, size_t length, std::string& out);
+
+/**
+ * @brief 解压 LzCompress 生成的块
+ *
+ * @param raw_length 解压后的长度，dst 至少有这么大
+ * @return 数据完整且长度一致时返回true
+ */
+bool LzDecompress(const char* data, size_t length, char* dst, size_t raw_length);
+
+} // namespace color_printer_detail
+
+#endif // COLOR_PRINTER_LZ_H
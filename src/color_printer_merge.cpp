@@ -0,0 +1,275 @@
+//
+// 日志合并工具：color_printer_merge [选项] 文件...
+// 把按进程/线程分开写的多个日志文件按行首时间戳合并成一条时间线，
+// 每个来源带一个以不同颜色显示的标签，行本身按级别着色
+// 各文件用 mmap 读取，逐行向前解析；用小根堆做 k 路归并，已输出的页面及时归还，内存占用与文件大小无关
+//
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <functional>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#include "color_printer.h"
+#include "color_printer_logline.h"
+
+
+namespace {
+
+using color_printer_detail::kNoTime;
+using color_printer_detail::ParsedLine;
+using color_printer_detail::ParseLine;
+
+constexpr size_t kOutputBytes = 1024 * 1024;
+constexpr size_t kReleaseBytes = 8 * 1024 * 1024;  // 每个来源已输出这么多字节后归还对应的页面
+constexpr size_t kMaxRecordBytes = 4 * 1024 * 1024;  // 一条记录（连同续行）最多这么长，之后的续行另起一条
+
+/**
+ * @struct Source
+ * @brief 一个输入文件及其读取位置
+ *        一条记录是一行带时间戳的行加上其后不带时间戳的续行（例如调用栈），续行跟随所在记录一起输出
+ */
+struct Source {
+    std::string tag;
+    PrintColor color;
+    const char* base = nullptr;
+    size_t size = 0;
+    size_t position = 0;       ///< 下一条记录的起点
+    size_t record_end = 0;     ///< 当前记录的终点（含换行）
+    size_t released = 0;       ///< [0, released) 的页面已归还
+    int64_t time = kNoTime;    ///< 当前记录的时间戳；文件开头不带时间戳的行沿用 kNoTime，排在最前
+    LogLevel level = LogLevel::INFO;
+};
+
+size_t LineEnd(const Source& source, size_t from) {
+    const void* newline = std::memchr(source.base + from, '\n', source.size - from);
+    return newline != nullptr ? static_cast<size_t>(static_cast<const char*>(newline) - source.base) + 1 : source.size;
+}
+
+ParsedLine ParseAt(const Source& source, size_t begin, size_t end) {
+    size_t length = end - begin;
+    if (length > 0 && source.base[end - 1] == '\n') {
+        length--;
+    }
+    return ParseLine(std::string_view(source.base + begin, length));
+}
+
+/**
+ * @brief 解析从 position 开始的下一条记录
+ *        续行累计超过 kMaxRecordBytes 时记录在行边界处截断，剩下的续行作为同一时间戳的下一条记录，
+ *        整个文件都不带时间戳时也不会一次扫描、占住整个文件
+ *
+ * @return 文件已读完时返回false
+ */
+bool Advance(Source& source) {
+    if (source.position >= source.size) {
+        return false;
+    }
+    size_t end = LineEnd(source, source.position);
+    const ParsedLine first = ParseAt(source, source.position, end);
+    if (first.time != kNoTime) {
+        source.time = first.time;
+        source.level = first.level;
+    }
+    while (end < source.size && end - source.position < kMaxRecordBytes) {
+        const size_t next_end = LineEnd(source, end);
+        if (ParseAt(source, end, next_end).time != kNoTime) {
+            break;
+        }
+        end = next_end;
+    }
+    source.record_end = end;
+    return true;
+}
+
+/**
+ * @brief 归还已经输出过的页面，让常驻内存不随文件大小增长
+ */
+void Release(Source& source) {
+    static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t until = source.position / page * page;
+    if (until - source.released >= kReleaseBytes) {
+        ::madvise(const_cast<char*>(source.base) + source.released, until - source.released, MADV_DONTNEED);
+        source.released = until;
+    }
+}
+
+class Output {
+public:
+    explicit Output(bool colored) : colored_(colored) {
+        buffer_.reserve(kOutputBytes + 4096);
+    }
+
+    /**
+     * @brief 输出当前记录：每一行都带来源标签，行按记录的级别着色
+     *        缓冲区每满 kOutputBytes 就写出；不短于 kOutputBytes 的行直接从映射写出，不拷贝
+     */
+    void Record(const Source& source, bool tagged) {
+        size_t line = source.position;
+        while (line < source.record_end) {
+            const size_t end = LineEnd(source, line);
+            const ParsedLine parsed = ParseAt(source, line, end);
+            if (tagged) {
+                if (colored_) {
+                    buffer_ += ColorPrinter::GetColorCode(source.color);
+                }
+                buffer_ += '[';
+                buffer_ += source.tag;
+                buffer_ += "] ";
+            }
+            if (colored_) {
+                buffer_ += ColorPrinter::GetColorCode(ColorPrinter::DefaultColorForLevel(source.level));
+            }
+            if (parsed.plain.size() >= kOutputBytes) {
+                Drain();
+                WriteAll(parsed.plain.data(), parsed.plain.size());
+            } else {
+                buffer_.append(parsed.plain);
+            }
+            buffer_ += colored_ ? "\033[0m\n" : "\n";
+            if (buffer_.size() >= kOutputBytes) {
+                Drain();
+            }
+            line = end;
+        }
+    }
+
+    bool Drain() {
+        WriteAll(buffer_.data(), buffer_.size());
+        buffer_.clear();
+        return ok_;
+    }
+
+    bool Ok() const { return ok_; }
+
+private:
+    void WriteAll(const char* data, size_t length) {
+        for (size_t offset = 0; ok_ && offset < length;) {
+            const ssize_t written = ::write(STDOUT_FILENO, data + offset, length - offset);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            ok_ = written > 0;
+            offset += written > 0 ? static_cast<size_t>(written) : 0;
+        }
+    }
+
+    bool colored_;
+    bool ok_ = true;
+    std::string buffer_;
+};
+
+/**
+ * @brief 打开并映射一个文件；映射后立即关闭描述符，输入文件数不受打开文件数上限限制
+ */
+bool MapSource(const char* path, Source& source) {
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    bool ok = ::fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+    if (ok && info.st_size > 0) {
+        void* mapped = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ok = mapped != MAP_FAILED;
+        if (ok) {
+            ::madvise(mapped, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            source.base = static_cast<const char*>(mapped);
+            source.size = static_cast<size_t>(info.st_size);
+        }
+    }
+    ::close(fd);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int colored = -1;
+    bool tagged = true;
+    int first_path = argc;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--color") == 0) {
+            colored = 1;
+        } else if (std::strcmp(argv[i], "--no-color") == 0) {
+            colored = 0;
+        } else if (std::strcmp(argv[i], "--no-tag") == 0) {
+            tagged = false;
+        } else if (argv[i][0] != '-') {
+            first_path = i;
+            break;
+        } else {
+            break;
+        }
+    }
+    if (first_path == argc) {
+        std::fprintf(stderr, "用法: %s [--color|--no-color] [--no-tag] 文件...\n", argv[0]);
+        return 2;
+    }
+    if (colored < 0) {
+        colored = isatty(STDOUT_FILENO) ? 1 : 0;
+    }
+
+    static constexpr PrintColor kPalette[] = {PrintColor::CYAN, PrintColor::MAGENTA, PrintColor::YELLOW,
+                                              PrintColor::BLUE, PrintColor::GREEN, PrintColor::RED,
+                                              PrintColor::WHITE};
+    int status = 0;
+    std::vector<Source> sources;
+    sources.reserve(static_cast<size_t>(argc - first_path));
+    for (int i = first_path; i < argc; i++) {
+        Source source;
+        if (!MapSource(argv[i], source)) {
+            ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无法读取: %s", argv[i]);
+            status = 1;
+            continue;
+        }
+        const char* slash = std::strrchr(argv[i], '/');
+        source.tag = slash != nullptr ? slash + 1 : argv[i];
+        source.color = kPalette[sources.size() % (sizeof(kPalette) / sizeof(kPalette[0]))];
+        sources.push_back(std::move(source));
+    }
+
+    // 小根堆：(时间戳, 来源下标)，时间相同时按命令行顺序
+    using Entry = std::pair<int64_t, uint32_t>;
+    std::vector<Entry> heap;
+    heap.reserve(sources.size());
+    for (uint32_t i = 0; i < sources.size(); i++) {
+        if (Advance(sources[i])) {
+            heap.emplace_back(sources[i].time, i);
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), std::greater<Entry>());
+
+    Output output(colored != 0);
+    while (!heap.empty() && output.Ok()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        const uint32_t index = heap.back().second;
+        heap.pop_back();
+        Source& source = sources[index];
+        output.Record(source, tagged);
+        source.position = source.record_end;
+        if (Advance(source)) {
+            heap.emplace_back(source.time, index);
+            std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        }
+        Release(source);
+    }
+    if (!output.Drain()) {
+        status = 1;
+    }
+    for (Source& source : sources) {
+        if (source.base != nullptr) {
+            ::munmap(const_cast<char*>(source.base), source.size);
+        }
+    }
+    return status;
+}
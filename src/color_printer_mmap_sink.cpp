@@ -0,0 +1,220 @@
+/**
+ * @file color_printer_mmap_sink.cpp
+ * @brief 内存映射环形日志文件输出端的实现
+ */
+
+#include "color_printer_mmap_sink.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "环形日志头需要无锁的64位原子变量");
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free, "帧头需要无锁的64位原子访问");
+
+namespace {
+
+/**
+ * @brief 以原子方式访问数据区中累计位置 position 处的8字节字（position 8字节对齐）
+ */
+std::atomic_ref<uint64_t> FrameWord(const char* data, uint64_t ring, uint64_t position) {
+    return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(const_cast<char*>(data) + position % ring));
+}
+
+/**
+ * @brief 起始位置为 position 的帧提交后的标记值；全零的数据区和上一圈的标记都不会与之相等
+ */
+uint64_t CommitStamp(uint64_t position) {
+    return ~position;
+}
+
+} // namespace
+
+MmapRingSink::MmapRingSink(const std::string& path, uint64_t capacity, bool colored)
+    : capacity_(MmapRingHeader::RingBytes(capacity)), colored_(colored) {
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0 || capacity_ < MmapRingHeader::FrameBytes(1)) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return;
+    }
+
+    const uint64_t file_bytes = MmapRingHeader::kDataOffset + capacity;
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return;
+    }
+    // 只初始化空文件；非空文件必须是容量相同的环形日志，否则拒绝打开，绝不截断别人的文件
+    const bool reuse = info.st_size != 0;
+    if (reuse) {
+        MmapRingHeader existing;
+        const bool matches = static_cast<uint64_t>(info.st_size) == file_bytes &&
+                             ::pread(fd, &existing, sizeof(existing), 0) == static_cast<ssize_t>(sizeof(existing)) &&
+                             std::memcmp(existing.magic, MmapRingHeader::kMagic, sizeof(existing.magic)) == 0 &&
+                             existing.capacity == capacity;
+        if (!matches) {
+            ::close(fd);
+            return;
+        }
+    } else if (::posix_fallocate(fd, 0, static_cast<off_t>(file_bytes)) != 0) {
+        // 预先分配全部块，避免运行中因磁盘已满在缺页时收到 SIGBUS
+        ::close(fd);
+        return;
+    }
+
+    void* mapping = ::mmap(nullptr, file_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return;
+    }
+    mapped_bytes_ = file_bytes;
+    header_ = static_cast<MmapRingHeader*>(mapping);
+    data_ = static_cast<char*>(mapping) + MmapRingHeader::kDataOffset;
+    if (!reuse) {
+        header_->capacity = capacity;
+        header_->head.store(0, std::memory_order_relaxed);
+        std::memcpy(header_->magic, MmapRingHeader::kMagic, sizeof(header_->magic));
+    }
+}
+
+MmapRingSink::~MmapRingSink() {
+    if (header_ != nullptr) {
+        ::munmap(header_, mapped_bytes_);
+    }
+}
+
+/**
+ * @brief 为整批消息预留一帧，拷贝正文后写入提交标记
+ *        批内超出容量的最旧部分直接跳过
+ */
+void MmapRingSink::Write(const LogRecord* records, size_t count) {
+    if (header_ == nullptr || count == 0) {
+        return;
+    }
+    uint64_t total = 0;
+    size_t first = count;
+    while (first > 0 && MmapRingHeader::FrameBytes(total + records[first - 1].line.size()) <= capacity_) {
+        first--;
+        total += records[first].line.size();
+    }
+    if (total == 0) {
+        return;
+    }
+
+    // acquire：正文的写入不会早于预留，读取方读完后看到的 head 足以判断是否被覆盖
+    const uint64_t frame = header_->head.fetch_add(MmapRingHeader::FrameBytes(total), std::memory_order_acquire);
+    FrameWord(data_, capacity_, frame + 8).store(total, std::memory_order_relaxed);
+    uint64_t position = frame + MmapRingHeader::kFrameHeader;
+    const char* run = records[first].line.data();
+    size_t run_length = 0;
+    for (size_t i = first; i < count; i++) {
+        const std::string_view line = records[i].line;
+        if (run + run_length != line.data()) {
+            Copy(position, run, run_length);
+            position += run_length;
+            run = line.data();
+            run_length = 0;
+        }
+        run_length += line.size();
+    }
+    Copy(position, run, run_length);
+    FrameWord(data_, capacity_, frame).store(CommitStamp(frame), std::memory_order_release);
+}
+
+void MmapRingSink::Copy(uint64_t position, const char* data, size_t length) {
+    const uint64_t offset = position % capacity_;
+    const size_t first_part = static_cast<size_t>(std::min<uint64_t>(length, capacity_ - offset));
+    std::memcpy(data_ + offset, data, first_part);
+    if (first_part < length) {
+        std::memcpy(data_, data + first_part, length - first_part);
+    }
+}
+
+void MmapRingSink::Flush() {
+    if (header_ != nullptr) {
+        ::msync(header_, mapped_bytes_, MS_ASYNC);
+    }
+}
+
+/**
+ * @brief 按时间顺序读取环形日志文件的内容
+ *
+ * @param path 文件路径
+ * @param out 输出按时间顺序排列的完整行
+ * @return 文件格式正确时返回true
+ */
+bool MmapRingSink::ReadChronological(const std::string& path, std::string& out) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) <= MmapRingHeader::kDataOffset) {
+        ::close(fd);
+        return false;
+    }
+    const size_t file_bytes = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, file_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    const auto* header = static_cast<const MmapRingHeader*>(mapping);
+    const char* data = static_cast<const char*>(mapping) + MmapRingHeader::kDataOffset;
+    const uint64_t capacity = header->capacity;
+    const uint64_t ring = MmapRingHeader::RingBytes(capacity);
+    const bool valid = std::memcmp(header->magic, MmapRingHeader::kMagic, sizeof(header->magic)) == 0 &&
+                       MmapRingHeader::kDataOffset + capacity == file_bytes &&
+                       ring >= MmapRingHeader::FrameBytes(1);
+    if (valid) {
+        // 从最旧的可能位置开始逐帧读取；提交标记不匹配的位置按8字节向后查找下一帧
+        const uint64_t head = header->head.load(std::memory_order_acquire) & ~uint64_t{7};
+        struct Frame {
+            uint64_t position;
+            size_t end;  ///< 该帧正文在 out 中的结束位置
+        };
+        std::vector<Frame> frames;
+        out.clear();
+        uint64_t position = head > ring ? head - ring : 0;
+        while (position + MmapRingHeader::kFrameHeader <= head) {
+            if (FrameWord(data, ring, position).load(std::memory_order_acquire) != CommitStamp(position)) {
+                position += 8;
+                continue;
+            }
+            const uint64_t length = FrameWord(data, ring, position + 8).load(std::memory_order_relaxed);
+            const uint64_t frame_bytes = MmapRingHeader::FrameBytes(length);
+            if (length == 0 || frame_bytes > ring || position + frame_bytes > head) {
+                position += 8;
+                continue;
+            }
+            const uint64_t offset = (position + MmapRingHeader::kFrameHeader) % ring;
+            const size_t first_part = static_cast<size_t>(std::min<uint64_t>(length, ring - offset));
+            out.append(data + offset, first_part);
+            out.append(data, static_cast<size_t>(length) - first_part);
+            frames.push_back({position, out.size()});
+            position += frame_bytes;
+        }
+
+        // 读取期间被新预留覆盖的帧可能已经混入新数据，整帧丢弃
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t latest = header->head.load(std::memory_order_relaxed);
+        const uint64_t oldest = latest > ring ? latest - ring : 0;
+        size_t keep_from = 0;
+        for (const Frame& frame : frames) {
+            if (frame.position >= oldest) {
+                break;
+            }
+            keep_from = frame.end;
+        }
+        out.erase(0, keep_from);
+    }
+    ::munmap(mapping, file_bytes);
+    return valid;
+}
@@ -0,0 +1,414 @@
+/**
+ * @file color_printer_network_sink.cpp
+ * @brief 网络输出端的实现
+ */
+
+#include "color_printer_network_sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <random>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t kMaxDatagramBytes = 65507;  // IPv4 UDP 数据报的最大负载
+constexpr std::chrono::milliseconds kPollInterval{50};
+
+constexpr std::string_view kLevelNames[] = {"DEBUG", "INFO", "OK", "WARNING", "ERROR", "FATAL"};
+constexpr std::string_view kColorNames[] = {"RED", "GREEN", "YELLOW", "BLUE", "MAGENTA", "CYAN", "WHITE"};
+
+void AppendJsonString(std::string& out, std::string_view text) {
+    out.push_back('"');
+    for (const char c : text) {
+        switch (c) {
+        case '"':
+            out.append("\\\"");
+            break;
+        case '\\':
+            out.append("\\\\");
+            break;
+        case '\n':
+            out.append("\\n");
+            break;
+        case '\t':
+            out.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                out.append(escaped);
+            } else {
+                out.push_back(c);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+uint64_t RandomStreamId() {
+    std::random_device device;
+    return (static_cast<uint64_t>(device()) << 32) ^ device();
+}
+
+} // namespace
+
+NetworkSink::NetworkSink(NetworkOptions options)
+    : options_(std::move(options)),
+      stream_id_(RandomStreamId()),
+      max_batch_bytes_(options_.protocol == NetworkProtocol::UDP
+                           ? std::min(options_.batch_bytes, kMaxDatagramBytes - sizeof(NetworkFrameHeader))
+                           : std::max<size_t>(options_.batch_bytes, 1)) {
+    sender_ = std::thread(&NetworkSink::SenderLoop, this);
+}
+
+NetworkSink::~NetworkSink() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        SealBatchLocked();
+        stop_ = true;
+        stop_deadline_ = std::chrono::steady_clock::now() + options_.flush_timeout;
+    }
+    sender_cv_.notify_one();
+    sender_.join();
+    Disconnect();
+}
+
+void NetworkSink::Write(const LogRecord* records, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t spooled = spool_.size();
+    const bool started = current_.records == 0;
+    for (size_t i = 0; i < count; i++) {
+        AppendRecordLocked(records[i]);
+    }
+    if (spool_.size() != spooled || (started && current_.records > 0)) {
+        sender_cv_.notify_one();  // 有新批次，或者新批次开始计时
+    }
+}
+
+void NetworkSink::Flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    SealBatchLocked();
+    sender_cv_.notify_one();
+    drained_cv_.wait_for(lock, options_.flush_timeout, [this] { return spool_.empty() && !sending_; });
+}
+
+/**
+ * @brief 把一条消息编码进当前批次，批次写满时封装进缓存
+ *        同一批内的消息序号总是连续的
+ */
+void NetworkSink::AppendRecordLocked(const LogRecord& record) {
+    const size_t header_bytes = sizeof(NetworkFrameHeader);
+    size_t record_bytes = record.line.size();
+    if (options_.format == NetworkFormat::RECORDS) {
+        record_bytes = record.message.size() + record.type.size() + 64;  // 预估，转义后可能更长
+    }
+    if (current_.records > 0 && current_.frame.size() - header_bytes + record_bytes > max_batch_bytes_) {
+        SealBatchLocked();
+    }
+    if (current_.records == 0) {
+        current_.frame.assign(header_bytes, '\0');
+        current_first_ = next_record_;
+        current_started_ = std::chrono::steady_clock::now();
+    }
+
+    const size_t before = current_.frame.size();
+    if (options_.format == NetworkFormat::LINES) {
+        current_.frame.append(record.line);
+    } else {
+        std::string& out = current_.frame;
+        out.append("{\"level\":\"");
+        out.append(kLevelNames[static_cast<size_t>(record.level)]);
+        out.append("\",\"type\":");
+        AppendJsonString(out, record.type);
+        out.append(",\"color\":\"");
+        out.append(kColorNames[static_cast<size_t>(record.color)]);
+        out.append("\",\"message\":");
+        AppendJsonString(out, record.message);
+        out.append("}\n");
+    }
+    next_record_++;
+
+    if (current_.frame.size() - header_bytes > max_batch_bytes_ && options_.protocol == NetworkProtocol::UDP) {
+        // 单条消息放不进一个数据报：丢弃，收集端会看到序号空缺
+        current_.frame.resize(before);
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        SealBatchLocked();
+        return;
+    }
+    current_.records++;
+    if (current_.frame.size() - header_bytes >= max_batch_bytes_) {
+        SealBatchLocked();
+    }
+}
+
+/**
+ * @brief 填写帧头并把当前批次放进缓存；缓存超出上限时丢弃最旧的批次
+ */
+void NetworkSink::SealBatchLocked() {
+    if (current_.records == 0) {
+        current_.frame.clear();
+        return;
+    }
+    NetworkFrameHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, NetworkFrameHeader::kMagic, sizeof(header.magic));
+    header.format = static_cast<uint8_t>(options_.format);
+    header.payload_bytes = static_cast<uint32_t>(current_.frame.size() - sizeof(header));
+    header.record_count = current_.records;
+    header.stream_id = stream_id_;
+    header.first_record = current_first_;
+    std::memcpy(current_.frame.data(), &header, sizeof(header));
+
+    spool_bytes_ += current_.frame.size();
+    spool_.push_back(std::move(current_));
+    current_ = Batch();
+    while (spool_bytes_ > options_.spool_bytes && spool_.size() > 1) {
+        spool_bytes_ -= spool_.front().frame.size();
+        dropped_.fetch_add(spool_.front().records, std::memory_order_relaxed);
+        spool_.pop_front();
+    }
+}
+
+void NetworkSink::SenderLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        if (current_.records > 0 && now >= current_started_ + options_.batch_interval) {
+            SealBatchLocked();
+        }
+        if (stop_ && now >= stop_deadline_) {
+            break;
+        }
+        if (!sending_) {
+            if (spool_.empty()) {
+                drained_cv_.notify_all();
+                if (stop_) {
+                    break;
+                }
+                auto deadline = current_.records > 0 ? current_started_ + options_.batch_interval
+                                                     : now + options_.batch_interval;
+                sender_cv_.wait_until(lock, deadline, [this] { return stop_ || !spool_.empty(); });
+                continue;
+            }
+            in_progress_ = std::move(spool_.front());
+            spool_.pop_front();
+            spool_bytes_ -= in_progress_.frame.size();
+            sent_offset_ = 0;
+            sending_ = true;
+        }
+
+        lock.unlock();
+        SendResult result = SendResult::BLOCKED;
+        if (EnsureConnected()) {
+            result = SendInProgress();
+        }
+        lock.lock();
+
+        if (result == SendResult::DONE || result == SendResult::FAILED) {
+            if (result == SendResult::DONE) {
+                sent_.fetch_add(in_progress_.records, std::memory_order_relaxed);
+            } else {
+                dropped_.fetch_add(in_progress_.records, std::memory_order_relaxed);
+            }
+            in_progress_ = Batch();
+            sending_ = false;
+            continue;
+        }
+        // 未连接或发送缓冲区已满：等到下次重连时间或短暂休眠后重试，期间仍按时封装批次
+        now = std::chrono::steady_clock::now();
+        auto wake = now + kPollInterval;
+        if (fd_ < 0) {
+            wake = std::max(wake, next_attempt_);
+        }
+        if (current_.records > 0) {
+            wake = std::min(wake, current_started_ + options_.batch_interval);
+        }
+        if (stop_) {
+            wake = std::min(wake, stop_deadline_);
+        }
+        sender_cv_.wait_until(lock, wake, [this] { return stop_ && std::chrono::steady_clock::now() >= stop_deadline_; });
+    }
+
+    // 超时仍未发出的消息计入丢弃
+    uint64_t abandoned = current_.records + (sending_ ? in_progress_.records : 0);
+    for (const Batch& batch : spool_) {
+        abandoned += batch.records;
+    }
+    dropped_.fetch_add(abandoned, std::memory_order_relaxed);
+    spool_.clear();
+    spool_bytes_ = 0;
+    current_ = Batch();
+    sending_ = false;
+    drained_cv_.notify_all();
+}
+
+/**
+ * @brief 推进非阻塞连接；解析出多个地址时依次尝试（例如 localhost 的 ::1 与 127.0.0.1），
+ *        全部失败后按指数退避安排下次尝试
+ *
+ * @return 已连接时返回true
+ */
+bool NetworkSink::EnsureConnected() {
+    const auto now = std::chrono::steady_clock::now();
+    auto fail = [this]() {
+        ScheduleReconnect();
+        return false;
+    };
+
+    if (fd_ < 0) {
+        if (now < next_attempt_) {
+            return false;
+        }
+        addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = options_.protocol == NetworkProtocol::TCP ? SOCK_STREAM : SOCK_DGRAM;
+        addrinfo* addresses = nullptr;
+        const std::string port = std::to_string(options_.port);
+        if (::getaddrinfo(options_.host.c_str(), port.c_str(), &hints, &addresses) != 0 || addresses == nullptr) {
+            return fail();
+        }
+        addresses_.clear();
+        for (const addrinfo* address = addresses; address != nullptr; address = address->ai_next) {
+            if (address->ai_addrlen > sizeof(sockaddr_storage)) {
+                continue;
+            }
+            Address copy{address->ai_family, address->ai_socktype, address->ai_protocol, {}, address->ai_addrlen};
+            std::memcpy(&copy.storage, address->ai_addr, address->ai_addrlen);
+            addresses_.push_back(copy);
+        }
+        ::freeaddrinfo(addresses);
+        next_address_ = 0;
+        if (!ConnectNext()) {
+            return fail();
+        }
+    }
+
+    if (connecting_) {
+        do {
+            pollfd descriptor{fd_, POLLOUT, 0};
+            if (::poll(&descriptor, 1, 0) <= 0) {
+                return false;  // 仍在连接
+            }
+            int error = 0;
+            socklen_t length = sizeof(error);
+            if (::getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &length) == 0 && error == 0) {
+                connecting_ = false;
+                break;
+            }
+            // 这个地址连不上：立即换下一个，不等退避
+            Disconnect();
+            if (!ConnectNext()) {
+                return fail();
+            }
+        } while (connecting_);
+    } else if (options_.protocol == NetworkProtocol::TCP && PeerClosed()) {
+        // 收集端已退出：对已关闭的连接 send 仍会成功，数据却无人接收，先重连再发送
+        sent_offset_ = 0;
+        return fail();
+    }
+    addresses_.clear();
+    backoff_ = std::chrono::milliseconds(0);
+    connected_.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief 从 next_address_ 开始依次发起连接，直到连接成功或进入非阻塞连接中
+ *
+ * @return 剩下的地址都无法发起连接时返回false
+ */
+bool NetworkSink::ConnectNext() {
+    while (next_address_ < addresses_.size()) {
+        const Address& address = addresses_[next_address_++];
+        fd_ = ::socket(address.family, address.socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, address.protocol);
+        if (fd_ < 0) {
+            continue;
+        }
+        const int result = ::connect(fd_, reinterpret_cast<const sockaddr*>(&address.storage), address.length);
+        if (result == 0 || errno == EINPROGRESS) {
+            connecting_ = result != 0;
+            return true;
+        }
+        Disconnect();
+    }
+    return false;
+}
+
+/**
+ * @brief 对端是否已关闭连接（收集端从不发送数据，可读且读到 EOF 即为关闭）
+ */
+bool NetworkSink::PeerClosed() const {
+    pollfd descriptor{fd_, POLLIN | POLLRDHUP, 0};
+    if (::poll(&descriptor, 1, 0) <= 0) {
+        return false;
+    }
+    if (descriptor.revents & (POLLRDHUP | POLLHUP | POLLERR)) {
+        return true;
+    }
+    char byte;
+    return ::recv(fd_, &byte, 1, MSG_PEEK | MSG_DONTWAIT) == 0;
+}
+
+/**
+ * @brief 断开连接，并把下次重连推迟一个退避间隔（每次失败加倍，直到 reconnect_max）
+ */
+void NetworkSink::ScheduleReconnect() {
+    Disconnect();
+    backoff_ = backoff_.count() == 0 ? options_.reconnect_min : std::min(backoff_ * 2, options_.reconnect_max);
+    next_attempt_ = std::chrono::steady_clock::now() + backoff_;
+}
+
+void NetworkSink::Disconnect() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    connecting_ = false;
+    connected_.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * @brief 发送 in_progress_ 的剩余部分
+ *        TCP 连接断开时从头重发该批次（收集端按新连接重新解析帧）；
+ *        UDP 数据报被拒收时丢弃该批次
+ */
+NetworkSink::SendResult NetworkSink::SendInProgress() {
+    const std::string& frame = in_progress_.frame;
+    while (sent_offset_ < frame.size()) {
+        const ssize_t sent = ::send(fd_, frame.data() + sent_offset_, frame.size() - sent_offset_,
+                                    MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent > 0) {
+            if (options_.protocol == NetworkProtocol::UDP) {
+                return SendResult::DONE;
+            }
+            sent_offset_ += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd descriptor{fd_, POLLOUT, 0};
+            if (::poll(&descriptor, 1, static_cast<int>(kPollInterval.count())) > 0) {
+                continue;
+            }
+            return SendResult::BLOCKED;
+        }
+        if (options_.protocol == NetworkProtocol::UDP) {
+            return SendResult::FAILED;  // 例如 ECONNREFUSED：收集端未监听
+        }
+        sent_offset_ = 0;
+        ScheduleReconnect();
+        return SendResult::BLOCKED;
+    }
+    return SendResult::DONE;
+}
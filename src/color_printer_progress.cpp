@@ -0,0 +1,267 @@
+/**
+ * @file color_printer_progress.cpp
+ * @brief ColorPrinter::Progress 的实现
+ */
+
+#include "color_printer.h"
+#include "color_printer_footer_sink.h"
+#include "color_printer_internal.h"
+#include "color_printer_snapshot.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kBarCells = 30;
+
+/**
+ * @brief 1/8 到 7/8 格的方块字符（UTF-8）
+ */
+constexpr const char* kPartialBlocks[8] = {"", "▏", "▎", "▍", "▌", "▋", "▊", "▉"};
+
+/**
+ * @brief 速率的平滑时间常数：越大越平稳，对速率变化的反应越慢
+ */
+constexpr double kRateTimeConstantSeconds = 2.0;
+
+} // namespace
+
+namespace color_printer_detail {
+
+std::string FormatCount(double value) {
+    static const char* const kSuffixes[] = {"", "k", "M", "G", "T"};
+    int suffix = 0;
+    while (value >= 1000.0 && suffix < 4) {
+        value /= 1000.0;
+        suffix++;
+    }
+    const int decimals = suffix == 0 ? 0 : (value < 10 ? 2 : (value < 100 ? 1 : 0));
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.*f%s", decimals, value, kSuffixes[suffix]);
+    return text;
+}
+
+std::string FormatDuration(double seconds) {
+    if (!std::isfinite(seconds) || seconds < 0 || seconds > 99 * 3600.0) {
+        return "--:--";
+    }
+    const long total = std::lround(seconds);
+    char text[32];
+    if (total >= 3600) {
+        std::snprintf(text, sizeof(text), "%ld:%02ld:%02ld", total / 3600, total / 60 % 60, total % 60);
+    } else {
+        std::snprintf(text, sizeof(text), "%02ld:%02ld", total / 60, total % 60);
+    }
+    return text;
+}
+
+void AppendProgressBar(std::string& out, double fraction, int cells) {
+    const int eighths = static_cast<int>(std::clamp(fraction, 0.0, 1.0) * cells * 8);
+    out += "│";
+    for (int cell = 0; cell < eighths / 8; cell++) {
+        out += "█";
+    }
+    int used = eighths / 8;
+    if (used < cells) {
+        out += kPartialBlocks[eighths % 8];
+        used += eighths % 8 != 0 ? 1 : 0;
+    }
+    out.append(static_cast<size_t>(cells - used), ' ');
+    out += "│";
+}
+
+void RateMeter::Update(uint64_t done, std::chrono::steady_clock::time_point now) {
+    if (!started_) {
+        started_ = true;
+        last_tick_ = now;
+        last_done_ = done;
+        return;
+    }
+    const double dt = std::chrono::duration<double>(now - last_tick_).count();
+    if (dt <= 0) {
+        return;
+    }
+    const double instant = static_cast<double>(done - last_done_) / dt;
+    const bool first = last_done_ == 0 && rate_ == 0;
+    const double alpha = first ? 1.0 : 1.0 - std::exp(-dt / kRateTimeConstantSeconds);
+    rate_ += alpha * (instant - rate_);
+    last_tick_ = now;
+    last_done_ = done;
+}
+
+} // namespace color_printer_detail
+
+/**
+ * @class ColorPrinter::Progress::Impl
+ * @brief 分片计数与后台绘制线程
+ */
+class ColorPrinter::Progress::Impl {
+public:
+    static constexpr unsigned kShards = 64;
+
+    Impl(uint64_t total, PrintColor color, std::string type, std::chrono::milliseconds refresh)
+        : total_(total), color_(color), type_(std::move(type)), refresh_(refresh),
+          fd_(color_printer_detail::IndicatorFd()), interactive_(isatty(fd_) != 0),
+          started_(std::chrono::steady_clock::now()) {
+        rate_.Update(0, started_);
+        if (interactive_) {
+            renderer_ = std::thread([this] { Run(); });
+        }
+    }
+
+    ~Impl() {
+        Finish();
+    }
+
+    void Advance(uint64_t count) {
+        shards_[color_printer_detail::ThreadReaderShard() % kShards].done.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    uint64_t Done() const {
+        uint64_t done = 0;
+        for (const Shard& shard : shards_) {
+            done += shard.done.load(std::memory_order_relaxed);
+        }
+        return done;
+    }
+
+    void Finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (finished_) {
+                return;
+            }
+            finished_ = true;
+        }
+        stop_cv_.notify_all();
+        if (renderer_.joinable()) {
+            renderer_.join();
+        }
+        Draw(true);
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> done{0};
+    };
+
+    void Run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_cv_.wait_for(lock, refresh_, [this] { return finished_; })) {
+            lock.unlock();
+            Draw(false);
+            lock.lock();
+        }
+    }
+
+    /**
+     * @brief 绘制一帧
+     *        有状态页脚时画在页脚中，结束时最终状态写在页脚上方；
+     *        否则回到行首清除整行后一次写出。颜色代码跟随默认打印器输出端的 WantsColor()
+     *        final 为true时速率取全程平均，并以换行结束
+     */
+    void Draw(bool final) {
+        const auto now = std::chrono::steady_clock::now();
+        const uint64_t done = Done();
+        const double elapsed = std::chrono::duration<double>(now - started_).count();
+        rate_.Update(done, now);
+        const double rate = final && elapsed > 0 ? static_cast<double>(done) / elapsed : rate_.Rate();
+
+        std::string text;
+        text += '[';
+        text += type_;
+        text += "] ";
+        if (total_ > 0) {
+            const double fraction = std::min(1.0, static_cast<double>(done) / static_cast<double>(total_));
+            color_printer_detail::AppendProgressBar(text, fraction, kBarCells);
+            char percent[16];
+            std::snprintf(percent, sizeof(percent), " %5.1f%% ", fraction * 100.0);
+            text += percent;
+            text += color_printer_detail::FormatCount(static_cast<double>(done));
+            text += '/';
+            text += color_printer_detail::FormatCount(static_cast<double>(total_));
+        } else {
+            text += color_printer_detail::FormatCount(static_cast<double>(done));
+        }
+        text += "  ";
+        text += color_printer_detail::FormatCount(rate);
+        text += "/s  ";
+        if (final) {
+            text += color_printer_detail::FormatDuration(elapsed);
+        } else if (total_ > 0) {
+            text += "ETA ";
+            const double remaining = done >= total_ ? 0.0 : static_cast<double>(total_ - done) / rate;
+            text += color_printer_detail::FormatDuration(remaining);
+        } else {
+            text += color_printer_detail::FormatDuration(elapsed);
+        }
+
+        const bool colored = ColorPrinter::Default().Sink()->WantsColor();
+        if (final) {
+            if (color_printer_detail::ShowLinesInFooter(this, {})) {
+                color_printer_detail::WriteAboveFooter(color_, text);
+                return;
+            }
+        } else if (color_printer_detail::ShowLinesInFooter(this, {colored ? GetColorCode(color_) + text : text})) {
+            return;
+        }
+
+        std::string frame;
+        if (interactive_) {
+            frame += "\r\033[2K";
+        }
+        if (colored) {
+            frame += GetColorCode(color_);
+            frame += text;
+            frame += "\033[0m";
+        } else {
+            frame += text;
+        }
+        if (final) {
+            frame += '\n';
+        }
+        std::cout.flush();  // 保持与调用者自己的 std::cout 输出的先后顺序
+        color_printer_detail::WriteAll(fd_, frame.data(), frame.size());
+    }
+
+    const uint64_t total_;
+    const PrintColor color_;
+    const std::string type_;
+    const std::chrono::milliseconds refresh_;
+    const int fd_;
+    const bool interactive_;
+    const std::chrono::steady_clock::time_point started_;
+    Shard shards_[kShards];
+
+    color_printer_detail::RateMeter rate_;  // 只由绘制线程访问（Finish 在绘制线程结束后才访问）
+
+    std::mutex mutex_;
+    std::condition_variable stop_cv_;
+    bool finished_ = false;
+    std::thread renderer_;
+};
+
+ColorPrinter::Progress::Progress(uint64_t total, PrintColor color, std::string type, std::chrono::milliseconds refresh)
+    : impl_(std::make_unique<Impl>(total, color, std::move(type), refresh)) {
+}
+
+ColorPrinter::Progress::~Progress() = default;
+
+void ColorPrinter::Progress::Advance(uint64_t count) {
+    impl_->Advance(count);
+}
+
+uint64_t ColorPrinter::Progress::Done() const {
+    return impl_->Done();
+}
+
+void ColorPrinter::Progress::Finish() {
+    impl_->Finish();
+}
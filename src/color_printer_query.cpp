@@ -0,0 +1,483 @@
+//
+// 日志查询工具：color_printer_query [选项] 文件...
+// 第一次查询某个文件时在旁边生成索引文件 <文件>.cpidx：把文件切成约 1 MB 的块（块边界在换行处），
+// 记录每块的偏移、时间范围与出现过的级别集合；之后按级别、时间范围和子串查询时只扫描可能命中的块，
+// 多个线程并行扫描，结果按原文件顺序着色输出
+// 文件只追加时，索引从最后一块开始增量更新；文件被替换（inode 变化）、开头内容变化或变小时重建
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "color_printer.h"
+#include "color_printer_logline.h"
+
+
+namespace {
+
+using color_printer_detail::kNoTime;
+using color_printer_detail::ParsedLine;
+using color_printer_detail::ParseLine;
+using color_printer_detail::ParseTimestamp;
+
+constexpr size_t kBlockBytes = 1024 * 1024;
+constexpr size_t kHeadHashBytes = 64 * 1024;  // 用于识别文件是否被改写的开头字节数
+constexpr char kIndexMagic[8] = {'C', 'P', 'I', 'D', 'X', '2', 0, 0};
+
+/**
+ * @struct IndexHeader
+ * @brief 索引文件头，记录建索引时源文件的身份与大小
+ *        大小相同不足以说明文件没变：轮转后的新文件、copytruncate 后重新写到同样大小的文件都可能同样大，
+ *        因此同时比较 inode、修改时间和文件开头的哈希
+ */
+struct IndexHeader {
+    char magic[8];
+    uint64_t source_size;
+    uint64_t block_count;
+    uint64_t source_inode;
+    int64_t source_mtime_ns;
+    uint64_t head_hash;   ///< 文件开头 min(source_size, kHeadHashBytes) 字节的 FNV-1a 哈希
+};
+
+/**
+ * @struct SourceInfo
+ * @brief 当前源文件的身份
+ */
+struct SourceInfo {
+    uint64_t size;
+    uint64_t inode;
+    int64_t mtime_ns;
+};
+
+/**
+ * @struct BlockInfo
+ * @brief 一个块的摘要（索引文件中每块 40 字节）
+ */
+struct BlockInfo {
+    uint64_t offset;
+    uint32_t length;
+    uint32_t lines;
+    int64_t min_time;   ///< 块内最早的时间戳（毫秒，按本地时间的字面值换算），没有时间戳时为 kNoTime
+    int64_t max_time;
+    uint8_t levels;     ///< 出现过的级别集合，第 i 位对应 LogLevel(i)
+    uint8_t untimed;    ///< 块内是否有不带时间戳的行
+    uint8_t reserved[6];
+};
+
+static_assert(sizeof(BlockInfo) == 40, "BlockInfo 是索引文件格式的一部分");
+
+/**
+ * @struct Query
+ * @brief 查询条件
+ */
+struct Query {
+    uint8_t levels = 0x3f;
+    int64_t since = kNoTime;
+    int64_t until = kNoTime;
+    std::string needle;
+    bool colored = false;
+};
+
+uint64_t HeadHash(const char* base, size_t size) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(base);
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < std::min(size, kHeadHashBytes); i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief 为 [begin, end) 生成块摘要，块边界对齐到换行
+ *        1 MB 内没有换行时块延伸到下一个换行，长行不会被切开（被切开的后半段会被当作一行另行解析）
+ */
+void IndexRange(const char* base, size_t begin, size_t end, std::vector<BlockInfo>& blocks) {
+    size_t offset = begin;
+    while (offset < end) {
+        size_t limit = std::min(end, offset + kBlockBytes);
+        if (limit < end) {
+            const void* newline = ::memrchr(base + offset, '\n', limit - offset);
+            if (newline == nullptr) {
+                newline = std::memchr(base + limit, '\n', end - limit);
+            }
+            limit = newline != nullptr ? static_cast<size_t>(static_cast<const char*>(newline) - base) + 1 : end;
+            limit = std::min(limit, offset + UINT32_MAX);  // BlockInfo::length 是32位
+        }
+        BlockInfo block = {};
+        block.offset = offset;
+        block.length = static_cast<uint32_t>(limit - offset);
+        block.min_time = kNoTime;
+        block.max_time = kNoTime;
+        const char* line = base + offset;
+        const char* const block_end = base + limit;
+        while (line < block_end) {
+            const char* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(block_end - line)));
+            const char* line_end = newline != nullptr ? newline : block_end;
+            const ParsedLine parsed = ParseLine(std::string_view(line, static_cast<size_t>(line_end - line)));
+            block.lines++;
+            block.levels |= static_cast<uint8_t>(1u << static_cast<int>(parsed.level));
+            if (parsed.time == kNoTime) {
+                block.untimed = 1;
+            } else {
+                block.min_time = block.min_time == kNoTime ? parsed.time : std::min(block.min_time, parsed.time);
+                block.max_time = std::max(block.max_time, parsed.time);
+            }
+            line = line_end + 1;
+        }
+        blocks.push_back(block);
+        offset = limit;
+    }
+}
+
+/**
+ * @brief 并行为 [begin, end) 建索引：按线程数切分（切分点对齐到换行），各线程独立生成块摘要后按顺序拼接
+ */
+std::vector<BlockInfo> BuildBlocks(const char* base, size_t begin, size_t end, unsigned threads) {
+    std::vector<size_t> cuts = {begin};
+    const size_t share = std::max(kBlockBytes * 8, (end - begin) / threads + 1);
+    for (size_t target = begin + share; target < end; target += share) {
+        if (target <= cuts.back()) {
+            continue;
+        }
+        const void* newline = std::memchr(base + target, '\n', end - target);
+        if (newline == nullptr) {
+            break;
+        }
+        const size_t aligned = static_cast<size_t>(static_cast<const char*>(newline) - base) + 1;
+        if (aligned < end) {
+            cuts.push_back(aligned);
+        }
+    }
+    cuts.push_back(end);
+
+    std::vector<std::vector<BlockInfo>> parts(cuts.size() - 1);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i + 1 < cuts.size(); i++) {
+        workers.emplace_back([&, i] { IndexRange(base, cuts[i], cuts[i + 1], parts[i]); });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    std::vector<BlockInfo> blocks;
+    for (const auto& part : parts) {
+        blocks.insert(blocks.end(), part.begin(), part.end());
+    }
+    return blocks;
+}
+
+bool ReadIndex(const std::string& path, IndexHeader& header, std::vector<BlockInfo>& blocks) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = ::read(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)) &&
+              std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) == 0 && header.block_count < (1ull << 32);
+    if (ok) {
+        blocks.resize(header.block_count);
+        const ssize_t bytes = static_cast<ssize_t>(blocks.size() * sizeof(BlockInfo));
+        ok = ::read(fd, blocks.data(), static_cast<size_t>(bytes)) == bytes;
+    }
+    ::close(fd);
+    return ok;
+}
+
+/**
+ * @brief 写到临时文件后改名，并发的查询不会读到写了一半的索引
+ */
+bool WriteIndex(const std::string& path, const SourceInfo& source, uint64_t head_hash,
+                const std::vector<BlockInfo>& blocks) {
+    const std::string temporary = path + ".tmp." + std::to_string(::getpid());
+    const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    IndexHeader header = {};
+    std::memcpy(header.magic, kIndexMagic, sizeof(kIndexMagic));
+    header.source_size = source.size;
+    header.block_count = blocks.size();
+    header.source_inode = source.inode;
+    header.source_mtime_ns = source.mtime_ns;
+    header.head_hash = head_hash;
+    const size_t bytes = blocks.size() * sizeof(BlockInfo);
+    bool ok = ::write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)) &&
+              ::write(fd, blocks.data(), bytes) == static_cast<ssize_t>(bytes);
+    ok = ::close(fd) == 0 && ok;
+    if (!ok || ::rename(temporary.c_str(), path.c_str()) != 0) {
+        ::unlink(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 读取或更新索引
+ *        同一个文件（inode 相同、开头未变）：大小与修改时间都没变时直接使用，只增长时只为新增部分建索引；
+ *        其余情况（被替换、被改写、变小）重建
+ */
+std::vector<BlockInfo> LoadIndex(const std::string& path, const char* base, const SourceInfo& source,
+                                 unsigned threads, bool rebuild) {
+    const std::string index_path = path + ".cpidx";
+    const size_t size = static_cast<size_t>(source.size);
+    IndexHeader header;
+    std::vector<BlockInfo> blocks;
+    if (!rebuild && ReadIndex(index_path, header, blocks) && header.source_inode == source.inode &&
+        header.source_size <= source.size &&
+        header.head_hash == HeadHash(base, static_cast<size_t>(header.source_size))) {
+        if (header.source_size == source.size && header.source_mtime_ns == source.mtime_ns) {
+            return blocks;
+        }
+        if (header.source_size < source.size && !blocks.empty()) {
+            // 最后一块可能以不完整的行结尾，从它开始重新建索引
+            const size_t resume = blocks.back().offset;
+            blocks.pop_back();
+            std::vector<BlockInfo> added = BuildBlocks(base, resume, size, threads);
+            blocks.insert(blocks.end(), added.begin(), added.end());
+            WriteIndex(index_path, source, HeadHash(base, size), blocks);
+            return blocks;
+        }
+    }
+    blocks = BuildBlocks(base, 0, size, threads);
+    if (!WriteIndex(index_path, source, HeadHash(base, size), blocks)) {
+        ColorPrinter::PrintColoredMessage(PrintColor::YELLOW, "WARNING", "无法写入索引文件 %s，本次只在内存中使用",
+                                          index_path.c_str());
+    }
+    return blocks;
+}
+
+bool BlockMayMatch(const BlockInfo& block, const Query& query) {
+    if ((block.levels & query.levels) == 0) {
+        return false;
+    }
+    if (query.since == kNoTime && query.until == kNoTime) {
+        return true;
+    }
+    if (block.min_time == kNoTime) {
+        return false;
+    }
+    return (query.since == kNoTime || block.max_time >= query.since) &&
+           (query.until == kNoTime || block.min_time <= query.until);
+}
+
+/**
+ * @brief 扫描一个块，把命中的行追加到 out
+ *        有子串条件时先在整块上用 memmem 找出现位置，只解析包含它的行
+ */
+void ScanBlock(const char* data, size_t length, const Query& query, std::string& out) {
+    const char* const end = data + length;
+    auto consider = [&](const char* line, const char* line_end) {
+        const ParsedLine parsed = ParseLine(std::string_view(line, static_cast<size_t>(line_end - line)));
+        if ((query.levels & (1u << static_cast<int>(parsed.level))) == 0) {
+            return;
+        }
+        if (query.since != kNoTime || query.until != kNoTime) {
+            if (parsed.time == kNoTime || (query.since != kNoTime && parsed.time < query.since) ||
+                (query.until != kNoTime && parsed.time > query.until)) {
+                return;
+            }
+        }
+        if (query.colored) {
+            out += ColorPrinter::GetColorCode(ColorPrinter::DefaultColorForLevel(parsed.level));
+            out.append(parsed.plain);
+            out += "\033[0m\n";
+        } else {
+            out.append(parsed.plain);
+            out += '\n';
+        }
+    };
+
+    const char* line = data;
+    while (line < end) {
+        if (!query.needle.empty()) {
+            const char* hit = static_cast<const char*>(
+                ::memmem(line, static_cast<size_t>(end - line), query.needle.data(), query.needle.size()));
+            if (hit == nullptr) {
+                return;
+            }
+            const void* previous = ::memrchr(line, '\n', static_cast<size_t>(hit - line));
+            line = previous != nullptr ? static_cast<const char*>(previous) + 1 : line;
+        }
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+        const char* line_end = newline != nullptr ? newline : end;
+        consider(line, line_end);
+        line = line_end + 1;
+    }
+}
+
+/**
+ * @brief 并行扫描选中的块，按块的顺序写出结果
+ *        工作线程最多领先写出位置 window 个块，结果占用的内存有上限
+ */
+bool RunQuery(const char* base, const std::vector<BlockInfo>& blocks, const Query& query, unsigned threads) {
+    std::vector<const BlockInfo*> selected;
+    for (const BlockInfo& block : blocks) {
+        if (BlockMayMatch(block, query)) {
+            selected.push_back(&block);
+        }
+    }
+    const size_t window = threads * 4;
+    std::vector<std::string> results(selected.size());
+    std::vector<char> done(selected.size(), 0);
+    std::mutex mutex;
+    std::condition_variable ready_cv;
+    std::condition_variable space_cv;
+    size_t next = 0;
+    size_t written = 0;
+
+    auto work = [&] {
+        for (;;) {
+            size_t index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                space_cv.wait(lock, [&] { return next >= selected.size() || next < written + window; });
+                if (next >= selected.size()) {
+                    return;
+                }
+                index = next++;
+            }
+            std::string out;
+            ScanBlock(base + selected[index]->offset, selected[index]->length, query, out);
+            std::lock_guard<std::mutex> lock(mutex);
+            results[index] = std::move(out);
+            done[index] = 1;
+            ready_cv.notify_one();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(work);
+    }
+
+    bool ok = true;
+    for (size_t index = 0; index < selected.size(); index++) {
+        std::string out;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready_cv.wait(lock, [&] { return done[index] != 0; });
+            out.swap(results[index]);
+            written = index + 1;
+        }
+        space_cv.notify_all();
+        for (size_t offset = 0; ok && offset < out.size();) {
+            const ssize_t count = ::write(STDOUT_FILENO, out.data() + offset, out.size() - offset);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            ok = count > 0;
+            offset += count > 0 ? static_cast<size_t>(count) : 0;
+        }
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return ok;
+}
+
+bool ParseLevelName(const char* name, LogLevel& level) {
+    level = ColorPrinter::LevelFromType(name);
+    return level != LogLevel::INFO || ::strcasecmp(name, "INFO") == 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Query query;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool rebuild = false;
+    int colored = -1;
+    int first_path = argc;
+    for (int i = 1; i < argc; i++) {
+        LogLevel level;
+        int64_t millis;
+        if (std::strcmp(argv[i], "--level") == 0 && i + 1 < argc && ParseLevelName(argv[i + 1], level)) {
+            query.levels = static_cast<uint8_t>(0x3f & ~((1u << static_cast<int>(level)) - 1));  // 该级别及以上
+            i++;
+        } else if (std::strcmp(argv[i], "--only") == 0 && i + 1 < argc && ParseLevelName(argv[i + 1], level)) {
+            query.levels = static_cast<uint8_t>(1u << static_cast<int>(level));
+            i++;
+        } else if (std::strcmp(argv[i], "--since") == 0 && i + 1 < argc &&
+                   ParseTimestamp(argv[i + 1], std::strlen(argv[i + 1]), millis) > 0) {
+            query.since = millis;
+            i++;
+        } else if (std::strcmp(argv[i], "--until") == 0 && i + 1 < argc &&
+                   ParseTimestamp(argv[i + 1], std::strlen(argv[i + 1]), millis) > 0) {
+            query.until = millis;
+            i++;
+        } else if (std::strcmp(argv[i], "--grep") == 0 && i + 1 < argc) {
+            query.needle = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--reindex") == 0) {
+            rebuild = true;
+        } else if (std::strcmp(argv[i], "--color") == 0) {
+            colored = 1;
+        } else if (std::strcmp(argv[i], "--no-color") == 0) {
+            colored = 0;
+        } else if (argv[i][0] != '-') {
+            first_path = i;
+            break;
+        } else {
+            first_path = argc;
+            break;
+        }
+    }
+    if (first_path == argc) {
+        std::fprintf(stderr,
+                     "用法: %s [--level 最低级别|--only 级别] [--since 时间] [--until 时间] [--grep 子串]\n"
+                     "          [--threads N] [--reindex] [--color|--no-color] 文件...\n"
+                     "时间格式: \"YYYY-MM-DD HH:MM:SS[.mmm]\"\n",
+                     argv[0]);
+        return 2;
+    }
+    query.colored = colored < 0 ? isatty(STDOUT_FILENO) != 0 : colored != 0;
+
+    int status = 0;
+    for (int i = first_path; i < argc; i++) {
+        const int fd = ::open(argv[i], O_RDONLY | O_CLOEXEC);
+        struct stat info;
+        if (fd < 0 || ::fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+            ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无法读取: %s", argv[i]);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            status = 1;
+            continue;
+        }
+        const size_t size = static_cast<size_t>(info.st_size);
+        if (size == 0) {
+            ::close(fd);
+            continue;
+        }
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无法映射: %s", argv[i]);
+            status = 1;
+            continue;
+        }
+        const char* base = static_cast<const char*>(mapped);
+        const SourceInfo source = {size, static_cast<uint64_t>(info.st_ino),
+                                   static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec};
+        const std::vector<BlockInfo> blocks = LoadIndex(argv[i], base, source, threads, rebuild);
+        if (!RunQuery(base, blocks, query, threads)) {
+            status = 1;
+        }
+        ::munmap(mapped, size);
+    }
+    return status;
+}
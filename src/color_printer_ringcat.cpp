@@ -0,0 +1,74 @@
+//
+// 环形日志文件读取工具：按时间顺序输出 MmapRingSink 写入的文件，并按级别着色
+//
+
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include "color_printer.h"
+#include "color_printer_mmap_sink.h"
+
+
+/**
+ * @brief 提取行首（可能带时间戳）的 "[类型]" 并给整行着色
+ */
+static void AppendColorizedLine(std::string_view line, std::string& out) {
+    const size_t open = line.find('[');
+    const size_t close = open == std::string_view::npos ? open : line.find(']', open);
+    if (close == std::string_view::npos || line.find("\033[") != std::string_view::npos) {
+        out.append(line);  // 没有类型标记，或写入时已带颜色代码
+        return;
+    }
+    const LogLevel level = ColorPrinter::LevelFromType(line.substr(open + 1, close - open - 1));
+    out += ColorPrinter::GetColorCode(ColorPrinter::DefaultColorForLevel(level));
+    out.append(line.substr(0, line.size() - 1));
+    out += "\033[0m\n";
+}
+
+int main(int argc, char *argv[])
+{
+    bool colored = isatty(STDOUT_FILENO);
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--color") == 0) {
+            colored = true;
+        } else if (std::strcmp(argv[i], "--no-color") == 0) {
+            colored = false;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr) {
+        std::fprintf(stderr, "用法: %s [--color|--no-color] <环形日志文件>\n", argv[0]);
+        return 2;
+    }
+
+    std::string content;
+    if (!MmapRingSink::ReadChronological(path, content)) {
+        ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无法读取环形日志文件: %s", path);
+        return 1;
+    }
+
+    std::string output;
+    if (colored) {
+        output.reserve(content.size() + content.size() / 8);
+        size_t start = 0;
+        while (start < content.size()) {
+            const size_t end = content.find('\n', start);
+            AppendColorizedLine(std::string_view(content).substr(start, end + 1 - start), output);
+            start = end + 1;
+        }
+    } else {
+        output.swap(content);
+    }
+
+    size_t offset = 0;
+    while (offset < output.size()) {
+        const ssize_t written = ::write(STDOUT_FILENO, output.data() + offset, output.size() - offset);
+        if (written <= 0) {
+            return 1;
+        }
+        offset += static_cast<size_t>(written);
+    }
+    return 0;
+}
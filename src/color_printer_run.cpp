@@ -0,0 +1,364 @@
+//
+// 运行子进程并给它的输出着色：color_printer_run [选项] -- 命令 参数...
+// 子进程的标准输出和标准错误分别经管道读取（epoll），按行匹配规则得到消息类型，
+// 经打印器渲染后批量写出；退出码与子进程一致
+//
+
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <regex>
+#include <string>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "color_printer.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+static volatile pid_t g_child = -1;
+
+static void ForwardSignal(int signal_number) {
+    if (g_child > 0) {
+        ::kill(g_child, signal_number);
+    }
+}
+
+/**
+ * @struct Rule
+ * @brief 行匹配规则：包含关键字（或匹配正则）的行使用规则的类型，颜色取该类型级别的默认颜色
+ */
+struct Rule {
+    std::string type;
+    PrintColor color;
+    std::string keyword;
+    bool ignore_case = false;
+    std::unique_ptr<std::regex> pattern;
+    const char* next_match = nullptr;  // 当前读取块中关键字的下一个出现位置，块内只向前扫描一遍
+};
+
+/**
+ * @struct Channel
+ * @brief 子进程的一个输出管道
+ */
+struct Channel {
+    int fd = -1;
+    PrintColor color;
+    std::string type;
+    std::string partial;  // 跨越读取块的半行
+};
+
+static std::vector<Rule> g_rules;
+
+static bool KeywordAt(const char* position, const Rule& rule) {
+    return rule.ignore_case ? ::strncasecmp(position, rule.keyword.data(), rule.keyword.size()) == 0
+                            : std::memcmp(position, rule.keyword.data(), rule.keyword.size()) == 0;
+}
+
+/**
+ * @brief 在 [begin, end) 中查找规则的关键字，找不到时返回 end
+ *        SSE2：一次比较16个位置的首字节和末字节，两者都相等的位置才逐字节确认；
+ *        忽略大小写时比较前先把字节 |0x20（确认时再精确比较），所以大小写各种写法只需扫描一遍
+ */
+static const char* FindKeyword(const char* begin, const char* end, const Rule& rule) {
+    const size_t length = rule.keyword.size();
+    const char* position = begin;
+#if defined(__SSE2__)
+    if (length >= 2) {
+        const char fold = rule.ignore_case ? 0x20 : 0;
+        const __m128i fold_mask = _mm_set1_epi8(fold);
+        const __m128i first = _mm_set1_epi8(static_cast<char>(rule.keyword.front() | fold));
+        const __m128i last = _mm_set1_epi8(static_cast<char>(rule.keyword.back() | fold));
+        for (; end - position >= static_cast<ptrdiff_t>(length + 15); position += 16) {
+            const __m128i head = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(position)), fold_mask);
+            const __m128i tail = _mm_or_si128(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(position + length - 1)), fold_mask);
+            unsigned mask = static_cast<unsigned>(
+                _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last))));
+            while (mask != 0) {
+                const char* candidate = position + __builtin_ctz(mask);
+                if (KeywordAt(candidate, rule)) {
+                    return candidate;
+                }
+                mask &= mask - 1;
+            }
+        }
+    }
+#endif
+    if (!rule.ignore_case) {
+        const void* match = ::memmem(position, static_cast<size_t>(end - position), rule.keyword.data(), length);
+        return match != nullptr ? static_cast<const char*>(match) : end;
+    }
+    for (; end - position >= static_cast<ptrdiff_t>(length); position++) {
+        if (KeywordAt(position, rule)) {
+            return position;
+        }
+    }
+    return end;
+}
+
+/**
+ * @brief 在 [begin, end) 内找第一条匹配的规则
+ *        from_chunk 为true时行位于当前读取块中，关键字位置沿用块内的扫描结果
+ */
+static const Rule* MatchRule(const char* begin, const char* end, const char* chunk_end, bool from_chunk) {
+    for (Rule& rule : g_rules) {
+        if (rule.pattern) {
+            if (std::regex_search(begin, end, *rule.pattern)) {
+                return &rule;
+            }
+            continue;
+        }
+        const char* match;
+        if (from_chunk) {
+            if (rule.next_match != chunk_end && rule.next_match < begin) {
+                rule.next_match = FindKeyword(begin, chunk_end, rule);
+            }
+            match = rule.next_match;
+        } else {
+            match = FindKeyword(begin, end, rule);
+        }
+        if (match < end) {
+            return &rule;
+        }
+    }
+    return nullptr;
+}
+
+static void EmitLine(ColorPrinter::Printer& printer, const Channel& channel,
+                     const char* begin, const char* end, const char* chunk_end, bool from_chunk) {
+    if (end > begin && end[-1] == '\r') {
+        end--;
+    }
+    const Rule* rule = MatchRule(begin, end, chunk_end, from_chunk);
+    const std::string_view line(begin, static_cast<size_t>(end - begin));
+    if (rule != nullptr) {
+        printer.PrintColoredMessage(rule->color, rule->type, line);
+    } else {
+        printer.PrintColoredMessage(channel.color, channel.type, line);
+    }
+}
+
+/**
+ * @brief 把一个读取块切分成行输出，末尾不完整的行留到下一块
+ */
+static void ProcessChunk(ColorPrinter::Printer& printer, Channel& channel, const char* data, size_t length) {
+    const char* const end = data + length;
+    for (Rule& rule : g_rules) {
+        rule.next_match = nullptr;
+    }
+    while (data < end) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', static_cast<size_t>(end - data)));
+        if (newline == nullptr) {
+            channel.partial.append(data, static_cast<size_t>(end - data));
+            return;
+        }
+        if (channel.partial.empty()) {
+            EmitLine(printer, channel, data, newline, end, true);
+        } else {
+            channel.partial.append(data, static_cast<size_t>(newline - data));
+            EmitLine(printer, channel, channel.partial.data(), channel.partial.data() + channel.partial.size(),
+                     nullptr, false);
+            channel.partial.clear();
+        }
+        data = newline + 1;
+    }
+}
+
+static bool AddRule(const char* spec, bool regex, bool ignore_case) {
+    const char* equals = std::strchr(spec, '=');
+    if (equals == nullptr || equals == spec || equals[1] == '\0') {
+        return false;
+    }
+    Rule rule;
+    rule.type.assign(spec, static_cast<size_t>(equals - spec));
+    rule.color = ColorPrinter::DefaultColorForLevel(ColorPrinter::LevelFromType(rule.type));
+    if (regex) {
+        try {
+            auto flags = std::regex::extended | std::regex::optimize;
+            if (ignore_case) {
+                flags |= std::regex::icase;
+            }
+            rule.pattern = std::make_unique<std::regex>(equals + 1, flags);
+        } catch (const std::regex_error&) {
+            return false;
+        }
+    } else {
+        rule.keyword = equals + 1;
+        rule.ignore_case = ignore_case;
+    }
+    g_rules.push_back(std::move(rule));
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    constexpr size_t kReadBytes = 1024 * 1024;
+    int colored = -1;
+    bool default_rules = true;
+    bool ignore_case = false;
+    std::vector<std::pair<const char*, bool>> rule_specs;
+    std::string stdout_type = "STDOUT";
+    std::string stderr_type = "STDERR";
+    int command_index = -1;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--") == 0) {
+            command_index = i + 1;
+            break;
+        } else if (std::strcmp(argv[i], "--keyword") == 0 && i + 1 < argc) {
+            rule_specs.emplace_back(argv[++i], false);
+        } else if (std::strcmp(argv[i], "--regex") == 0 && i + 1 < argc) {
+            rule_specs.emplace_back(argv[++i], true);
+        } else if (std::strcmp(argv[i], "--ignore-case") == 0) {
+            ignore_case = true;
+        } else if (std::strcmp(argv[i], "--no-default-rules") == 0) {
+            default_rules = false;
+        } else if (std::strcmp(argv[i], "--stdout-type") == 0 && i + 1 < argc) {
+            stdout_type = argv[++i];
+        } else if (std::strcmp(argv[i], "--stderr-type") == 0 && i + 1 < argc) {
+            stderr_type = argv[++i];
+        } else if (std::strcmp(argv[i], "--color") == 0) {
+            colored = 1;
+        } else if (std::strcmp(argv[i], "--no-color") == 0) {
+            colored = 0;
+        } else {
+            break;
+        }
+    }
+    if (command_index < 0 || command_index >= argc) {
+        std::fprintf(stderr,
+                     "用法: %s [--keyword 类型=关键字]... [--regex 类型=正则]... [--ignore-case] [--no-default-rules]\n"
+                     "          [--stdout-type 类型] [--stderr-type 类型] [--color|--no-color] -- 命令 [参数...]\n",
+                     argv[0]);
+        return 2;
+    }
+    for (const auto& [spec, regex] : rule_specs) {
+        if (!AddRule(spec, regex, ignore_case)) {
+            std::fprintf(stderr, "无效的规则: %s\n", spec);
+            return 2;
+        }
+    }
+    if (default_rules) {
+        AddRule("ERROR=error", false, true);
+        AddRule("WARNING=warn", false, true);
+    }
+    if (colored < 0) {
+        colored = isatty(STDOUT_FILENO) ? 1 : 0;
+    }
+
+    Channel channels[2];
+    int write_ends[2];
+    for (int i = 0; i < 2; i++) {
+        int fds[2];
+        if (::pipe2(fds, O_CLOEXEC) != 0) {
+            std::perror("pipe2");
+            return 1;
+        }
+        ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+        ::fcntl(fds[0], F_SETPIPE_SZ, static_cast<int>(kReadBytes));  // 失败时保留默认容量
+        channels[i].fd = fds[0];
+        write_ends[i] = fds[1];
+    }
+    channels[0].color = PrintColor::WHITE;
+    channels[0].type = stdout_type;
+    channels[1].color = PrintColor::RED;
+    channels[1].type = stderr_type;
+
+    const pid_t child = ::fork();
+    if (child < 0) {
+        std::perror("fork");
+        return 1;
+    }
+    if (child == 0) {
+        ::dup2(write_ends[0], STDOUT_FILENO);
+        ::dup2(write_ends[1], STDERR_FILENO);
+        ::execvp(argv[command_index], argv + command_index);
+        std::fprintf(stderr, "无法执行 %s: %s\n", argv[command_index], std::strerror(errno));
+        ::_exit(127);
+    }
+    g_child = child;
+    ::close(write_ends[0]);
+    ::close(write_ends[1]);
+
+    struct sigaction action = {};
+    action.sa_handler = ForwardSignal;
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+    ::sigaction(SIGHUP, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // 单独的打印器：批量写出，积压上限放大，读取线程只在输出端真正跟不上时才被阻塞
+    auto sink = std::make_shared<FdSink>(STDOUT_FILENO, colored != 0);
+    ColorPrinter::Printer printer{sink, {.deferred = true,
+                                         .batch_bytes = 1024 * 1024,
+                                         .max_pending_bytes = 64 * 1024 * 1024}};
+
+    const int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    for (int i = 0; i < 2; i++) {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u32 = static_cast<uint32_t>(i);
+        ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, channels[i].fd, &event);
+    }
+
+    std::unique_ptr<char[]> buffer(new char[kReadBytes]);
+    int open_channels = 2;
+    while (open_channels > 0) {
+        epoll_event events[2];
+        const int ready = ::epoll_wait(epoll_fd, events, 2, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        for (int e = 0; e < ready; e++) {
+            Channel& channel = channels[events[e].data.u32];
+            for (;;) {
+                const ssize_t length = ::read(channel.fd, buffer.get(), kReadBytes);
+                if (length > 0) {
+                    ProcessChunk(printer, channel, buffer.get(), static_cast<size_t>(length));
+                    if (static_cast<size_t>(length) < kReadBytes) {
+                        break;  // 管道已读空，回到 epoll 让两个管道轮流得到处理
+                    }
+                    continue;
+                }
+                if (length < 0 && (errno == EINTR)) {
+                    continue;
+                }
+                if (length == 0 || errno != EAGAIN) {
+                    if (!channel.partial.empty()) {
+                        EmitLine(printer, channel, channel.partial.data(),
+                                 channel.partial.data() + channel.partial.size(), nullptr, false);
+                        channel.partial.clear();
+                    }
+                    ::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, channel.fd, nullptr);
+                    ::close(channel.fd);
+                    channel.fd = -1;
+                    open_channels--;
+                }
+                break;
+            }
+        }
+    }
+    ::close(epoll_fd);
+    printer.Flush();
+
+    int status = 0;
+    while (::waitpid(child, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
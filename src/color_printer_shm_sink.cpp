@@ -0,0 +1,348 @@
+/**
+ * @file color_printer_shm_sink.cpp
+ * @brief 共享内存日志总线的实现
+ */
+
+#include "color_printer_shm_sink.h"
+
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "共享内存总线需要无锁的原子变量");
+
+namespace {
+
+constexpr uint64_t kAlignment = 8;
+
+uint64_t AlignUp(uint64_t value) {
+    return (value + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+void FutexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeout_ms) {
+    timespec timeout;
+    timeout.tv_sec = timeout_ms / 1000;
+    timeout.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000L;
+    // 共享内存跨进程，不能使用 FUTEX_PRIVATE_FLAG
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+}
+
+void FutexWake(std::atomic<uint32_t>* word) {
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief 跨进程可比较的单调时钟（毫秒）
+ */
+uint64_t MonotonicMs() {
+    timespec now;
+    ::clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<uint64_t>(now.tv_sec) * 1000 + static_cast<uint64_t>(now.tv_nsec) / 1000000;
+}
+
+void Heartbeat(ShmBusHeader* header) {
+    header->heartbeat_ms.store(MonotonicMs(), std::memory_order_relaxed);
+}
+
+/**
+ * @brief 收集端的心跳是否已经超时：它多半已被杀死，等下去不会有空间腾出来
+ */
+bool CollectorGone(const ShmBusHeader* header) {
+    const uint64_t heartbeat = header->heartbeat_ms.load(std::memory_order_relaxed);
+    const uint64_t now = MonotonicMs();
+    return now > heartbeat && now - heartbeat > ShmBusHeader::kCollectorTimeoutMs;
+}
+
+/**
+ * @brief 映射已存在的总线并检查格式
+ *
+ * @param mapped_bytes 输出映射的字节数
+ * @return 控制块；对象不存在或不是总线时返回空指针
+ */
+ShmBusHeader* MapExisting(const std::string& name, size_t& mapped_bytes) {
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) <= ShmBusHeader::kDataOffset) {
+        ::close(fd);
+        return nullptr;
+    }
+    void* mapping = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+    auto* header = static_cast<ShmBusHeader*>(mapping);
+    if (std::memcmp(header->magic, ShmBusHeader::kMagic, sizeof(header->magic)) != 0 ||
+        header->capacity + ShmBusHeader::kDataOffset != static_cast<uint64_t>(info.st_size)) {
+        ::munmap(mapping, static_cast<size_t>(info.st_size));
+        return nullptr;
+    }
+    mapped_bytes = static_cast<size_t>(info.st_size);
+    return header;
+}
+
+} // namespace
+
+ShmBusSink::ShmBusSink(const std::string& name, bool block_when_full)
+    : name_(name), block_when_full_(block_when_full) {
+    Attach();
+}
+
+ShmBusSink::~ShmBusSink() {
+    for (const std::unique_ptr<Bus>& bus : buses_) {
+        ::munmap(bus->header, bus->mapped_bytes);
+    }
+}
+
+/**
+ * @brief 重新打开同名总线；调用方持有 attach_mutex_（构造时除外）
+ */
+void ShmBusSink::Attach() {
+    size_t mapped_bytes = 0;
+    ShmBusHeader* header = MapExisting(name_, mapped_bytes);
+    if (header != nullptr && header->retired.load(std::memory_order_acquire) != 0) {
+        ::munmap(header, mapped_bytes);
+        header = nullptr;
+    }
+    if (header == nullptr) {
+        bus_.store(nullptr, std::memory_order_release);
+        return;
+    }
+    buses_.push_back(std::make_unique<Bus>(
+        Bus{header, reinterpret_cast<char*>(header) + ShmBusHeader::kDataOffset, header->capacity, mapped_bytes}));
+    bus_.store(buses_.back().get(), std::memory_order_release);
+}
+
+ShmBusSink::Bus* ShmBusSink::CurrentBus() {
+    Bus* bus = bus_.load(std::memory_order_acquire);
+    if (bus != nullptr && bus->header->retired.load(std::memory_order_relaxed) == 0) {
+        return bus;
+    }
+    // 未连接或总线已被移除：限速重新连接，其余线程不等待，直接退回标准输出
+    const uint64_t now = MonotonicMs();
+    uint64_t next = next_attach_ms_.load(std::memory_order_relaxed);
+    if (now >= next && next_attach_ms_.compare_exchange_strong(next, now + kAttachIntervalMs)) {
+        std::lock_guard<std::mutex> lock(attach_mutex_);
+        Attach();
+    }
+    bus = bus_.load(std::memory_order_acquire);
+    return bus != nullptr && bus->header->retired.load(std::memory_order_relaxed) == 0 ? bus : nullptr;
+}
+
+void ShmBusSink::Write(const LogRecord* records, size_t count) {
+    Bus* bus = CurrentBus();
+    if (bus == nullptr) {
+        // 收集端未启动：整批直接写标准输出（此时 WantsColor 为true，行已带颜色代码）
+        fallback_.Write(records, count);
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        Append(*bus, records[i]);
+    }
+}
+
+bool ShmBusSink::WritesToFd(int fd) const {
+    return !IsOpen() && fd == STDOUT_FILENO;
+}
+
+/**
+ * @brief 预留一条记录的空间（必要时连同数据区末尾的填充），写入后提交
+ *        预留只是一次 CAS；只有收集端在休眠时才发起一次 futex 唤醒
+ */
+void ShmBusSink::Append(Bus& bus, const LogRecord& record) {
+    ShmBusHeader* header = bus.header;
+    const uint64_t capacity = bus.capacity;
+    const uint64_t length = sizeof(ShmRecordHeader) + record.line.size();
+    const uint64_t aligned = AlignUp(length);
+    if (aligned > capacity / 2 || length > ShmRecordHeader::kLengthMask) {
+        header->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    uint64_t head = header->head.load(std::memory_order_relaxed);
+    uint64_t padding;
+    for (unsigned spins = 0;; spins++) {
+        const uint64_t offset = head % capacity;
+        padding = capacity - offset < aligned ? capacity - offset : 0;
+        const uint64_t tail = header->tail.load(std::memory_order_acquire);
+        if (head + padding + aligned - tail > capacity) {
+            if (!block_when_full_ || CollectorGone(header) || header->retired.load(std::memory_order_relaxed) != 0) {
+                header->dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            if (spins < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            head = header->head.load(std::memory_order_relaxed);
+            continue;
+        }
+        if (header->head.compare_exchange_weak(head, head + padding + aligned, std::memory_order_acq_rel,
+                                               std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    if (padding > 0) {
+        auto* pad = reinterpret_cast<ShmRecordHeader*>(bus.data + head % capacity);
+        pad->state.store(static_cast<uint32_t>(padding) | ShmRecordHeader::kPadding, std::memory_order_release);
+        head += padding;
+    }
+    auto* slot = reinterpret_cast<ShmRecordHeader*>(bus.data + head % capacity);
+    slot->state.store(static_cast<uint32_t>(length) | ShmRecordHeader::kBusy, std::memory_order_relaxed);
+    slot->color = static_cast<uint8_t>(record.color);
+    slot->level = static_cast<uint8_t>(record.level);
+    std::memcpy(reinterpret_cast<char*>(slot) + sizeof(ShmRecordHeader), record.line.data(), record.line.size());
+    slot->state.store(static_cast<uint32_t>(length), std::memory_order_seq_cst);
+
+    if (header->collector_waiting.load(std::memory_order_seq_cst) != 0 &&
+        header->collector_waiting.exchange(0, std::memory_order_seq_cst) != 0) {
+        header->wake_seq.fetch_add(1, std::memory_order_seq_cst);
+        FutexWake(&header->wake_seq);
+    }
+}
+
+ShmBusHeader* ShmBusSink::Create(const std::string& name, uint64_t capacity) {
+    capacity = (capacity + 4095) & ~uint64_t(4095);
+    if (capacity == 0) {
+        return nullptr;
+    }
+    size_t existing_bytes = 0;
+    if (ShmBusHeader* existing = MapExisting(name, existing_bytes)) {
+        if (existing->capacity == capacity && existing->retired.load(std::memory_order_acquire) == 0) {
+            // 上一个收集端的心跳停止后接管：保留未取出的记录，已连接的生产者继续写入
+            const uint64_t deadline = MonotonicMs() + ShmBusHeader::kCollectorTimeoutMs + 500;
+            while (!CollectorGone(existing) && MonotonicMs() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+            if (!CollectorGone(existing)) {
+                ::munmap(existing, existing_bytes);
+                return nullptr;  // 另一个收集端仍在运行
+            }
+            existing->collector_waiting.store(0, std::memory_order_relaxed);
+            Heartbeat(existing);
+            return existing;
+        }
+        // 容量不同：通知已连接的生产者重新连接，再新建
+        existing->retired.store(1, std::memory_order_release);
+        ::munmap(existing, existing_bytes);
+    }
+    // 新建对象而不是截断旧对象：仍映射着旧对象的生产者不会收到 SIGBUS
+    ::shm_unlink(name.c_str());
+    const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0660);
+    if (fd < 0) {
+        return nullptr;
+    }
+    const uint64_t total = ShmBusHeader::kDataOffset + capacity;
+    if (::ftruncate(fd, static_cast<off_t>(total)) != 0) {
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return nullptr;
+    }
+    void* mapping = ::mmap(nullptr, static_cast<size_t>(total), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        return nullptr;
+    }
+    auto* header = static_cast<ShmBusHeader*>(mapping);
+    header->capacity = capacity;
+    header->head.store(0, std::memory_order_relaxed);
+    header->tail.store(0, std::memory_order_relaxed);
+    header->dropped.store(0, std::memory_order_relaxed);
+    header->resync_bytes.store(0, std::memory_order_relaxed);
+    header->collector_waiting.store(0, std::memory_order_relaxed);
+    header->wake_seq.store(0, std::memory_order_relaxed);
+    header->retired.store(0, std::memory_order_relaxed);
+    Heartbeat(header);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, ShmBusHeader::kMagic, sizeof(header->magic));
+    return header;
+}
+
+void ShmBusSink::Remove(const std::string& name, ShmBusHeader* header) {
+    if (header == nullptr) {
+        return;
+    }
+    header->retired.store(1, std::memory_order_release);
+    ::shm_unlink(name.c_str());
+    Unmap(header);
+}
+
+void ShmBusSink::Unmap(ShmBusHeader* header) {
+    if (header != nullptr) {
+        ::munmap(header, static_cast<size_t>(ShmBusHeader::kDataOffset + header->capacity));
+    }
+}
+
+size_t ShmBusSink::Drain(ShmBusHeader* header, uint64_t max_bytes, uint64_t stuck_head,
+                         const std::function<void(PrintColor, LogLevel, std::string_view)>& on_record) {
+    Heartbeat(header);
+    char* data = reinterpret_cast<char*>(header) + ShmBusHeader::kDataOffset;
+    const uint64_t capacity = header->capacity;
+    const uint64_t start = header->tail.load(std::memory_order_relaxed);
+    const uint64_t head = header->head.load(std::memory_order_acquire);
+    uint64_t tail = start;
+    size_t records = 0;
+    while (tail != head && tail - start < max_bytes) {
+        auto* record = reinterpret_cast<ShmRecordHeader*>(data + tail % capacity);
+        const uint32_t state = record->state.load(std::memory_order_acquire);
+        if (state == 0) {
+            if (stuck_head == kNotStuck || stuck_head <= tail || stuck_head > head) {
+                break;  // 已预留，生产者尚未写入记录头
+            }
+            // 生产者在预留后、写入记录头前退出，记录长度未知：跳到停滞开始时的 head（必为记录边界）
+            header->dropped.fetch_add(1, std::memory_order_relaxed);
+            header->resync_bytes.fetch_add(stuck_head - tail, std::memory_order_relaxed);
+            tail = stuck_head;
+            stuck_head = kNotStuck;  // 每次最多跳过一处
+            continue;
+        }
+        const uint64_t length = state & ShmRecordHeader::kLengthMask;
+        if ((state & ShmRecordHeader::kBusy) != 0) {
+            if (stuck_head == kNotStuck) {
+                break;  // 生产者尚未写完
+            }
+            header->dropped.fetch_add(1, std::memory_order_relaxed);
+        } else if ((state & ShmRecordHeader::kPadding) == 0) {
+            on_record(static_cast<PrintColor>(record->color), static_cast<LogLevel>(record->level),
+                      std::string_view(reinterpret_cast<const char*>(record) + sizeof(ShmRecordHeader),
+                                       length - sizeof(ShmRecordHeader)));
+            records++;
+        }
+        tail += AlignUp(length);
+        stuck_head = kNotStuck;  // 每次最多跳过一处
+    }
+    if (tail != start) {
+        // 清零后归还：下一圈的记录头可能落在这段区域的任意8字节边界上
+        const uint64_t offset = start % capacity;
+        const uint64_t length = tail - start;
+        const uint64_t first = std::min(length, capacity - offset);
+        std::memset(data + offset, 0, first);
+        std::memset(data, 0, length - first);
+        header->tail.store(tail, std::memory_order_release);
+    }
+    return records;
+}
+
+void ShmBusSink::WaitForData(ShmBusHeader* header, int timeout_ms) {
+    const uint32_t seq = header->wake_seq.load(std::memory_order_seq_cst);
+    header->collector_waiting.store(1, std::memory_order_seq_cst);
+    if (header->head.load(std::memory_order_seq_cst) == header->tail.load(std::memory_order_relaxed)) {
+        FutexWait(&header->wake_seq, seq, timeout_ms);
+    }
+    header->collector_waiting.store(0, std::memory_order_relaxed);
+    Heartbeat(header);
+}
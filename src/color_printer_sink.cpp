@@ -0,0 +1,145 @@
+/**
+ * @file color_printer_sink.cpp
+ * @brief 输出端的实现
+ */
+
+#include "color_printer_sink.h"
+#include "color_printer_internal.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace color_printer_detail {
+
+bool WriteAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = ::write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool WriteVAll(int fd, iovec* segments, int count) {
+    while (count > 0) {
+        ssize_t written = ::writev(fd, segments, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        size_t remaining = static_cast<size_t>(written);
+        while (count > 0 && remaining >= segments->iov_len) {
+            remaining -= segments->iov_len;
+            segments++;
+            count--;
+        }
+        if (count > 0) {
+            segments->iov_base = static_cast<char*>(segments->iov_base) + remaining;
+            segments->iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 行 a 与其后的行 b 之间的重置代码与颜色代码是否可以省去
+ */
+static bool SameEscapes(const LogRecord& a, const LogRecord& b) {
+    if (a.escape_head == 0 || a.escape_tail == 0 || a.escape_head != b.escape_head || b.escape_tail == 0 ||
+        std::memcmp(a.line.data(), b.line.data(), a.escape_head) != 0) {
+        return false;
+    }
+    // 正文里自带转义序列时，行尾的状态不一定等于行首的颜色，保留重置代码
+    const size_t body = a.line.size() - a.escape_head - a.escape_tail - 1;
+    return std::memchr(a.line.data() + a.escape_head, '\033', body) == nullptr;
+}
+
+size_t AppendLinesMinimalEscapes(std::string& out, const LogRecord* records, size_t count) {
+    size_t saved = 0;
+    bool open = false;  // 上一行的颜色仍然有效
+    for (size_t i = 0; i < count; i++) {
+        const LogRecord& record = records[i];
+        const std::string_view line = record.line;
+        const bool keep_open = i + 1 < count && SameEscapes(record, records[i + 1]);
+        const size_t head = open ? record.escape_head : 0;
+        if (keep_open) {
+            out.append(line.data() + head, line.size() - head - record.escape_tail - 1);
+            out += '\n';
+            saved += head + record.escape_tail;
+        } else {
+            out.append(line.data() + head, line.size() - head);
+            saved += head;
+        }
+        open = keep_open;
+    }
+    return saved;
+}
+
+} // namespace color_printer_detail
+
+FdSink::FdSink(int fd, bool colored)
+    : fd_(fd), colored_(colored) {
+}
+
+std::shared_ptr<LogSink> FdSink::RebindFd(int from_fd, int to_fd) const {
+    return std::make_shared<FdSink>(from_fd == fd_ ? to_fd : fd_, colored_);
+}
+
+/**
+ * @brief 写出一批消息
+ *        带颜色时拼接到一个缓冲区并省去相邻同色行之间多余的颜色代码；
+ *        不带颜色时内存中相邻的行合并成一段，多段时用 writev 一次提交
+ */
+void FdSink::Write(const LogRecord* records, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (fd_ == STDOUT_FILENO) {
+        std::cout.flush();  // 保持与调用者自己的 std::cout 输出的先后顺序
+    }
+
+    if (colored_ && count > 1) {
+        thread_local std::string buffer;
+        buffer.clear();
+        const size_t saved = color_printer_detail::AppendLinesMinimalEscapes(buffer, records, count);
+        escape_bytes_saved_.fetch_add(saved, std::memory_order_relaxed);
+        color_printer_detail::WriteAll(fd_, buffer.data(), buffer.size());
+        return;
+    }
+
+    constexpr int kMaxSegments = IOV_MAX < 1024 ? IOV_MAX : 1024;
+    iovec segments[kMaxSegments];
+    int used = 0;
+    for (size_t i = 0; i < count; i++) {
+        const std::string_view line = records[i].line;
+        if (used > 0) {
+            iovec& last = segments[used - 1];
+            if (static_cast<const char*>(last.iov_base) + last.iov_len == line.data()) {
+                last.iov_len += line.size();
+                continue;
+            }
+        }
+        if (used == kMaxSegments) {
+            color_printer_detail::WriteVAll(fd_, segments, used);
+            used = 0;
+        }
+        segments[used++] = {const_cast<char*>(line.data()), line.size()};
+    }
+    if (used == 1) {
+        color_printer_detail::WriteAll(fd_, static_cast<const char*>(segments[0].iov_base), segments[0].iov_len);
+    } else {
+        color_printer_detail::WriteVAll(fd_, segments, used);
+    }
+}
@@ -0,0 +1,130 @@
+/**
+ * @file color_printer_snapshot.h
+ * @brief 无锁读取、可热更新的不可变快照（库内部使用，不安装）
+ */
+
+#ifndef COLOR_PRINTER_SNAPSHOT_H
+#define COLOR_PRINTER_SNAPSHOT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace color_printer_detail {
+
+/**
+ * @brief 当前线程使用的读者计数分片下标
+ */
+unsigned ThreadReaderShard();
+
+/**
+ * @class SnapshotCell
+ * @brief 通过原子指针发布的不可变快照
+ *        读者：在本线程的计数分片上登记当前纪元后读取一次指针，不加锁、不阻塞
+ *        写者：交换指针后两次翻转纪元，依次等待两个奇偶纪元上的读者计数归零（宽限期），
+ *              然后释放旧快照；等待只发生在写者一侧，不会阻塞正在打印的线程
+ *
+ *        计数按线程分片并按缓存行对齐，读者之间不共享缓存行
+ */
+template <typename T>
+class SnapshotCell {
+public:
+    static constexpr unsigned kShards = 64;
+
+    /**
+     * @class ReadGuard
+     * @brief 读者登记，存活期间快照不会被释放
+     */
+    class ReadGuard {
+    public:
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        ~ReadGuard() {
+            counter_->fetch_sub(1, std::memory_order_release);
+        }
+
+        const T* operator->() const { return snapshot_; }
+        const T& operator*() const { return *snapshot_; }
+
+    private:
+        friend class SnapshotCell;
+
+        ReadGuard(std::atomic<uint64_t>* counter, const T* snapshot)
+            : counter_(counter), snapshot_(snapshot) {}
+
+        std::atomic<uint64_t>* counter_;
+        const T* snapshot_;
+    };
+
+    explicit SnapshotCell(std::unique_ptr<const T> initial)
+        : current_(initial.release()) {}
+
+    ~SnapshotCell() {
+        delete current_.load(std::memory_order_acquire);
+    }
+
+    SnapshotCell(const SnapshotCell&) = delete;
+    SnapshotCell& operator=(const SnapshotCell&) = delete;
+
+    ReadGuard Read() const {
+        Shard& shard = shards_[ThreadReaderShard() % kShards];
+        const uint64_t parity = epoch_.load(std::memory_order_seq_cst) & 1;
+        std::atomic<uint64_t>* counter = &shard.readers[parity];
+        counter->fetch_add(1, std::memory_order_seq_cst);
+        return ReadGuard(counter, current_.load(std::memory_order_seq_cst));
+    }
+
+    /**
+     * @brief 发布新快照，等待宽限期结束后释放旧快照
+     *        多个写者之间串行执行
+     */
+    void Publish(std::unique_ptr<const T> next) {
+        std::lock_guard<std::mutex> writer_lock(writer_mutex_);
+        const T* previous = current_.exchange(next.release(), std::memory_order_seq_cst);
+        Synchronize();
+        delete previous;
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> readers[2] = {0, 0};
+    };
+
+    /**
+     * @brief 等待所有可能持有旧快照的读者离开
+     *        翻转两次纪元，覆盖“读取纪元后被抢占、稍后才登记”的读者
+     */
+    void Synchronize() {
+        for (int phase = 0; phase < 2; phase++) {
+            const uint64_t parity = epoch_.fetch_add(1, std::memory_order_seq_cst) & 1;
+            for (unsigned spins = 0; ReaderCount(parity) != 0; spins++) {
+                if (spins < 64) {
+                    std::this_thread::yield();
+                } else {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        }
+    }
+
+    uint64_t ReaderCount(uint64_t parity) const {
+        uint64_t total = 0;
+        for (const Shard& shard : shards_) {
+            total += shard.readers[parity].load(std::memory_order_seq_cst);
+        }
+        return total;
+    }
+
+    std::atomic<const T*> current_;
+    std::atomic<uint64_t> epoch_{0};
+    mutable Shard shards_[kShards];
+    std::mutex writer_mutex_;
+};
+
+} // namespace color_printer_detail
+
+#endif // COLOR_PRINTER_SNAPSHOT_H
@@ -0,0 +1,84 @@
+/**
+ * @file color_printer_stream.cpp
+ * @brief ColorPrinter::Stream 的实现
+ */
+
+#include "color_printer.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr size_t kInitialBufferBytes = 4096;
+
+} // namespace
+
+ColorPrinter::Stream::Stream(PrintColor color, std::string type)
+    : Stream(Default(), color, std::move(type)) {}
+
+ColorPrinter::Stream::Stream(Printer& printer, PrintColor color, std::string type)
+    : std::ostream(nullptr), buffer_(printer, color, std::move(type)) {
+    rdbuf(&buffer_);
+}
+
+ColorPrinter::Stream::~Stream() {
+    buffer_.EmitPartial();
+}
+
+/**
+ * @brief 不设放置区：每次写入都经过 overflow / xsputn，遇到 '\n' 时立即输出完整的行
+ */
+ColorPrinter::Stream::LineBuffer::LineBuffer(Printer& printer, PrintColor color, std::string type)
+    : printer_(printer), color_(color), type_(std::move(type)) {
+    pending_.reserve(kInitialBufferBytes);
+}
+
+/**
+ * @brief 写入单个字符（std::endl、put 以及数值格式化逐字符写入时）
+ */
+ColorPrinter::Stream::LineBuffer::int_type ColorPrinter::Stream::LineBuffer::overflow(int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+        return traits_type::not_eof(c);
+    }
+    const char ch = traits_type::to_char_type(c);
+    if (ch == '\n') {
+        printer_.Emit(color_, type_, pending_);
+        pending_.clear();
+    } else {
+        pending_.push_back(ch);
+    }
+    return c;
+}
+
+/**
+ * @brief 写入一段字符：其中每个完整的行立即输出，末尾不完整的部分留到下次
+ *        没有积累内容时直接输出调用方的数据，不经过拷贝
+ */
+std::streamsize ColorPrinter::Stream::LineBuffer::xsputn(const char* data, std::streamsize count) {
+    const char* start = data;
+    const char* const end = data + count;
+    while (start < end) {
+        const char* newline = static_cast<const char*>(std::memchr(start, '\n', static_cast<size_t>(end - start)));
+        if (newline == nullptr) {
+            pending_.append(start, static_cast<size_t>(end - start));
+            break;
+        }
+        const std::string_view line(start, static_cast<size_t>(newline - start));
+        if (pending_.empty()) {
+            printer_.Emit(color_, type_, line);
+        } else {
+            pending_.append(line);
+            printer_.Emit(color_, type_, pending_);
+            pending_.clear();
+        }
+        start = newline + 1;
+    }
+    return count;
+}
+
+void ColorPrinter::Stream::LineBuffer::EmitPartial() {
+    if (!pending_.empty()) {
+        printer_.Emit(color_, type_, pending_);
+        pending_.clear();
+    }
+}
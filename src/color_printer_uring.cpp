@@ -0,0 +1,213 @@
+/**
+ * @file color_printer_uring.cpp
+ * @brief io_uring 写入封装的实现
+ */
+
+#include "color_printer_uring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/uio.h>
+
+#ifdef COLOR_PRINTER_HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace color_printer_detail {
+
+#ifdef COLOR_PRINTER_HAVE_IO_URING
+
+namespace {
+
+int SysSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int SysEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int SysRegister(int fd, unsigned opcode, const void* arg, unsigned count) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+unsigned LoadAcquire(const unsigned* value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+void StoreRelease(unsigned* value, unsigned desired) {
+    __atomic_store_n(value, desired, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+T* At(void* base, uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+} // namespace
+
+std::unique_ptr<UringWriter> UringWriter::Create(unsigned entries, const std::vector<iovec>& buffers) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    const int ring_fd = SysSetup(entries, &params);
+    if (ring_fd < 0) {
+        return nullptr;  // ENOSYS、EPERM（例如被 seccomp 禁止）等
+    }
+
+    std::unique_ptr<UringWriter> writer(new UringWriter());
+    writer->ring_fd_ = ring_fd;
+    writer->sq_ring_bytes_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    writer->cq_ring_bytes_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        writer->sq_ring_bytes_ = writer->cq_ring_bytes_ = std::max(writer->sq_ring_bytes_, writer->cq_ring_bytes_);
+    }
+
+    void* sq_ring = ::mmap(nullptr, writer->sq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        return nullptr;
+    }
+    writer->sq_ring_ = sq_ring;
+    void* cq_ring = sq_ring;
+    if (!single_mmap) {
+        cq_ring = ::mmap(nullptr, writer->cq_ring_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            return nullptr;
+        }
+        writer->cq_ring_ = cq_ring;
+    }
+    writer->sqes_bytes_ = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, writer->sqes_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return nullptr;
+    }
+    writer->sqes_ = sqes;
+
+    writer->sq_head_ = At<unsigned>(sq_ring, params.sq_off.head);
+    writer->sq_tail_ = At<unsigned>(sq_ring, params.sq_off.tail);
+    writer->sq_array_ = At<unsigned>(sq_ring, params.sq_off.array);
+    writer->sq_mask_ = *At<unsigned>(sq_ring, params.sq_off.ring_mask);
+    writer->sq_entries_ = params.sq_entries;
+    writer->cq_head_ = At<unsigned>(cq_ring, params.cq_off.head);
+    writer->cq_tail_ = At<unsigned>(cq_ring, params.cq_off.tail);
+    writer->cq_mask_ = *At<unsigned>(cq_ring, params.cq_off.ring_mask);
+    writer->cqes_ = At<void>(cq_ring, params.cq_off.cqes);
+
+    if (!buffers.empty()) {
+        writer->fixed_buffers_ = SysRegister(ring_fd, IORING_REGISTER_BUFFERS, buffers.data(),
+                                             static_cast<unsigned>(buffers.size())) == 0;
+    }
+    return writer;
+}
+
+UringWriter::~UringWriter() {
+    if (sqes_ != nullptr) {
+        ::munmap(sqes_, sqes_bytes_);
+    }
+    if (cq_ring_ != nullptr) {
+        ::munmap(cq_ring_, cq_ring_bytes_);
+    }
+    if (sq_ring_ != nullptr) {
+        ::munmap(sq_ring_, sq_ring_bytes_);
+    }
+    if (ring_fd_ >= 0) {
+        ::close(ring_fd_);
+    }
+}
+
+bool UringWriter::QueueWrite(int fd, const char* data, uint32_t length, uint64_t offset,
+                             int buffer_index, uint64_t tag, bool link) {
+    const unsigned tail = *sq_tail_;
+    if (tail - LoadAcquire(sq_head_) >= sq_entries_) {
+        return false;
+    }
+    const unsigned index = tail & sq_mask_;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    const bool fixed = fixed_buffers_ && buffer_index >= 0;
+    sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(data);
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->buf_index = fixed ? static_cast<uint16_t>(buffer_index) : 0;
+    sqe->flags = link ? IOSQE_IO_LINK : 0;
+    sqe->user_data = tag;
+    sq_array_[index] = index;
+    StoreRelease(sq_tail_, tail + 1);
+    to_submit_++;
+    in_flight_++;
+    return true;
+}
+
+void UringWriter::Submit() {
+    while (to_submit_ > 0) {
+        const int submitted = SysEnter(ring_fd_, to_submit_, 0, 0);
+        if (submitted < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            return;
+        }
+        if (submitted == 0) {
+            return;  // 内核这次一项也没有接收，留到下次 Submit/Reap 再提交，不空转
+        }
+        to_submit_ -= std::min(static_cast<unsigned>(submitted), to_submit_);
+    }
+}
+
+size_t UringWriter::Reap(unsigned wait_min, const std::function<void(uint64_t tag, int result)>& on_complete) {
+    if (wait_min > 0 && LoadAcquire(cq_tail_) == *cq_head_) {
+        int submitted;
+        while ((submitted = SysEnter(ring_fd_, to_submit_, wait_min, IORING_ENTER_GETEVENTS)) < 0 && errno == EINTR) {
+        }
+        if (submitted > 0) {
+            // 返回值是本次提交的项数，可能少于 to_submit_；未提交的留给下一次
+            to_submit_ -= std::min(static_cast<unsigned>(submitted), to_submit_);
+        }
+    }
+    size_t reaped = 0;
+    unsigned head = *cq_head_;
+    const unsigned tail = LoadAcquire(cq_tail_);
+    while (head != tail) {
+        const io_uring_cqe& cqe = static_cast<const io_uring_cqe*>(cqes_)[head & cq_mask_];
+        const uint64_t tag = cqe.user_data;
+        const int result = cqe.res;
+        head++;
+        StoreRelease(cq_head_, head);
+        in_flight_--;
+        reaped++;
+        on_complete(tag, result);
+    }
+    return reaped;
+}
+
+#else // !COLOR_PRINTER_HAVE_IO_URING
+
+std::unique_ptr<UringWriter> UringWriter::Create(unsigned, const std::vector<iovec>&) {
+    return nullptr;
+}
+
+UringWriter::~UringWriter() = default;
+
+bool UringWriter::QueueWrite(int, const char*, uint32_t, uint64_t, int, uint64_t, bool) {
+    return false;
+}
+
+void UringWriter::Submit() {
+}
+
+size_t UringWriter::Reap(unsigned, const std::function<void(uint64_t, int)>&) {
+    return 0;
+}
+
+#endif // COLOR_PRINTER_HAVE_IO_URING
+
+} // namespace color_printer_detail
@@ -0,0 +1,104 @@
+/**
+ * @file color_printer_uring.h
+ * @brief 基于原始系统调用的最小 io_uring 写入封装（库内部使用，不安装）
+ */
+
+#ifndef COLOR_PRINTER_URING_H
+#define COLOR_PRINTER_URING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct iovec;
+
+namespace color_printer_detail {
+
+/**
+ * @class UringWriter
+ * @brief 单线程使用的 io_uring 写请求队列
+ *        支持注册缓冲区（WRITE_FIXED）与链接请求（IOSQE_IO_LINK）；
+ *        编译时没有 <linux/io_uring.h> 或运行时内核不支持时 Create 返回空指针，调用方回退到 write
+ */
+class UringWriter {
+public:
+    /**
+     * @brief 创建 io_uring 实例并尽量注册缓冲区
+     *
+     * @param entries 提交队列深度
+     * @param buffers 要注册的缓冲区；注册失败（例如超出 RLIMIT_MEMLOCK）时退化为普通 WRITE 请求
+     * @return 不可用时返回空指针
+     */
+    static std::unique_ptr<UringWriter> Create(unsigned entries, const std::vector<iovec>& buffers);
+
+    ~UringWriter();
+
+    UringWriter(const UringWriter&) = delete;
+    UringWriter& operator=(const UringWriter&) = delete;
+
+    /**
+     * @brief 在提交队列中放入一个写请求（尚未提交给内核）
+     *
+     * @param buffer_index 注册缓冲区下标，-1 表示不使用注册缓冲区
+     * @param link 是否与下一个请求链接（下一个请求在本请求完成后才执行，本请求失败时被取消）
+     * @return 提交队列已满时返回false
+     */
+    bool QueueWrite(int fd, const char* data, uint32_t length, uint64_t offset,
+                    int buffer_index, uint64_t tag, bool link);
+
+    /**
+     * @brief 把队列中的请求提交给内核
+     *        内核只接收一部分时继续提交剩余的；一项也不接收时返回，剩余的留到下次 Submit/Reap
+     */
+    void Submit();
+
+    /**
+     * @brief 收割完成事件
+     *
+     * @param wait_min 至少等待的完成事件个数，0 表示不阻塞
+     * @param on_complete 回调，参数为请求的 tag 与结果（写入字节数或负的 errno）
+     * @return 收割的事件个数
+     */
+    size_t Reap(unsigned wait_min, const std::function<void(uint64_t tag, int result)>& on_complete);
+
+    /**
+     * @brief 已放入但尚未完成的请求个数
+     */
+    unsigned InFlight() const { return in_flight_; }
+
+    /**
+     * @brief 是否成功注册了缓冲区
+     */
+    bool HasFixedBuffers() const { return fixed_buffers_; }
+
+private:
+    UringWriter() = default;
+
+    int ring_fd_ = -1;
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    void* sqes_ = nullptr;
+    size_t sq_ring_bytes_ = 0;
+    size_t cq_ring_bytes_ = 0;
+    size_t sqes_bytes_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    void* cqes_ = nullptr;
+
+    unsigned to_submit_ = 0;
+    unsigned in_flight_ = 0;
+    bool fixed_buffers_ = false;
+};
+
+} // namespace color_printer_detail
+
+#endif // COLOR_PRINTER_URING_H
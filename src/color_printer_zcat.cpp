@@ -0,0 +1,72 @@
+//
+// 压缩日志文件读取工具：并行解压 CompressedFileSink 写入的文件并逐块输出，可输出压缩统计
+//
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <vector>
+#include "color_printer.h"
+#include "color_printer_compressed_sink.h"
+
+
+int main(int argc, char *argv[])
+{
+    unsigned threads = 0;
+    bool stats = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == nullptr) {
+        std::fprintf(stderr, "用法: %s [--threads 线程数] [--stats] <压缩日志文件>\n", argv[0]);
+        return 2;
+    }
+
+    if (stats) {
+        std::vector<CompressedBlockHeader> blocks;
+        uint64_t valid_bytes = 0;
+        if (!CompressedFileSink::ReadBlockIndex(path, blocks, &valid_bytes)) {
+            ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无法读取压缩日志文件: %s", path);
+            return 1;
+        }
+        uint64_t raw_bytes = 0;
+        for (const CompressedBlockHeader& block : blocks) {
+            raw_bytes += block.raw_bytes;
+        }
+        const double ratio = valid_bytes == 0 ? 0.0 : static_cast<double>(raw_bytes) / valid_bytes;
+        std::printf("块数: %zu\n原始字节: %llu\n文件字节: %llu\n压缩比: %.2f\n", blocks.size(),
+                    static_cast<unsigned long long>(raw_bytes), static_cast<unsigned long long>(valid_bytes), ratio);
+        return 0;
+    }
+
+    // 逐块写出，内存占用与文件大小无关
+    const bool ok = CompressedFileSink::Decompress(path, [](std::string_view block) {
+        size_t offset = 0;
+        while (offset < block.size()) {
+            const ssize_t written = ::write(STDOUT_FILENO, block.data() + offset, block.size() - offset);
+            if (written < 0 && errno == EINTR) {
+                continue;
+            }
+            if (written <= 0) {
+                return false;
+            }
+            offset += static_cast<size_t>(written);
+        }
+        return true;
+    }, threads);
+    if (!ok) {
+        ColorPrinter::PrintColoredMessage(PrintColor::RED, "ERROR", "无法解压压缩日志文件: %s", path);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file test_async_resume.cpp
+ * @brief 协程可等待对象的测试
+ *        回归：队列满时挂起的协程若在输出线程上恢复，协程里紧接着的阻塞式打印会等待输出线程自己腾出空间而死锁
+ */
+
+#include <atomic>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "color_printer.h"
+#include "test_common.h"
+
+using namespace color_printer_test;
+
+namespace {
+
+/**
+ * @brief 4 个生产者持续填满很小的队列，同时一个协程先 co_await PrintAsync 再阻塞式打印
+ */
+void TestResumeNeverOnWriterThread() {
+    auto sink = std::make_shared<MemorySink>(false, std::chrono::microseconds(200));
+    ColorPrinter::Printer printer{sink, {.deferred = true, .max_pending_bytes = 4096}};
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> producers;
+    for (int i = 0; i < 4; i++) {
+        producers.emplace_back([&printer, &stop, i] {
+            const std::string text(100, static_cast<char>('a' + i));
+            while (!stop.load(std::memory_order_relaxed)) {
+                printer.PrintColoredMessage(PrintColor::WHITE, "INFO", text);
+            }
+        });
+    }
+
+    std::promise<void> finished;
+    auto coroutine = [](ColorPrinter::Printer& p, std::promise<void>& done) -> DetachedTask {
+        for (int round = 0; round < 50; round++) {
+            co_await p.PrintAsync(PrintColor::GREEN, "INFO", "coroutine async " + std::to_string(round));
+            p.PrintColoredMessage(PrintColor::GREEN, "INFO", "coroutine sync " + std::to_string(round));
+        }
+        done.set_value();
+    };
+
+    RunWithTimeout(std::chrono::seconds(5), [&] {
+        coroutine(printer, finished);
+        finished.get_future().wait();
+    });
+
+    stop = true;
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+    printer.Flush();
+
+    size_t async_lines = 0;
+    size_t sync_lines = 0;
+    for (const std::string& line : sink->Lines()) {
+        async_lines += line.find("coroutine async") != std::string::npos;
+        sync_lines += line.find("coroutine sync") != std::string::npos;
+    }
+    CHECK_EQ(async_lines, 50u);
+    CHECK_EQ(sync_lines, 50u);
+}
+
+/**
+ * @brief FlushAsync 恢复时，之前提交的消息都已交给输出端，且先后顺序不变
+ */
+void TestFlushAsyncOrdering() {
+    auto sink = std::make_shared<MemorySink>(false, std::chrono::microseconds(100));
+    ColorPrinter::Printer printer{sink, {.deferred = true, .max_pending_bytes = 1024}};
+
+    std::promise<size_t> seen;
+    auto coroutine = [](ColorPrinter::Printer& p, MemorySink& s, std::promise<size_t>& out) -> DetachedTask {
+        for (int i = 0; i < 200; i++) {
+            co_await p.PrintAsync(PrintColor::WHITE, "INFO", "line " + std::to_string(i));
+        }
+        co_await p.FlushAsync();
+        out.set_value(s.Lines().size());
+    };
+
+    RunWithTimeout(std::chrono::seconds(5), [&] {
+        coroutine(printer, *sink, seen);
+        CHECK_EQ(seen.get_future().get(), 200u);
+    });
+
+    const std::vector<std::string> lines = sink->Lines();
+    CHECK_EQ(lines.size(), 200u);
+    for (size_t i = 0; i < lines.size(); i++) {
+        CHECK_EQ(lines[i], "[INFO] line " + std::to_string(i));
+    }
+}
+
+/**
+ * @brief 设置了调度钩子时由钩子恢复协程
+ */
+void TestSchedulerHook() {
+    auto sink = std::make_shared<MemorySink>(false, std::chrono::microseconds(100));
+    ColorPrinter::Printer printer{sink, {.deferred = true, .max_pending_bytes = 512}};
+
+    std::atomic<int> scheduled{0};
+    printer.SetAsyncScheduler([&scheduled](std::coroutine_handle<> handle) {
+        scheduled++;
+        std::thread([handle] { handle.resume(); }).detach();
+    });
+
+    std::promise<void> finished;
+    auto coroutine = [](ColorPrinter::Printer& p, std::promise<void>& done) -> DetachedTask {
+        for (int i = 0; i < 100; i++) {
+            co_await p.PrintAsync(PrintColor::WHITE, "INFO", std::string(64, 'x'));
+        }
+        co_await p.FlushAsync();
+        done.set_value();
+    };
+
+    RunWithTimeout(std::chrono::seconds(5), [&] {
+        coroutine(printer, finished);
+        finished.get_future().wait();
+    });
+    CHECK(scheduled.load() > 0);
+    CHECK_EQ(sink->Lines().size(), 100u);
+}
+
+} // namespace
+
+int main() {
+    TestResumeNeverOnWriterThread();
+    TestFlushAsyncOrdering();
+    TestSchedulerHook();
+    std::printf("test_async_resume: 通过\n");
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file test_capture.cpp
+ * @brief ColorPrinter::OutputCapture 的测试：写被捕获描述符的输出端被改写为写原来的描述符，
+ *        无法改写时不捕获，打印器的输出不会经管道回到自身
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+#include "color_printer.h"
+#include "color_printer_capture.h"
+#include "color_printer_fanout_sink.h"
+#include "color_printer_footer_sink.h"
+#include "test_common.h"
+
+using namespace color_printer_test;
+
+namespace {
+
+/**
+ * @brief 没有实现 WritesToFd / RebindFd 的自定义输出端，写到哪里无从确认
+ */
+class OpaqueSink : public LogSink {
+public:
+    void Write(const LogRecord* /*records*/, size_t /*count*/) override {}
+};
+
+std::string TempPath(const char* name) {
+    return "/tmp/cp_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+/**
+ * @brief FanOutSink 中写 fd 1 的 FdSink 被改写，其余子输出端原样共享；每行只输出一次
+ */
+void TestFanOutRebound() {
+    auto memory = std::make_shared<MemorySink>();
+    auto fan = std::make_shared<FanOutSink>();
+    fan->Add(memory);
+    fan->Add(std::make_shared<FdSink>(STDOUT_FILENO, false));
+    CHECK(fan->WritesToFd(STDOUT_FILENO));
+    CHECK(!fan->WritesToFd(STDERR_FILENO));
+
+    StdoutToFile redirect(TempPath("capture_fanout"));
+    ColorPrinter::Printer printer{fan};
+    {
+        ColorPrinter::OutputCapture capture(printer, {.capture_stderr = false});
+        CHECK(capture.Active());
+        CHECK(printer.Sink() != fan);
+        std::printf("from printf\n");
+        std::fflush(stdout);
+        printer.PrintColoredMessage(PrintColor::GREEN, "INFO", "direct");
+    }
+    printer.Flush();
+    CHECK(printer.Sink() == fan);  // 析构时换回原输出端
+    const std::string content = redirect.Finish();
+
+    // 直接输出的一行与捕获的一行各出现一次，没有经管道再次带上 [STDOUT] 前缀
+    CHECK(content.find("[INFO] direct\n") != std::string::npos);
+    CHECK(content.find("[STDOUT] from printf\n") != std::string::npos);
+    CHECK(content.find("[STDOUT] [") == std::string::npos);
+    CHECK_EQ(content.size(), std::string("[INFO] direct\n[STDOUT] from printf\n").size());
+
+    const auto lines = memory->Lines();
+    CHECK_EQ(lines.size(), 2u);
+}
+
+/**
+ * @brief 可能写 fd 1 却无法改写的输出端：不捕获，不做任何重定向
+ */
+void TestRefusedWhenUnverifiable() {
+    {
+        auto opaque = std::make_shared<OpaqueSink>();
+        ColorPrinter::Printer printer{opaque};
+        ColorPrinter::OutputCapture capture(printer);
+        CHECK(!capture.Active());
+        CHECK(printer.Sink() == opaque);
+    }
+    {
+        auto fan = std::make_shared<FanOutSink>();
+        fan->Add(std::make_shared<MemorySink>());
+        fan->Add(std::make_shared<OpaqueSink>());
+        ColorPrinter::Printer printer{fan};
+        ColorPrinter::OutputCapture capture(printer);
+        CHECK(!capture.Active());
+    }
+    {
+        auto footer = std::make_shared<FooterSink>(STDOUT_FILENO, false);
+        ColorPrinter::Printer printer{footer};
+        ColorPrinter::OutputCapture capture(printer, {.capture_stderr = false});
+        CHECK(!capture.Active());
+    }
+    // 页脚在 fd 2 上、只捕获 fd 1：两者互不影响
+    {
+        auto footer = std::make_shared<FooterSink>(STDERR_FILENO, false);
+        ColorPrinter::Printer printer{footer};
+        ColorPrinter::OutputCapture capture(printer, {.capture_stderr = false});
+        CHECK(capture.Active());
+        CHECK(printer.Sink() == footer);
+    }
+}
+
+/**
+ * @brief 不写标准描述符的输出端不需要改写
+ */
+void TestOwnFdSinkUnchanged() {
+    auto memory = std::make_shared<MemorySink>();
+    ColorPrinter::Printer printer{memory};
+    StdoutToFile redirect(TempPath("capture_memory"));
+    {
+        ColorPrinter::OutputCapture capture(printer, {.capture_stderr = false});
+        CHECK(capture.Active());
+        CHECK(printer.Sink() == memory);
+        std::printf("line\n");
+    }
+    printer.Flush();
+    CHECK(redirect.Finish().empty());
+    const auto lines = memory->Lines();
+    CHECK_EQ(lines.size(), 1u);
+    CHECK_EQ(lines[0], "[STDOUT] line");
+}
+
+/**
+ * @brief 静默状态指示器写到默认打印器输出端的描述符：捕获期间仍写到原来的 fd 1，不进入管道
+ */
+void TestIndicatorNotCaptured() {
+    StdoutToFile redirect(TempPath("capture_indicator"));
+    {
+        ColorPrinter::OutputCapture capture({.capture_stderr = false});
+        CHECK(capture.Active());
+        int counter = 0;
+        ColorPrinter::SetIndicatorFrameRate(0);
+        ColorPrinter::PrintSilentStatusIndicator(PrintColor::GREEN, true, counter);
+        ColorPrinter::PrintSilentStatusIndicator(PrintColor::GREEN, true, counter);
+    }
+    ColorPrinter::Flush();
+    const std::string content = redirect.Finish();
+    CHECK(content.find("[INFO] ") != std::string::npos);
+    CHECK_EQ(std::count(content.begin(), content.end(), '.'), 2);
+    CHECK(content.find("[STDOUT]") == std::string::npos);
+}
+
+} // namespace
+
+int main() {
+    RunWithTimeout(std::chrono::seconds(60), [] {
+        TestFanOutRebound();
+        TestRefusedWhenUnverifiable();
+        TestOwnFdSinkUnchanged();
+        TestIndicatorNotCaptured();
+    });
+    std::printf("test_capture: 通过\n");
+    return 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file test_common.h
+ * @brief 测试程序共用的断言宏与辅助类型
+ *        每个测试是一个独立的可执行程序，断言失败时输出位置并以非0状态退出
+ */
+
+#ifndef COLOR_PRINTER_TEST_COMMON_H
+#define COLOR_PRINTER_TEST_COMMON_H
+
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <poll.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "color_printer_sink.h"
+
+#define CHECK(condition)                                                                     \
+    do {                                                                                     \
+        if (!(condition)) {                                                                  \
+            std::fprintf(stderr, "%s:%d: 检查失败: %s\n", __FILE__, __LINE__, #condition);   \
+            std::exit(1);                                                                    \
+        }                                                                                    \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                           \
+    do {                                                                                     \
+        if (!((actual) == (expected))) {                                                     \
+            std::fprintf(stderr, "%s:%d: 检查失败: %s == %s\n", __FILE__, __LINE__, #actual, \
+                         #expected);                                                         \
+            std::exit(1);                                                                    \
+        }                                                                                    \
+    } while (0)
+
+namespace color_printer_test {
+
+/**
+ * @brief 在限定时间内运行 body，超时视为死锁，直接以失败退出（不等待卡住的线程）
+ */
+inline void RunWithTimeout(std::chrono::seconds limit, const std::function<void()>& body) {
+    std::packaged_task<void()> task(body);
+    std::future<void> done = task.get_future();
+    std::thread(std::move(task)).detach();
+    if (done.wait_for(limit) != std::future_status::ready) {
+        std::fprintf(stderr, "超时（%lld 秒），疑似死锁\n", static_cast<long long>(limit.count()));
+        std::fflush(stderr);
+        ::_exit(1);
+    }
+    done.get();
+}
+
+/**
+ * @class MemorySink
+ * @brief 把收到的行保存在内存中的输出端，可选地在每批后等待一段时间以模拟慢速输出
+ */
+class MemorySink : public LogSink {
+public:
+    explicit MemorySink(bool colored = false, std::chrono::microseconds delay = std::chrono::microseconds(0))
+        : colored_(colored), delay_(delay) {}
+
+    void Write(const LogRecord* records, size_t count) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < count; i++) {
+                lines_.emplace_back(records[i].Plain());
+            }
+            batches_++;
+        }
+        if (delay_.count() > 0) {
+            std::this_thread::sleep_for(delay_);
+        }
+    }
+
+    bool WantsColor() const override { return colored_; }
+
+    bool WritesToFd(int /*fd*/) const override { return false; }
+
+    std::vector<std::string> Lines() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lines_;
+    }
+
+    size_t Batches() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return batches_;
+    }
+
+private:
+    const bool colored_;
+    const std::chrono::microseconds delay_;
+    std::mutex mutex_;
+    std::vector<std::string> lines_;
+    size_t batches_ = 0;
+};
+
+/**
+ * @brief 在测试期间把 fd 1 指向临时文件，结束时恢复并返回文件内容
+ */
+class StdoutToFile {
+public:
+    explicit StdoutToFile(const std::string& path) : path_(path) {
+        std::fflush(stdout);
+        saved_ = ::dup(STDOUT_FILENO);
+        const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        CHECK(saved_ >= 0 && fd >= 0);
+        ::dup2(fd, STDOUT_FILENO);
+        ::close(fd);
+    }
+
+    std::string Finish() {
+        std::fflush(stdout);
+        ::dup2(saved_, STDOUT_FILENO);
+        ::close(saved_);
+        std::string content;
+        if (FILE* file = std::fopen(path_.c_str(), "rb")) {
+            char buffer[4096];
+            size_t length;
+            while ((length = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+                content.append(buffer, length);
+            }
+            std::fclose(file);
+        }
+        ::unlink(path_.c_str());
+        return content;
+    }
+
+private:
+    std::string path_;
+    int saved_ = -1;
+};
+
+/**
+ * @class Pty
+ * @brief 一对伪终端：被测对象写从端（终端），测试从主端读出写入的字节
+ */
+class Pty {
+public:
+    /**
+     * @param rows 终端行数
+     */
+    explicit Pty(unsigned short rows = 24) {
+        master_ = ::posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+        CHECK(master_ >= 0);
+        CHECK(::grantpt(master_) == 0 && ::unlockpt(master_) == 0);
+        slave_ = ::open(::ptsname(master_), O_RDWR | O_NOCTTY | O_CLOEXEC);
+        CHECK(slave_ >= 0);
+        termios mode;
+        CHECK(::tcgetattr(slave_, &mode) == 0);
+        ::cfmakeraw(&mode);  // 不转换换行，读出的就是写入的字节
+        CHECK(::tcsetattr(slave_, TCSANOW, &mode) == 0);
+        winsize size = {};
+        size.ws_row = rows;
+        size.ws_col = 80;
+        CHECK(::ioctl(master_, TIOCSWINSZ, &size) == 0);
+    }
+
+    ~Pty() {
+        ::close(slave_);
+        ::close(master_);
+    }
+
+    int Slave() const { return slave_; }
+
+    /**
+     * @brief 读出目前已写入的字节；等待最多 wait，之后没有新数据就返回
+     */
+    std::string Read(std::chrono::milliseconds wait = std::chrono::milliseconds(200)) {
+        std::string out;
+        pollfd fd = {master_, POLLIN, 0};
+        while (::poll(&fd, 1, static_cast<int>(wait.count())) > 0) {
+            char buffer[4096];
+            const ssize_t length = ::read(master_, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;
+            }
+            out.append(buffer, static_cast<size_t>(length));
+            wait = std::chrono::milliseconds(20);
+        }
+        return out;
+    }
+
+private:
+    int master_ = -1;
+    int slave_ = -1;
+};
+
+/**
+ * @struct DetachedTask
+ * @brief 立即开始执行、结束后自行销毁的协程
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::abort(); }
+    };
+};
+
+} // namespace color_printer_test
+
+#endif // COLOR_PRINTER_TEST_COMMON_H
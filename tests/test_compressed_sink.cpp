@@ -0,0 +1,215 @@
+/**
+ * @file test_compressed_sink.cpp
+ * @brief CompressedFileSink 的测试：CPZB 文件的写入、逐块解压、续写与拒绝打开非压缩日志
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "color_printer_compressed_sink.h"
+#include "test_common.h"
+
+namespace {
+
+std::string TempPath(const char* name) {
+    return "/tmp/color_printer_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+void AppendFile(const std::string& path, const std::string& data) {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    out << data;
+}
+
+/**
+ * @brief 逐行写入 lines（每行补上换行）并返回写入的全部内容
+ */
+std::string WriteLines(CompressedFileSink& sink, int first, int count) {
+    std::string expected;
+    std::vector<std::string> lines;
+    for (int i = first; i < first + count; i++) {
+        lines.push_back("[INFO] line " + std::to_string(i) + " " + std::string(static_cast<size_t>(i % 50), 'x') + "\n");
+        expected += lines.back();
+    }
+    std::vector<LogRecord> records;
+    for (const std::string& line : lines) {
+        LogRecord record{PrintColor::WHITE, LogLevel::INFO, "INFO", std::string_view(line).substr(7, line.size() - 8), line};
+        records.push_back(record);
+    }
+    sink.Write(records.data(), records.size());
+    return expected;
+}
+
+/**
+ * @brief 逐块解压，检查每块都以换行结束，返回拼接后的内容
+ */
+bool DecompressAll(const std::string& path, std::string& out, unsigned threads, size_t* block_count = nullptr) {
+    out.clear();
+    size_t blocks = 0;
+    const bool ok = CompressedFileSink::Decompress(path, [&](std::string_view block) {
+        CHECK(!block.empty() && block.back() == '\n');
+        out.append(block);
+        blocks++;
+        return true;
+    }, threads);
+    if (block_count != nullptr) {
+        *block_count = blocks;
+    }
+    return ok;
+}
+
+void TestRoundTrip(CompressionCodec codec) {
+    const std::string path = TempPath("roundtrip.cplz");
+    std::remove(path.c_str());
+    std::string expected;
+    {
+        CompressedFileOptions options;
+        options.path = path;
+        options.codec = codec;
+        options.block_bytes = 4096;
+        CompressedFileSink sink(options);
+        CHECK(sink.IsOpen());
+        expected = WriteLines(sink, 0, 3000);
+        sink.Flush();
+        CHECK(sink.Stats().blocks > 10);
+        CHECK_EQ(sink.Stats().raw_bytes, expected.size());
+    }
+    for (unsigned threads : {1u, 3u, 8u}) {
+        std::string content;
+        size_t blocks = 0;
+        CHECK(DecompressAll(path, content, threads, &blocks));
+        CHECK(blocks > 10);
+        CHECK(content == expected);
+    }
+
+    std::vector<CompressedBlockHeader> headers;
+    uint64_t valid_bytes = 0;
+    CHECK(CompressedFileSink::ReadBlockIndex(path, headers, &valid_bytes));
+    CHECK_EQ(valid_bytes, static_cast<uint64_t>(ReadFile(path).size()));
+    uint64_t raw_offset = 0;
+    for (const CompressedBlockHeader& header : headers) {
+        CHECK_EQ(header.raw_offset, raw_offset);
+        CHECK(header.raw_bytes <= 4096);
+        raw_offset += header.raw_bytes;
+    }
+    CHECK_EQ(raw_offset, static_cast<uint64_t>(expected.size()));
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief 崩溃留下的不完整块在重新打开时被截掉，之后的内容接着有效块继续追加
+ */
+void TestReopenTruncatesPartialBlock() {
+    const std::string path = TempPath("reopen.cplz");
+    std::remove(path.c_str());
+    CompressedFileOptions options;
+    options.path = path;
+    options.block_bytes = 2048;
+    std::string expected;
+    {
+        CompressedFileSink sink(options);
+        expected = WriteLines(sink, 0, 500);
+    }
+    const size_t clean_bytes = ReadFile(path).size();
+
+    // 模拟写了一半的块：帧头魔数加上不完整的帧头
+    AppendFile(path, std::string("CPZB\x01\x00\x00", 7));
+    {
+        CompressedFileSink sink(options);
+        CHECK(sink.IsOpen());
+        expected += WriteLines(sink, 500, 500);
+    }
+    std::string content;
+    CHECK(DecompressAll(path, content, 2));
+    CHECK(content == expected);
+    CHECK(ReadFile(path).size() > clean_bytes);
+
+    // 魔数前缀也视为不完整的块
+    AppendFile(path, "CP");
+    {
+        CompressedFileSink sink(options);
+        CHECK(sink.IsOpen());
+        expected += WriteLines(sink, 1000, 10);
+    }
+    CHECK(DecompressAll(path, content, 2));
+    CHECK(content == expected);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief 已存在但不是压缩日志的文件（或有效块之后跟着其他内容）原样保留，输出端拒绝打开
+ */
+void TestRefusesForeignFile() {
+    const std::string path = TempPath("foreign.log");
+    std::remove(path.c_str());
+    const std::string original = "plain text log\nsecond line\n";
+    AppendFile(path, original);
+    {
+        CompressedFileOptions options;
+        options.path = path;
+        CompressedFileSink sink(options);
+        CHECK(!sink.IsOpen());
+        WriteLines(sink, 0, 10);
+    }
+    CHECK(ReadFile(path) == original);
+
+    std::remove(path.c_str());
+    CompressedFileOptions options;
+    options.path = path;
+    std::string expected;
+    {
+        CompressedFileSink sink(options);
+        expected = WriteLines(sink, 0, 20);
+    }
+    AppendFile(path, "appended by someone else\n");
+    const std::string before = ReadFile(path);
+    {
+        CompressedFileSink sink(options);
+        CHECK(!sink.IsOpen());
+    }
+    CHECK(ReadFile(path) == before);
+    std::string content;
+    CHECK(DecompressAll(path, content, 1));
+    CHECK(content == expected);
+    std::remove(path.c_str());
+}
+
+/**
+ * @brief consumer 返回false时停止解压并返回false
+ */
+void TestConsumerStops() {
+    const std::string path = TempPath("stop.cplz");
+    std::remove(path.c_str());
+    {
+        CompressedFileOptions options;
+        options.path = path;
+        options.block_bytes = 1024;
+        CompressedFileSink sink(options);
+        WriteLines(sink, 0, 2000);
+    }
+    size_t calls = 0;
+    CHECK(!CompressedFileSink::Decompress(path, [&](std::string_view) { return ++calls < 3; }, 4));
+    CHECK_EQ(calls, 3u);
+    std::remove(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    TestRoundTrip(CompressionCodec::LZ);
+    TestRoundTrip(CompressionCodec::ZLIB);
+    TestRoundTrip(CompressionCodec::NONE);
+    TestReopenTruncatesPartialBlock();
+    TestRefusesForeignFile();
+    TestConsumerStops();
+    std::printf("test_compressed_sink: 通过\n");
+    return 0;
+}
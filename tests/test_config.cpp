@@ -0,0 +1,255 @@
+/**
+ * @file test_config.cpp
+ * @brief 配置快照的测试：ParseConfig 的解析与报错，SnapshotCell 在并发读取下的发布与释放，
+ *        慢速输出端不阻塞配置发布
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "color_printer.h"
+#include "color_printer_file_sink.h"
+#include "color_printer_snapshot.h"
+#include "test_common.h"
+
+using namespace color_printer_test;
+
+namespace {
+
+void TestParseConfig() {
+    ColorPrinter::PrinterConfig config;
+    config.level_colors[static_cast<size_t>(LogLevel::INFO)] = PrintColor::CYAN;
+    std::string error;
+    CHECK(ColorPrinter::ParseConfig("# 注释\n"
+                                    "\n"
+                                    "  min_level = warning  \n"
+                                    "sync_level=FATAL\n"
+                                    "colored = off\n"
+                                    "timestamp = 1\n"
+                                    "color.ERROR = magenta\n"
+                                    "color.info = none\n"
+                                    "sink = stderr",  // 最后一行没有换行
+                                    config, &error));
+    CHECK(config.min_level == LogLevel::WARNING);
+    CHECK(config.sync_level == LogLevel::FATAL);
+    CHECK(!config.colored);
+    CHECK(config.timestamp);
+    CHECK(config.level_colors[static_cast<size_t>(LogLevel::ERROR)] == PrintColor::MAGENTA);
+    CHECK(!config.level_colors[static_cast<size_t>(LogLevel::INFO)].has_value());
+    const auto* fd_sink = dynamic_cast<const FdSink*>(config.sink.get());
+    CHECK(fd_sink != nullptr);
+    CHECK_EQ(fd_sink->Fd(), STDERR_FILENO);
+
+    // 未出现的键保持原值
+    CHECK(ColorPrinter::ParseConfig("colored = true\n", config));
+    CHECK(config.colored);
+    CHECK(config.min_level == LogLevel::WARNING);
+    CHECK(config.sink.get() == fd_sink);
+
+    const std::string path = "/tmp/cp_test_" + std::to_string(::getpid()) + "_config.log";
+    CHECK(ColorPrinter::ParseConfig("sink = file:" + path + "\n", config));
+    const auto* file_sink = dynamic_cast<const RotatingFileSink*>(config.sink.get());
+    CHECK(file_sink != nullptr);
+    CHECK_EQ(file_sink->Path(), path);
+    config.sink.reset();
+    ::unlink(path.c_str());
+}
+
+/**
+ * @brief 重新加载时 sink 描述不变则沿用原输出端；代码安装的输出端不被同样的描述覆盖
+ */
+void TestReloadKeepsSink() {
+    const std::string path = "/tmp/cp_test_" + std::to_string(::getpid()) + "_reload.log";
+    const std::string text = "min_level = INFO\nsink = file:" + path + "\n";
+    ColorPrinter::PrinterConfig config;
+    CHECK(ColorPrinter::ParseConfig(text, config));
+    const std::shared_ptr<LogSink> file_sink = config.sink;
+    CHECK(dynamic_cast<const RotatingFileSink*>(file_sink.get()) != nullptr);
+    CHECK_EQ(config.sink_spec, "file:" + path);
+
+    // 只改其他键：同一个输出端，不会再开一个写同一文件的 RotatingFileSink
+    CHECK(ColorPrinter::ParseConfig("min_level = ERROR\nsink = file:" + path + "\n", config));
+    CHECK(config.sink == file_sink);
+    CHECK(config.min_level == LogLevel::ERROR);
+
+    // 代码换上的输出端在描述未变时保留
+    auto memory = std::make_shared<MemorySink>();
+    config.sink = memory;
+    CHECK(ColorPrinter::ParseConfig(text, config));
+    CHECK(config.sink == memory);
+
+    // 描述改变才替换
+    CHECK(ColorPrinter::ParseConfig("sink = stderr\n", config));
+    CHECK(dynamic_cast<const FdSink*>(config.sink.get()) != nullptr);
+    CHECK_EQ(config.sink_spec, std::string("stderr"));
+
+    // 通过 Printer 的文件重新加载路径同样保留
+    ColorPrinter::Printer printer{memory};
+    printer.UpdateConfig([&](ColorPrinter::PrinterConfig& current) { CHECK(ColorPrinter::ParseConfig(text, current)); });
+    const std::shared_ptr<LogSink> loaded = printer.Sink();
+    printer.UpdateConfig([&](ColorPrinter::PrinterConfig& current) { CHECK(ColorPrinter::ParseConfig(text, current)); });
+    CHECK(printer.Sink() == loaded);
+
+    config.sink.reset();
+    ::unlink(path.c_str());
+}
+
+/**
+ * @brief 任一行出错时整体失败，config 保持不变，错误信息带行号
+ */
+void TestParseConfigErrors() {
+    const std::pair<const char*, const char*> cases[] = {
+        {"min_level = INFO\nno equals sign\n", "第2行"},
+        {"unknown_key = 1\n", "第1行"},
+        {"min_level = LOUD\n", "第1行"},
+        {"colored = maybe\n", "第1行"},
+        {"# x\ncolor.ERROR = PURPLE\n", "第2行"},
+        {"color.SEVERE = RED\n", "第1行"},
+        {"sink = file:\n", "第1行"},
+        {"sink = tcp://localhost\n", "第1行"},
+    };
+    for (const auto& [text, where] : cases) {
+        ColorPrinter::PrinterConfig config;
+        config.min_level = LogLevel::OK;
+        std::string error;
+        CHECK(!ColorPrinter::ParseConfig(text, config, &error));
+        CHECK(config.min_level == LogLevel::OK);
+        CHECK(error.rfind(where, 0) == 0);
+    }
+    ColorPrinter::PrinterConfig config;
+    CHECK(!ColorPrinter::ParseConfig("bad", config));  // error 可以为空
+}
+
+constexpr int kSnapshots = 2000;
+std::atomic<bool> g_freed[kSnapshots + 1];
+
+/**
+ * @struct Snapshot
+ * @brief 析构时登记自己已被释放；两个字段总是相等
+ */
+struct Snapshot {
+    int index;
+    int copy;
+    ~Snapshot() { g_freed[index].store(true, std::memory_order_seq_cst); }
+};
+
+std::unique_ptr<const Snapshot> MakeSnapshot(int index) {
+    return std::unique_ptr<const Snapshot>(new Snapshot{index, index});
+}
+
+/**
+ * @brief 写者不断发布新快照时，读者持有的快照在 ReadGuard 存活期间不会被释放；
+ *        每个被替换的快照最终都被释放，读者看到的序号单调不减
+ */
+void TestSnapshotPublishRead() {
+    using color_printer_detail::SnapshotCell;
+    auto cell = std::make_unique<SnapshotCell<Snapshot>>(MakeSnapshot(0));
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++) {
+        readers.emplace_back([&] {
+            int last = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto guard = cell->Read();
+                const int index = guard->index;
+                CHECK_EQ(guard->copy, index);
+                CHECK(index >= last);
+                last = index;
+                std::this_thread::yield();  // 持有期间让写者有机会发布
+                CHECK(!g_freed[index].load(std::memory_order_seq_cst));
+                CHECK_EQ(guard->copy, index);
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    while (reads.load() < 100) {
+        std::this_thread::yield();  // 等读者都跑起来
+    }
+    for (int i = 1; i <= kSnapshots; i++) {
+        cell->Publish(MakeSnapshot(i));
+        // Publish 返回时前一个快照已经释放
+        CHECK(g_freed[i - 1].load(std::memory_order_seq_cst));
+        if (i % 16 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    stop.store(true);
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    CHECK(reads.load() > 0);
+    CHECK(!g_freed[kSnapshots].load());
+    cell.reset();
+    CHECK(g_freed[kSnapshots].load());
+}
+
+/**
+ * @class GateSink
+ * @brief Write 在放行前一直阻塞的输出端，用来模拟卡住的磁盘或管道
+ */
+class GateSink : public LogSink {
+public:
+    void Write(const LogRecord* /*records*/, size_t /*count*/) override {
+        entered_.store(true);
+        while (!open_.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    bool WritesToFd(int /*fd*/) const override { return false; }
+
+    bool Entered() const { return entered_.load(); }
+    void Open() { open_.store(true); }
+
+private:
+    std::atomic<bool> entered_{false};
+    std::atomic<bool> open_{false};
+};
+
+/**
+ * @brief 输出端阻塞在 Write 里时，发布新配置不必等它返回
+ */
+void TestSlowSinkDoesNotBlockUpdate() {
+    auto sink = std::make_shared<GateSink>();
+    ColorPrinter::Printer printer{sink};
+    std::thread writer([&] { printer.PrintColoredMessage(PrintColor::WHITE, "INFO", "blocked"); });
+    while (!sink->Entered()) {
+        std::this_thread::yield();
+    }
+
+    std::atomic<bool> updated{false};
+    std::thread updater([&] {
+        printer.UpdateConfig([](ColorPrinter::PrinterConfig& config) { config.min_level = LogLevel::WARNING; });
+        updated.store(true);
+    });
+    for (int i = 0; i < 5000 && !updated.load(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const bool updated_while_blocked = updated.load();
+    sink->Open();
+    updater.join();
+    writer.join();
+    CHECK(updated_while_blocked);
+    CHECK(printer.Config().min_level == LogLevel::WARNING);
+}
+
+} // namespace
+
+int main() {
+    TestParseConfig();
+    TestParseConfigErrors();
+    TestReloadKeepsSink();
+    RunWithTimeout(std::chrono::seconds(60), [] { TestSnapshotPublishRead(); });
+    RunWithTimeout(std::chrono::seconds(60), [] { TestSlowSinkDoesNotBlockUpdate(); });
+    std::printf("test_config: 通过\n");
+    return 0;
+}
@@ -0,0 +1,259 @@
+/**
+ * @file test_dashboard.cpp
+ * @brief 多行实时面板的测试：在伪终端上检查行数超过终端高度时只画最后几行并汇总其余的行，
+ *        面板画在默认打印器输出端所在的终端上，有页脚时画在页脚中
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "color_printer.h"
+#include "color_printer_footer_sink.h"
+#include "color_printer_internal.h"
+#include "test_common.h"
+
+using namespace color_printer_test;
+
+namespace {
+
+/**
+ * @brief 测试期间把 fd 1 指向伪终端的从端
+ */
+class StdoutToPty {
+public:
+    explicit StdoutToPty(const Pty& pty) {
+        std::fflush(stdout);
+        saved_ = ::dup(STDOUT_FILENO);
+        CHECK(saved_ >= 0 && ::dup2(pty.Slave(), STDOUT_FILENO) >= 0);
+    }
+
+    ~StdoutToPty() {
+        std::fflush(stdout);
+        ::dup2(saved_, STDOUT_FILENO);
+        ::close(saved_);
+    }
+
+private:
+    int saved_ = -1;
+};
+
+/**
+ * @class Screen
+ * @brief 极简的终端模拟：只解释面板用到的控制序列，得到最终屏幕上每行的文字
+ *        光标移到最后一行之下时整屏上滚，上移不会越过第一行，与真实终端一致
+ */
+class Screen {
+public:
+    Screen(size_t rows, size_t columns) : columns_(columns), cells_(rows, Row(columns, " ")) {}
+
+    void Feed(const std::string& bytes) {
+        size_t i = 0;
+        while (i < bytes.size()) {
+            const unsigned char byte = static_cast<unsigned char>(bytes[i]);
+            if (byte == '\033' && i + 1 < bytes.size() && bytes[i + 1] == '[') {
+                size_t end = i + 2;
+                while (end < bytes.size() && ((bytes[end] >= '0' && bytes[end] <= '9') || bytes[end] == ';')) {
+                    end++;
+                }
+                const std::string digits = bytes.substr(i + 2, end - i - 2);
+                const size_t n = digits.empty() || digits.find(';') != std::string::npos ? 1 : std::stoul(digits);
+                Control(bytes[end], n, digits);
+                i = end + 1;
+            } else if (byte == '\r') {
+                column_ = 0;
+                i++;
+            } else if (byte == '\n') {
+                LineFeed();
+                i++;
+            } else {
+                const size_t length = byte < 0x80 ? 1 : (byte >> 5) == 0x6 ? 2 : (byte >> 4) == 0xE ? 3 : 4;
+                uint32_t codepoint = length == 1 ? byte : byte & (0xFF >> (length + 1));
+                for (size_t k = 1; k < length; k++) {
+                    codepoint = (codepoint << 6) | (static_cast<unsigned char>(bytes[i + k]) & 0x3F);
+                }
+                Put(bytes.substr(i, length), color_printer_detail::IsWideCodepoint(codepoint) ? 2 : 1);
+                i += length;
+            }
+        }
+    }
+
+    std::string Line(size_t row) const {
+        std::string text;
+        for (const std::string& cell : cells_[row]) {
+            text += cell;
+        }
+        return text;
+    }
+
+    size_t CursorRow() const { return row_; }
+
+private:
+    using Row = std::vector<std::string>;
+
+    void Control(char command, size_t n, const std::string& digits) {
+        switch (command) {
+        case 'A': row_ = row_ >= n ? row_ - n : 0; break;
+        case 'B': row_ = std::min(row_ + n, cells_.size() - 1); break;
+        case 'G': column_ = n - 1; break;
+        case 'K': Clear(row_, digits == "2" ? 0 : column_); break;
+        case 'J':
+            Clear(row_, column_);
+            for (size_t r = row_ + 1; r < cells_.size(); r++) {
+                Clear(r, 0);
+            }
+            break;
+        default: break;  // SGR 颜色等不影响文字
+        }
+    }
+
+    void Clear(size_t row, size_t from) {
+        for (size_t c = from; c < columns_; c++) {
+            cells_[row][c] = " ";
+        }
+    }
+
+    void LineFeed() {
+        if (row_ + 1 < cells_.size()) {
+            row_++;
+            return;
+        }
+        cells_.erase(cells_.begin());
+        cells_.emplace_back(columns_, " ");
+    }
+
+    void Put(const std::string& glyph, size_t width) {
+        if (column_ + width > columns_) {
+            return;
+        }
+        cells_[row_][column_] = glyph;
+        if (width == 2) {
+            cells_[row_][column_ + 1] = "";
+        }
+        column_ += width;
+    }
+
+    size_t columns_;
+    std::vector<Row> cells_;
+    size_t row_ = 0;
+    size_t column_ = 0;
+};
+
+void TestRowsLimitedToTerminalHeight() {
+    Pty pty(6);
+    std::string output;
+    {
+        StdoutToPty redirect(pty);
+        ColorPrinter::Dashboard dashboard(std::chrono::milliseconds(10));
+        std::vector<ColorPrinter::Dashboard::Row> rows;
+        for (int i = 0; i < 10; i++) {
+            rows.push_back(dashboard.AddRow("task" + std::to_string(i), 100));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            output += pty.Read(std::chrono::milliseconds(0));
+        }
+        for (auto& row : rows) {
+            row.Advance(50);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        dashboard.Finish();
+    }
+    output += pty.Read();
+
+    // 6 行的终端：面板最多 5 行 = 汇总行 + 最后 4 行，每行都画在自己的位置上
+    Screen screen(6, 80);
+    screen.Feed(output);
+    CHECK(screen.Line(0).find("另有 6 行未显示") != std::string::npos);
+    for (size_t i = 1; i <= 4; i++) {
+        const std::string line = screen.Line(i);
+        CHECK(line.rfind("task" + std::to_string(i + 5), 0) == 0);
+        CHECK(line.find("50.0%") != std::string::npos);
+    }
+    CHECK_EQ(screen.CursorRow(), 5u);
+}
+
+/**
+ * @brief 测试期间替换默认打印器的输出端
+ */
+class DefaultSink {
+public:
+    explicit DefaultSink(std::shared_ptr<LogSink> sink) : saved_(ColorPrinter::Default().Config()) {
+        ColorPrinter::Default().UpdateConfig([&](ColorPrinter::PrinterConfig& config) { config.sink = std::move(sink); });
+    }
+
+    ~DefaultSink() { ColorPrinter::Default().SetConfig(saved_); }
+
+private:
+    ColorPrinter::PrinterConfig saved_;
+};
+
+/**
+ * @brief 标准输出不是终端、默认打印器写入伪终端时，面板画在伪终端上，颜色跟随输出端
+ */
+void TestDrawsOnPrinterFd() {
+    Pty pty;
+    DefaultSink sink(std::make_shared<FdSink>(pty.Slave(), false));
+    {
+        ColorPrinter::Dashboard dashboard(std::chrono::milliseconds(10));
+        auto row = dashboard.AddRow("task", 100, PrintColor::GREEN);
+        row.Advance(50);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        dashboard.Finish();
+    }
+    const std::string output = pty.Read();
+    Screen screen(24, 80);
+    screen.Feed(output);
+    CHECK(screen.Line(0).rfind("task", 0) == 0);
+    CHECK(screen.Line(0).find("50.0%") != std::string::npos);
+    CHECK(output.find(ColorPrinter::GetColorCode(PrintColor::GREEN)) == std::string::npos);
+}
+
+/**
+ * @brief 有页脚时面板的行画在页脚中，结束时从页脚移除，最终状态写在页脚上方
+ */
+void TestDrawnInFooter() {
+    Pty pty;
+    auto footer = std::make_shared<FooterSink>(pty.Slave(), false, std::chrono::milliseconds(20));
+    DefaultSink sink(footer);
+    footer->SetLine(0, PrintColor::CYAN, "status");
+    std::string output;
+    {
+        ColorPrinter::Dashboard dashboard(std::chrono::milliseconds(10));
+        auto first = dashboard.AddRow("first", 100);
+        auto second = dashboard.AddRow("second", 100);
+        first.Advance(30);
+        second.Advance(60);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        output = pty.Read(std::chrono::milliseconds(100));
+        const size_t status = output.rfind("status");
+        CHECK(status != std::string::npos);
+        CHECK(output.find("first", status) != std::string::npos);
+        CHECK(output.find("second", output.find("first", status)) != std::string::npos);
+
+        first.Advance(70);
+        second.Advance(40);
+        dashboard.Finish();
+    }
+    output = pty.Read(std::chrono::milliseconds(100));
+    const size_t status = output.rfind("status");
+    CHECK(status != std::string::npos);
+    CHECK(output.find("first") < status);  // 最终状态在页脚上方
+    CHECK(output.find("second") < status);
+    CHECK(output.find("first", status) == std::string::npos);  // 页脚中不再有面板的行
+    CHECK(output.find("100.0%") != std::string::npos);
+}
+
+} // namespace
+
+int main() {
+    RunWithTimeout(std::chrono::seconds(60), [] { TestRowsLimitedToTerminalHeight(); });
+    RunWithTimeout(std::chrono::seconds(60), [] { TestDrawsOnPrinterFd(); });
+    RunWithTimeout(std::chrono::seconds(60), [] { TestDrawnInFooter(); });
+    std::printf("test_dashboard: 通过\n");
+    return 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * @file test_deferred.cpp
+ * @brief 延迟输出与同步通道的顺序测试：同一线程的消息顺序不变，同步消息返回时已连同此前的消息一起写出
+ */
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "color_printer.h"
+#include "test_common.h"
+
+using namespace color_printer_test;
+
+namespace {
+
+const char* TypeFor(int i) {
+    return i % 7 == 3 ? "ERROR" : "INFO";
+}
+
+/**
+ * @brief 单线程交替输出批量通道与同步通道的消息，写出顺序与调用顺序一致
+ */
+void TestSingleThreadOrder() {
+    auto sink = std::make_shared<MemorySink>(false, std::chrono::microseconds(100));
+    ColorPrinter::Printer printer{sink, {.deferred = true, .batch_bytes = 1024}};
+    std::vector<std::string> expected;
+    for (int i = 0; i < 2000; i++) {
+        const std::string text = "message " + std::to_string(i);
+        printer.PrintColoredMessage(PrintColor::WHITE, TypeFor(i), text);
+        expected.push_back(std::string("[") + TypeFor(i) + "] " + text);
+    }
+    printer.Flush();
+    CHECK(sink->Lines() == expected);
+}
+
+/**
+ * @brief 同步消息返回时，本线程此前排队的消息和它自己都已写出，不必等后台通道的定时刷新
+ */
+void TestSyncWritesPendingFirst() {
+    auto sink = std::make_shared<MemorySink>();
+    ColorPrinter::Printer printer{
+        sink, {.deferred = true, .batch_bytes = 1024 * 1024, .flush_interval = std::chrono::milliseconds(60000)}};
+    for (int i = 0; i < 5; i++) {
+        printer.PrintColoredMessage(PrintColor::WHITE, "INFO", "queued " + std::to_string(i));
+    }
+    printer.PrintColoredMessage(PrintColor::RED, "ERROR", "failure");
+    const std::vector<std::string> lines = sink->Lines();
+    CHECK_EQ(lines.size(), 6u);
+    for (int i = 0; i < 5; i++) {
+        CHECK_EQ(lines[static_cast<size_t>(i)], "[INFO] queued " + std::to_string(i));
+    }
+    CHECK_EQ(lines[5], "[ERROR] failure");
+
+    // sync_level 以下的消息仍然只排队
+    printer.PrintColoredMessage(PrintColor::YELLOW, "WARNING", "later");
+    CHECK_EQ(sink->Lines().size(), 6u);
+    printer.Flush();
+    CHECK_EQ(sink->Lines().size(), 7u);
+}
+
+/**
+ * @brief 多个线程同时输出，各线程自己的消息（无论走哪个通道）保持调用顺序
+ */
+void TestPerThreadOrder() {
+    constexpr int kThreads = 4;
+    constexpr int kMessages = 3000;
+    auto sink = std::make_shared<MemorySink>(false, std::chrono::microseconds(50));
+    ColorPrinter::Printer printer{sink, {.deferred = true, .batch_bytes = 4096, .max_pending_bytes = 64 * 1024}};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&printer, t] {
+            for (int i = 0; i < kMessages; i++) {
+                printer.PrintColoredMessage(PrintColor::WHITE, TypeFor(i), std::to_string(t) + " " + std::to_string(i));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    printer.Flush();
+
+    int next[kThreads] = {};
+    const std::vector<std::string> lines = sink->Lines();
+    CHECK_EQ(lines.size(), static_cast<size_t>(kThreads * kMessages));
+    for (const std::string& line : lines) {
+        const size_t body = line.find("] ") + 2;
+        const size_t space = line.find(' ', body);
+        const int t = std::stoi(line.substr(body, space - body));
+        const int i = std::stoi(line.substr(space + 1));
+        CHECK(t >= 0 && t < kThreads);
+        CHECK_EQ(i, next[t]);
+        CHECK(line.compare(1, std::string(TypeFor(i)).size(), TypeFor(i)) == 0);
+        next[t]++;
+    }
+}
+
+} // namespace
+
+int main() {
+    RunWithTimeout(std::chrono::seconds(60), [] {
+        TestSingleThreadOrder();
+        TestSyncWritesPendingFirst();
+        TestPerThreadOrder();
+    });
+    std::printf("test_deferred: 通过\n");
+    return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ * @file test_escapes.cpp
+ * @brief AppendLinesMinimalEscapes 的测试：同色连续行、颜色变化、正文自带转义序列、单条消息，
+ *        以及批末的行总以重置代码结束
+ */
+
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "color_printer.h"
+#include "color_printer_internal.h"
+#include "test_common.h"
+
+using namespace color_printer_detail;
+
+namespace {
+
+const std::string kReset = "\033[0m";
+
+/**
+ * @class Batch
+ * @brief 按 FdSink 收到的格式构造一批消息：颜色代码 + 正文 + 重置代码 + 换行
+ */
+class Batch {
+public:
+    void Add(PrintColor color, const std::string& body) {
+        const std::string head = ColorPrinter::GetColorCode(color);
+        lines_.push_back(head + body + kReset + "\n");
+        const std::string& line = lines_.back();
+        LogRecord record{color, LogLevel::INFO, "INFO", std::string_view(line).substr(head.size(), body.size()), line};
+        record.escape_head = static_cast<uint32_t>(head.size());
+        record.escape_tail = static_cast<uint32_t>(kReset.size());
+        records_.push_back(record);
+    }
+
+    /**
+     * @brief 不带颜色的一行
+     */
+    void AddPlain(const std::string& body) {
+        lines_.push_back(body + "\n");
+        const std::string& line = lines_.back();
+        records_.push_back({PrintColor::WHITE, LogLevel::INFO, "INFO", std::string_view(line).substr(0, body.size()), line});
+    }
+
+    /**
+     * @brief 追加到输出，并检查省去的字节数与实际减少的字节数一致
+     */
+    std::string Append() const {
+        std::string out;
+        const size_t saved = AppendLinesMinimalEscapes(out, records_.data(), records_.size());
+        size_t total = 0;
+        for (const std::string& line : lines_) {
+            total += line.size();
+        }
+        CHECK_EQ(out.size() + saved, total);
+        return out;
+    }
+
+    std::string Joined() const {
+        std::string joined;
+        for (const std::string& line : lines_) {
+            joined += line;
+        }
+        return joined;
+    }
+
+private:
+    std::deque<std::string> lines_;  ///< deque：追加时已有的行不移动，记录中的视图保持有效
+    std::vector<LogRecord> records_;
+};
+
+std::string Green() { return ColorPrinter::GetColorCode(PrintColor::GREEN); }
+std::string Red() { return ColorPrinter::GetColorCode(PrintColor::RED); }
+
+/**
+ * @brief 同色的连续行只在开头写一次颜色代码，在批末写一次重置代码
+ */
+void TestSameColorRun() {
+    Batch batch;
+    batch.Add(PrintColor::GREEN, "one");
+    batch.Add(PrintColor::GREEN, "two");
+    batch.Add(PrintColor::GREEN, "three");
+    CHECK_EQ(batch.Append(), Green() + "one\ntwo\nthree" + kReset + "\n");
+}
+
+/**
+ * @brief 颜色变化处保留前一段的重置代码和后一段的颜色代码
+ */
+void TestColorChange() {
+    Batch batch;
+    batch.Add(PrintColor::GREEN, "a");
+    batch.Add(PrintColor::GREEN, "b");
+    batch.Add(PrintColor::RED, "c");
+    batch.Add(PrintColor::RED, "d");
+    batch.Add(PrintColor::GREEN, "e");
+    CHECK_EQ(batch.Append(),
+             Green() + "a\nb" + kReset + "\n" + Red() + "c\nd" + kReset + "\n" + Green() + "e" + kReset + "\n");
+
+    // 不带颜色的行前后都不合并
+    Batch plain;
+    plain.Add(PrintColor::GREEN, "a");
+    plain.AddPlain("b");
+    plain.Add(PrintColor::GREEN, "c");
+    CHECK_EQ(plain.Append(), plain.Joined());
+}
+
+/**
+ * @brief 正文自带转义序列的行，行尾状态不确定：保留它的重置代码和下一行的颜色代码
+ */
+void TestBodyWithEscape() {
+    Batch batch;
+    batch.Add(PrintColor::GREEN, "bold \033[1mtext");
+    batch.Add(PrintColor::GREEN, "next");
+    CHECK_EQ(batch.Append(), batch.Joined());
+
+    // 只有前一行的正文决定能否合并：转义序列在后一行时，前一行仍可省去重置代码
+    Batch later;
+    later.Add(PrintColor::GREEN, "plain");
+    later.Add(PrintColor::GREEN, "then \033[1mbold");
+    later.Add(PrintColor::GREEN, "after");
+    CHECK_EQ(later.Append(), Green() + "plain\nthen \033[1mbold" + kReset + "\n" + Green() + "after" + kReset + "\n");
+}
+
+/**
+ * @brief 单条消息原样输出
+ */
+void TestSingleRecord() {
+    Batch batch;
+    batch.Add(PrintColor::YELLOW, "only");
+    CHECK_EQ(batch.Append(), batch.Joined());
+
+    std::string out;
+    CHECK_EQ(AppendLinesMinimalEscapes(out, nullptr, 0), 0u);
+    CHECK(out.empty());
+}
+
+/**
+ * @brief 去掉转义序列后每行可见的文字
+ */
+std::string StripEscapes(const std::string& text) {
+    std::string plain;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == '\033') {
+            while (i < text.size() && text[i] != 'm') {
+                i++;
+            }
+            continue;
+        }
+        plain += text[i];
+    }
+    return plain;
+}
+
+/**
+ * @brief 各种组合的批次：可见文字不变，批末带颜色的行总以重置代码结束
+ */
+void TestLastLineAlwaysReset() {
+    const int kKinds = 4;  // 绿色、红色、正文带转义序列的绿色、不带颜色
+    for (int length = 1; length <= 4; length++) {
+        int combinations = 1;
+        for (int i = 0; i < length; i++) {
+            combinations *= kKinds;
+        }
+        for (int code = 0; code < combinations; code++) {
+            Batch batch;
+            int rest = code;
+            int last_kind = 0;
+            for (int i = 0; i < length; i++) {
+                last_kind = rest % kKinds;
+                rest /= kKinds;
+                const std::string body = "line" + std::to_string(i);
+                switch (last_kind) {
+                case 0: batch.Add(PrintColor::GREEN, body); break;
+                case 1: batch.Add(PrintColor::RED, body); break;
+                case 2: batch.Add(PrintColor::GREEN, body + " \033[4munderline"); break;
+                default: batch.AddPlain(body); break;
+                }
+            }
+            const std::string out = batch.Append();
+            CHECK_EQ(StripEscapes(out), StripEscapes(batch.Joined()));
+            const std::string tail = last_kind == 3 ? "\n" : kReset + "\n";
+            CHECK(out.size() >= tail.size() && out.compare(out.size() - tail.size(), tail.size(), tail) == 0);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    TestSameColorRun();
+    TestColorChange();
+    TestBodyWithEscape();
+    TestSingleRecord();
+    TestLastLineAlwaysReset();
+    std::printf("test_escapes: 通过\n");
+    return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file test_footer_sink.cpp
+ * @brief FooterSink 的测试：在伪终端上检查每批消息之后页脚都被补回，状态行的变化按帧合并，
+ *        静默状态指示器随消息结束，进度条画在页脚中
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "color_printer.h"
+#include "color_printer_footer_sink.h"
+#include "test_common.h"
+
+using namespace color_printer_test;
+
+namespace {
+
+void WriteLine(FooterSink& sink, const std::string& text) {
+    const std::string line = "[INFO] " + text + "\n";
+    const LogRecord record{PrintColor::WHITE, LogLevel::INFO, "INFO", std::string_view(line).substr(7, text.size()), line};
+    sink.Write(&record, 1);
+}
+
+/**
+ * @brief 距上次重绘不到一帧时，消息之后补回上次画出的页脚；SetLine 的新内容要等到下一帧
+ */
+void TestFooterRestoredAfterMessages() {
+    Pty pty;
+    {
+        FooterSink sink(pty.Slave(), false, std::chrono::seconds(1));
+        sink.SetLine(0, PrintColor::CYAN, "status 1");
+        CHECK(pty.Read().find("status 1") != std::string::npos);  // 第一帧由后台线程立即画出
+
+        WriteLine(sink, "message 1");
+        std::string output = pty.Read(std::chrono::milliseconds(50));
+        const size_t message = output.find("message 1");
+        CHECK(message != std::string::npos);
+        CHECK(output.find("status 1", message) != std::string::npos);
+
+        sink.SetLine(0, PrintColor::CYAN, "status 2");
+        WriteLine(sink, "message 2");
+        output = pty.Read(std::chrono::milliseconds(50));
+        CHECK(output.find("status 1", output.find("message 2")) != std::string::npos);
+        CHECK(output.find("status 2") == std::string::npos);
+
+        // 下一帧由后台线程画出新内容，之后的消息补回的是新内容
+        CHECK(pty.Read(std::chrono::milliseconds(2000)).find("status 2") != std::string::npos);
+        WriteLine(sink, "message 3");
+        output = pty.Read(std::chrono::milliseconds(50));
+        CHECK(output.find("status 2", output.find("message 3")) != std::string::npos);
+    }
+    CHECK(pty.Read().find("\033[J") != std::string::npos);  // 析构时清除页脚
+}
+
+/**
+ * @brief 静默状态指示器画在页脚最后一行，下一批消息写出时随之移除
+ */
+void TestIndicatorClearedByMessages() {
+    Pty pty;
+    FooterSink sink(pty.Slave(), false, std::chrono::seconds(1));
+    sink.SetLine(0, PrintColor::CYAN, "status");
+    CHECK(pty.Read().find("status") != std::string::npos);
+
+    CHECK(color_printer_detail::ShowIndicatorInFooter(PrintColor::GREEN, 3));
+    CHECK(pty.Read(std::chrono::milliseconds(2000)).find("[INFO] ...") != std::string::npos);
+
+    WriteLine(sink, "message");
+    const std::string output = pty.Read(std::chrono::milliseconds(50));
+    const size_t message = output.find("message");
+    CHECK(message != std::string::npos);
+    CHECK(output.find("status", message) != std::string::npos);
+    CHECK(output.find("[INFO] ...", message) == std::string::npos);
+
+    // 之后的消息也不会再把它带回来
+    WriteLine(sink, "again");
+    CHECK(pty.Read(std::chrono::milliseconds(50)).find("[INFO] ...") == std::string::npos);
+}
+
+/**
+ * @brief 默认打印器的输出端是页脚时，进度条画在页脚中并跟随输出端不带颜色；
+ *        结束时从页脚移除，最终一行写在页脚上方
+ */
+void TestProgressDrawnInFooter() {
+    Pty pty;
+    auto sink = std::make_shared<FooterSink>(pty.Slave(), false, std::chrono::milliseconds(20));
+    ColorPrinter::Printer& printer = ColorPrinter::Default();
+    const ColorPrinter::PrinterConfig saved = printer.Config();
+    printer.UpdateConfig([&](ColorPrinter::PrinterConfig& config) { config.sink = sink; });
+    sink->SetLine(0, PrintColor::CYAN, "status");
+    {
+        ColorPrinter::Progress progress(10, PrintColor::GREEN, "TASK", std::chrono::milliseconds(10));
+        progress.Advance(5);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        std::string output = pty.Read(std::chrono::milliseconds(100));
+        const size_t status = output.rfind("status");
+        CHECK(status != std::string::npos);
+        CHECK(output.find("[TASK]", status) != std::string::npos);  // 画在状态行之后的页脚中
+        CHECK(output.find("50.0%") != std::string::npos);
+        CHECK(output.find(ColorPrinter::GetColorCode(PrintColor::GREEN)) == std::string::npos);
+
+        progress.Advance(5);
+        progress.Finish();
+        output = pty.Read(std::chrono::milliseconds(100));
+        const size_t final_line = output.find("100.0%");
+        CHECK(final_line != std::string::npos);
+        CHECK(output.find("status", final_line) != std::string::npos);  // 页脚补回在最终一行下方
+        CHECK(output.find("ETA", final_line) == std::string::npos);
+    }
+    printer.SetConfig(saved);
+}
+
+} // namespace
+
+int main() {
+    RunWithTimeout(std::chrono::seconds(60), [] { TestFooterRestoredAfterMessages(); });
+    RunWithTimeout(std::chrono::seconds(60), [] { TestIndicatorClearedByMessages(); });
+    RunWithTimeout(std::chrono::seconds(60), [] { TestProgressDrawnInFooter(); });
+    std::printf("test_footer_sink: 通过\n");
+    return 0;
+}
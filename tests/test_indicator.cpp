@@ -0,0 +1,107 @@
+/**
+ * @file test_indicator.cpp
+ * @brief 静默状态指示器的测试：越界的计数不会越界写入，其他指示器画过这一行后整行重绘
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "color_printer.h"
+#include "test_common.h"
+
+using namespace color_printer_test;
+
+namespace {
+
+std::string TempPath(const char* name) {
+    return "/tmp/cp_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+size_t CountOf(const std::string& text, std::string_view what) {
+    size_t count = 0;
+    for (size_t at = text.find(what); at != std::string::npos; at = text.find(what, at + what.size())) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief 调用者传入越界的计数时从1重新开始
+ */
+void TestOutOfRangeCounter() {
+    StdoutToFile redirect(TempPath("indicator_range"));
+    int counter = -50;
+    ColorPrinter::PrintSilentStatusIndicator(PrintColor::GREEN, true, counter);
+    CHECK_EQ(counter, 1);
+    counter = 1000;
+    ColorPrinter::PrintSilentStatusIndicator(PrintColor::GREEN, true, counter);
+    CHECK_EQ(counter, 1);
+    const std::string content = redirect.Finish();
+    CHECK_EQ(std::count(content.begin(), content.end(), '.'), 1);  // 第二次仍是同一行上的1个点，无需追加
+}
+
+/**
+ * @brief 线程 B 在线程 A 两次绘制之间画了自己的指示器：A 的第二次绘制必须整行重绘，不能接着 B 的点追加
+ */
+void TestOtherThreadForcesRedraw() {
+    StdoutToFile redirect(TempPath("indicator_threads"));
+    int a = 0;
+    ColorPrinter::PrintSilentStatusIndicator(PrintColor::GREEN, true, a);
+    std::thread([] {
+        int b = 0;
+        ColorPrinter::PrintSilentStatusIndicator(PrintColor::RED, true, b);
+    }).join();
+    ColorPrinter::PrintSilentStatusIndicator(PrintColor::GREEN, true, a);
+    const std::string content = redirect.Finish();
+    CHECK_EQ(CountOf(content, "\r\033[2K"), 3u);
+    CHECK_EQ(CountOf(content, "[INFO] "), 3u);
+    // 最后一帧是 A 的两个点
+    const std::string tail = content.substr(content.rfind("\r\033[2K"));
+    CHECK_EQ(std::count(tail.begin(), tail.end(), '.'), 2);
+}
+
+/**
+ * @brief 两个 StatusIndicator 交替绘制时各自整行重绘；帧内的最后几次 Tick 由 Flush 画出
+ */
+void TestStatusIndicators() {
+    StdoutToFile redirect(TempPath("indicator_status"));
+    {
+        ColorPrinter::StatusIndicator first(PrintColor::GREEN);
+        ColorPrinter::StatusIndicator second(PrintColor::RED);
+        first.Tick();
+        second.Tick();
+        first.Tick();
+        CHECK_EQ(first.Ticks(), 2u);
+    }
+    std::string content = redirect.Finish();
+    // 三次 Tick 与两次析构时的 Flush（先 second 后 first），每次都因对方画过而整行重绘
+    CHECK_EQ(CountOf(content, "[INFO] "), 5u);
+    CHECK_EQ(CountOf(content, "\r\033[2K"), 5u);
+    const std::string tail = content.substr(content.rfind("\r\033[2K"));
+    CHECK_EQ(std::count(tail.begin(), tail.end(), '.'), 2);
+
+    ColorPrinter::SetIndicatorFrameRate(1);  // 一秒一帧：第一次之后的 Tick 都在同一帧内
+    StdoutToFile throttled(TempPath("indicator_flush"));
+    ColorPrinter::StatusIndicator alive(PrintColor::GREEN);
+    for (int i = 0; i < 5; i++) {
+        alive.Tick();
+    }
+    alive.Flush();
+    content = throttled.Finish();
+    CHECK_EQ(std::count(content.begin(), content.end(), '.'), 5);
+    ColorPrinter::SetIndicatorFrameRate(0);
+}
+
+} // namespace
+
+int main() {
+    ColorPrinter::SetIndicatorFrameRate(0);
+    TestOutOfRangeCounter();
+    TestOtherThreadForcesRedraw();
+    TestStatusIndicators();
+    std::printf("test_indicator: 通过\n");
+    return 0;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file test_journal_sink.cpp
+ * @brief JournalSink 的测试：用本地 unix 数据报套接字代替 journald / syslog 守护进程，
+ *        检查 sendmmsg 发出的报文字段、优先级映射与回退到 syslog
+ */
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "color_printer_journal_sink.h"
+#include "test_common.h"
+
+namespace {
+
+std::string TempPath(const char* name) {
+    return "/tmp/cp_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+/**
+ * @class Receiver
+ * @brief 绑定在 path 上的数据报接收端
+ */
+class Receiver {
+public:
+    explicit Receiver(std::string path) : path_(std::move(path)) {
+        ::unlink(path_.c_str());
+        fd_ = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        CHECK(fd_ >= 0);
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path_.data(), path_.size());
+        CHECK(::bind(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+        int buffer = 4 * 1024 * 1024;
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+        timeval timeout{1, 0};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+
+    ~Receiver() {
+        ::close(fd_);
+        ::unlink(path_.c_str());
+    }
+
+    /**
+     * @brief 收取一个报文，超时返回false
+     */
+    bool Receive(std::string& datagram) {
+        datagram.resize(64 * 1024);
+        const ssize_t length = ::recv(fd_, datagram.data(), datagram.size(), 0);
+        if (length < 0) {
+            return false;
+        }
+        datagram.resize(static_cast<size_t>(length));
+        return true;
+    }
+
+    /**
+     * @brief 确认没有更多报文
+     */
+    bool Empty() {
+        char byte;
+        return ::recv(fd_, &byte, 1, MSG_DONTWAIT) < 0;
+    }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+};
+
+/**
+ * @brief 解析 journald 原生协议报文（含二进制长度形式的字段）
+ */
+std::map<std::string, std::string> ParseJournal(const std::string& datagram) {
+    std::map<std::string, std::string> fields;
+    size_t offset = 0;
+    while (offset < datagram.size()) {
+        const size_t end = datagram.find_first_of("=\n", offset);
+        CHECK(end != std::string::npos);
+        const std::string name = datagram.substr(offset, end - offset);
+        if (datagram[end] == '=') {
+            const size_t newline = datagram.find('\n', end);
+            CHECK(newline != std::string::npos);
+            fields[name] = datagram.substr(end + 1, newline - end - 1);
+            offset = newline + 1;
+        } else {
+            CHECK(end + 9 <= datagram.size());
+            uint64_t length = 0;
+            for (int i = 7; i >= 0; i--) {
+                length = (length << 8) | static_cast<unsigned char>(datagram[end + 1 + static_cast<size_t>(i)]);
+            }
+            fields[name] = datagram.substr(end + 9, length);
+            CHECK_EQ(datagram[end + 9 + length], '\n');
+            offset = end + 10 + length;
+        }
+    }
+    return fields;
+}
+
+struct Message {
+    PrintColor color;
+    LogLevel level;
+    std::string type;
+    std::string message;
+    std::string line;
+};
+
+void Send(JournalSink& sink, const std::vector<Message>& messages) {
+    std::vector<LogRecord> records;
+    for (const Message& m : messages) {
+        records.push_back(LogRecord{m.color, m.level, m.type, m.message, m.line});
+    }
+    sink.Write(records.data(), records.size());
+}
+
+Message MakeMessage(PrintColor color, LogLevel level, const std::string& type, const std::string& message) {
+    return Message{color, level, type, message, "[" + type + "] " + message + "\n"};
+}
+
+void TestPriorityMapping() {
+    CHECK_EQ(JournalSink::PriorityForLevel(LogLevel::DEBUG), 7);
+    CHECK_EQ(JournalSink::PriorityForLevel(LogLevel::INFO), 6);
+    CHECK_EQ(JournalSink::PriorityForLevel(LogLevel::OK), 5);
+    CHECK_EQ(JournalSink::PriorityForLevel(LogLevel::WARNING), 4);
+    CHECK_EQ(JournalSink::PriorityForLevel(LogLevel::ERROR), 3);
+    CHECK_EQ(JournalSink::PriorityForLevel(LogLevel::FATAL), 2);
+}
+
+/**
+ * @brief 一批超过单次 sendmmsg 上限的消息全部按顺序到达，字段与优先级正确
+ */
+void TestJournaldFields() {
+    Receiver receiver(TempPath("journal.sock"));
+    JournalOptions options;
+    options.socket_path = TempPath("journal.sock");
+    options.identifier = "unit-test";
+    options.fields = {{"SERVICE_REGION", "eu-1"}};
+    JournalSink sink(options);
+    CHECK(sink.ActiveProtocol() == JournalProtocol::JOURNALD);
+
+    const LogLevel levels[] = {LogLevel::DEBUG, LogLevel::INFO, LogLevel::OK,
+                               LogLevel::WARNING, LogLevel::ERROR, LogLevel::FATAL};
+    const char* types[] = {"DEBUG", "INFO", "OK", "WARNING", "ERROR", "FATAL"};
+    std::vector<Message> messages;
+    for (int i = 0; i < 600; i++) {
+        messages.push_back(MakeMessage(static_cast<PrintColor>(i % 7), levels[i % 6], types[i % 6],
+                                       "message " + std::to_string(i)));
+    }
+    messages.push_back(MakeMessage(PrintColor::RED, LogLevel::ERROR, "ERROR", "first line\nsecond line"));
+    // 数据报套接字的接收队列很短，边发送边接收
+    std::thread sender([&] { Send(sink, messages); });
+
+    const char* colors[] = {"RED", "GREEN", "YELLOW", "BLUE", "MAGENTA", "CYAN", "WHITE"};
+    std::string datagram;
+    for (size_t i = 0; i < messages.size(); i++) {
+        CHECK(receiver.Receive(datagram));
+        std::map<std::string, std::string> fields = ParseJournal(datagram);
+        CHECK_EQ(fields["MESSAGE"], messages[i].message);
+        CHECK_EQ(fields["PRIORITY"], std::to_string(JournalSink::PriorityForLevel(messages[i].level)));
+        CHECK_EQ(fields["SYSLOG_IDENTIFIER"], "unit-test");
+        CHECK_EQ(fields["COLOR_PRINTER_TYPE"], messages[i].type);
+        CHECK_EQ(fields["COLOR_PRINTER_COLOR"], colors[static_cast<size_t>(messages[i].color)]);
+        CHECK_EQ(fields["SERVICE_REGION"], "eu-1");
+        CHECK_EQ(fields.size(), 6u);
+    }
+    sender.join();
+    CHECK(receiver.Empty());
+    CHECK_EQ(sink.Dropped(), 0u);
+}
+
+/**
+ * @brief syslog 协议：<设施×8+优先级>时间 标签[pid]: [类型] 消息
+ */
+void CheckSyslog(const std::string& datagram, int facility, const Message& message, const std::string& tag) {
+    const std::string priority = "<" + std::to_string(facility * 8 + JournalSink::PriorityForLevel(message.level)) + ">";
+    CHECK_EQ(datagram.compare(0, priority.size(), priority), 0);
+    const std::string suffix = " " + tag + "[" + std::to_string(::getpid()) + "]: [" + message.type + "] " +
+                               message.message;
+    CHECK(datagram.size() > priority.size() + suffix.size());
+    CHECK_EQ(datagram.substr(datagram.size() - suffix.size()), suffix);
+}
+
+void TestSyslogProtocol() {
+    Receiver receiver(TempPath("syslog.sock"));
+    JournalOptions options;
+    options.protocol = JournalProtocol::SYSLOG;
+    options.socket_path = TempPath("syslog.sock");
+    options.identifier = "tagged";
+    options.facility = 16;  // LOG_LOCAL0
+    JournalSink sink(options);
+    CHECK(sink.ActiveProtocol() == JournalProtocol::SYSLOG);
+
+    const std::vector<Message> messages = {
+        MakeMessage(PrintColor::GREEN, LogLevel::INFO, "INFO", "hello"),
+        MakeMessage(PrintColor::RED, LogLevel::FATAL, "FATAL", "bye"),
+    };
+    Send(sink, messages);
+    std::string datagram;
+    for (const Message& message : messages) {
+        CHECK(receiver.Receive(datagram));
+        CheckSyslog(datagram, 16, message, "tagged");
+    }
+    CHECK(receiver.Empty());
+}
+
+/**
+ * @brief journald 不存在时回退到 syslog；关闭回退时消息计入丢弃
+ */
+void TestSyslogFallback() {
+    auto receiver = std::make_unique<Receiver>(TempPath("fallback.sock"));
+    JournalOptions options;
+    options.socket_path = TempPath("missing-journal.sock");
+    options.syslog_socket_path = TempPath("fallback.sock");
+    options.identifier = "fallback";
+    JournalSink sink(options);
+    CHECK(sink.ActiveProtocol() == JournalProtocol::SYSLOG);
+
+    const std::vector<Message> messages = {MakeMessage(PrintColor::YELLOW, LogLevel::WARNING, "WARNING", "no journald")};
+    Send(sink, messages);
+    std::string datagram;
+    CHECK(receiver->Receive(datagram));
+    CheckSyslog(datagram, 1, messages[0], "fallback");
+
+    // journald 出现后，重新连接时优先使用 journald
+    {
+        Receiver journal(TempPath("missing-journal.sock"));
+        receiver.reset();  // syslog 接收端退出，发送失败后重新连接
+        Send(sink, messages);
+        CHECK(sink.ActiveProtocol() == JournalProtocol::JOURNALD);
+        CHECK(journal.Receive(datagram));
+        CHECK_EQ(ParseJournal(datagram)["MESSAGE"], "no journald");
+    }
+
+    options.syslog_fallback = false;
+    JournalSink strict(options);
+    Send(strict, messages);
+    CHECK_EQ(strict.Dropped(), 1u);
+}
+
+/**
+ * @brief 接收端重启后自动重新连接
+ */
+void TestReconnect() {
+    const std::string path = TempPath("restart.sock");
+    JournalOptions options;
+    options.socket_path = path;
+    options.syslog_fallback = false;
+    const std::vector<Message> messages = {MakeMessage(PrintColor::WHITE, LogLevel::INFO, "INFO", "again")};
+    std::string datagram;
+
+    auto first = std::make_unique<Receiver>(path);
+    JournalSink sink(options);
+    Send(sink, messages);
+    CHECK(first->Receive(datagram));
+    first.reset();
+
+    Send(sink, messages);  // 接收端不在，丢弃
+    CHECK_EQ(sink.Dropped(), 1u);
+
+    Receiver second(path);
+    Send(sink, messages);
+    CHECK(second.Receive(datagram));
+    CHECK_EQ(ParseJournal(datagram)["MESSAGE"], "again");
+    CHECK_EQ(sink.Dropped(), 1u);
+}
+
+} // namespace
+
+int main() {
+    TestPriorityMapping();
+    TestJournaldFields();
+    TestSyslogProtocol();
+    TestSyslogFallback();
+    TestReconnect();
+    std::printf("test_journal_sink: 通过\n");
+    return 0;
+}
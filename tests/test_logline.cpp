@@ -0,0 +1,89 @@
+/**
+ * @file test_logline.cpp
+ * @brief 日志行解析（ParseTimestamp / ParseLine）的测试
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "color_printer_logline.h"
+#include "test_common.h"
+
+using namespace color_printer_detail;
+
+namespace {
+
+size_t Parse(const char* text, int64_t& millis) {
+    return ParseTimestamp(text, std::strlen(text), millis);
+}
+
+void TestParseTimestamp() {
+    int64_t millis = 0;
+    CHECK_EQ(Parse("1970-01-01 00:00:00", millis), 19u);
+    CHECK_EQ(millis, 0);
+    CHECK_EQ(Parse("1970-01-02T00:00:01.250 rest", millis), 23u);
+    CHECK_EQ(millis, 86401250);
+    // 2000-03-01 跨过闰日：与 1970-01-01 相差 11017 天
+    CHECK_EQ(Parse("2000-03-01 00:00:00", millis), 19u);
+    CHECK_EQ(millis, int64_t(11017) * 86400 * 1000);
+    CHECK_EQ(Parse("1969-12-31 23:59:59", millis), 19u);
+    CHECK_EQ(millis, -1000);
+
+    // 毫秒部分不完整时只解析到秒
+    CHECK_EQ(Parse("2026-10-17 10:00:00.5", millis), 19u);
+
+    // 先后顺序与字面值一致
+    int64_t earlier = 0;
+    int64_t later = 0;
+    Parse("2026-10-17 09:59:59.999", earlier);
+    Parse("2026-10-17 10:00:00.000", later);
+    CHECK_EQ(later - earlier, 1);
+
+    CHECK_EQ(Parse("2026-10-17 10:00", millis), 0u);        // 太短
+    CHECK_EQ(Parse("2026/10/17 10:00:00", millis), 0u);     // 分隔符不对
+    CHECK_EQ(Parse("2026-10-17_10:00:00", millis), 0u);
+    CHECK_EQ(Parse("2026-1a-17 10:00:00", millis), 0u);
+    CHECK_EQ(Parse("[INFO] 2026-10-17 10:00:00", millis), 0u);  // 只识别行首
+}
+
+void TestParseLine() {
+    ParsedLine parsed = ParseLine("[ERROR] disk full");
+    CHECK(parsed.level == LogLevel::ERROR);
+    CHECK_EQ(parsed.time, kNoTime);
+    CHECK_EQ(parsed.plain, "[ERROR] disk full");
+
+    // 颜色代码与时间戳
+    parsed = ParseLine("\033[33m2026-10-17 10:00:00.123 [WARNING] slow\033[0m");
+    CHECK(parsed.level == LogLevel::WARNING);
+    CHECK_EQ(parsed.plain, "2026-10-17 10:00:00.123 [WARNING] slow");
+    int64_t expected = 0;
+    Parse("2026-10-17 10:00:00.123", expected);
+    CHECK_EQ(parsed.time, expected);
+
+    // 类型不区分大小写；识别不出的类型与没有类型的行按 INFO 处理
+    CHECK(ParseLine("[fatal] x").level == LogLevel::FATAL);
+    CHECK(ParseLine("[DEBUG] x").level == LogLevel::DEBUG);
+    CHECK(ParseLine("[CUSTOM] x").level == LogLevel::INFO);
+    CHECK(ParseLine("no brackets at all").level == LogLevel::INFO);
+    CHECK(ParseLine("[ERROR without close").level == LogLevel::INFO);
+    CHECK(ParseLine("[AN_EXTREMELY_LONG_TYPE] x").level == LogLevel::INFO);  // 超过16字节不当作类型
+
+    // 时间戳后没有类型：有时间，级别为 INFO
+    parsed = ParseLine("2026-10-17 10:00:00 continuation");
+    CHECK(parsed.time != kNoTime);
+    CHECK(parsed.level == LogLevel::INFO);
+
+    parsed = ParseLine("");
+    CHECK(parsed.plain.empty());
+    CHECK_EQ(parsed.time, kNoTime);
+}
+
+} // namespace
+
+int main() {
+    TestParseTimestamp();
+    TestParseLine();
+    std::printf("test_logline: 通过\n");
+    return 0;
+}
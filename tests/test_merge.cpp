@@ -0,0 +1,150 @@
+/**
+ * @file test_merge.cpp
+ * @brief color_printer_merge 的测试：按时间戳归并、续行跟随所在记录，很长的记录与很长的行不占用成比例的内存
+ *        通过命令行调用工具，参数为 color_printer_merge 的路径
+ */
+
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "test_common.h"
+
+namespace {
+
+const char* g_merge = nullptr;
+
+struct MergeResult {
+    std::string out;
+    size_t out_bytes = 0;
+    long max_rss_kb = 0;
+};
+
+/**
+ * @brief 运行 color_printer_merge；keep_output 为false时只统计输出的字节数
+ */
+MergeResult Merge(const std::vector<std::string>& args, bool keep_output = true) {
+    int fds[2];
+    CHECK(::pipe(fds) == 0);
+    const pid_t pid = ::fork();
+    CHECK(pid >= 0);
+    if (pid == 0) {
+        ::dup2(fds[1], STDOUT_FILENO);
+        ::close(fds[0]);
+        ::close(fds[1]);
+        std::vector<const char*> argv = {g_merge, "--no-color"};
+        for (const std::string& arg : args) {
+            argv.push_back(arg.c_str());
+        }
+        argv.push_back(nullptr);
+        ::execv(g_merge, const_cast<char* const*>(argv.data()));
+        ::_exit(127);
+    }
+    ::close(fds[1]);
+    MergeResult result;
+    char buffer[65536];
+    ssize_t length;
+    while ((length = ::read(fds[0], buffer, sizeof(buffer))) != 0) {
+        if (length > 0) {
+            result.out_bytes += static_cast<size_t>(length);
+            if (keep_output) {
+                result.out.append(buffer, static_cast<size_t>(length));
+            }
+        }
+    }
+    ::close(fds[0]);
+    int status = 0;
+    rusage usage;
+    CHECK(::wait4(pid, &status, 0, &usage) == pid);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    result.max_rss_kb = usage.ru_maxrss;
+    return result;
+}
+
+void WriteFile(const std::string& path, const std::string& content) {
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0);
+    CHECK(::write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size()));
+    ::close(fd);
+}
+
+std::string TempPath(const char* name) {
+    return "/tmp/cp_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+void TestInterleave() {
+    const std::string a = TempPath("merge_a.log");
+    const std::string b = TempPath("merge_b.log");
+    WriteFile(a, "2026-10-17 10:00:00 [INFO] a1\n"
+                 "2026-10-17 10:00:02 [ERROR] a2\n"
+                 "    at frame 1\n"
+                 "    at frame 2\n");
+    WriteFile(b, "2026-10-17 10:00:01 [INFO] b1\n"
+                 "2026-10-17 10:00:02 [INFO] b2\n"
+                 "2026-10-17 10:00:03 [INFO] b3");  // 最后一行没有换行
+    const std::string tag_a = a.substr(a.rfind('/') + 1);
+    const std::string tag_b = b.substr(b.rfind('/') + 1);
+    CHECK_EQ(Merge({a, b}).out, "[" + tag_a + "] 2026-10-17 10:00:00 [INFO] a1\n" +
+                                    "[" + tag_b + "] 2026-10-17 10:00:01 [INFO] b1\n" +
+                                    "[" + tag_a + "] 2026-10-17 10:00:02 [ERROR] a2\n" +
+                                    "[" + tag_a + "]     at frame 1\n" +
+                                    "[" + tag_a + "]     at frame 2\n" +
+                                    "[" + tag_b + "] 2026-10-17 10:00:02 [INFO] b2\n" +
+                                    "[" + tag_b + "] 2026-10-17 10:00:03 [INFO] b3\n");
+    ::unlink(a.c_str());
+    ::unlink(b.c_str());
+}
+
+/**
+ * @brief 一条带时间戳的行，之后全是续行（其中一行超过 1 MB）
+ */
+std::string HugeRecord() {
+    std::string content = "2026-10-17 10:00:00 [INFO] start\n";
+    const std::string continuation(99, 'c');
+    while (content.size() < 48 * 1024 * 1024) {
+        content += continuation;
+        content += '\n';
+    }
+    content += std::string(8 * 1024 * 1024, 'L');
+    content += '\n';
+    return content;
+}
+
+/**
+ * @brief 整个文件是一条很长的记录：输出完整，常驻内存远小于文件大小
+ */
+void TestHugeRecord() {
+    const std::string path = TempPath("merge_huge.log");
+    size_t size;
+    {
+        const std::string content = HugeRecord();
+        WriteFile(path, content);
+        size = content.size();
+    }
+    // 此时测试进程不持有文件内容，fork 出的子进程的 ru_maxrss 只反映工具自身
+    const MergeResult result = Merge({"--no-tag", path}, false);
+    CHECK_EQ(result.out_bytes, size);
+    // 修复前整条记录先拼进输出缓冲区，且整个映射常驻：超过 100 MB
+    CHECK(result.max_rss_kb < 40 * 1024);
+
+    CHECK(Merge({"--no-tag", path}).out == HugeRecord());
+    ::unlink(path.c_str());
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "用法: %s <color_printer_merge 的路径>\n", argv[0]);
+        return 2;
+    }
+    g_merge = argv[1];
+    TestInterleave();
+    TestHugeRecord();
+    std::printf("test_merge: 通过\n");
+    return 0;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file test_mmap_sink.cpp
+ * @brief MmapRingSink 的测试：写入与按时间顺序读回、同容量续写、拒绝打开其他文件、
+ *        回绕与未提交的帧
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#include "color_printer_mmap_sink.h"
+#include "test_common.h"
+
+namespace {
+
+std::string TempPath(const char* name) {
+    return "/tmp/cp_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief 把 [first, first + count) 编号的行作为一批写入，返回写入的内容
+ */
+std::string WriteLines(MmapRingSink& sink, int first, int count) {
+    std::vector<std::string> lines;
+    std::string expected;
+    for (int i = first; i < first + count; i++) {
+        lines.push_back("[INFO] line " + std::to_string(i) + "\n");
+        expected += lines.back();
+    }
+    std::vector<LogRecord> records;
+    for (const std::string& line : lines) {
+        records.push_back({PrintColor::WHITE, LogLevel::INFO, "INFO", std::string_view(line).substr(7, line.size() - 8), line});
+    }
+    sink.Write(records.data(), records.size());
+    return expected;
+}
+
+void TestWriteAndReopen() {
+    const std::string path = TempPath("ring");
+    ::unlink(path.c_str());
+    std::string expected;
+    {
+        MmapRingSink sink(path, 64 * 1024);
+        CHECK(sink.IsOpen());
+        expected += WriteLines(sink, 0, 10);
+    }
+    {
+        MmapRingSink sink(path, 64 * 1024);  // 同容量：保留历史继续追加
+        CHECK(sink.IsOpen());
+        expected += WriteLines(sink, 10, 10);
+    }
+    std::string content;
+    CHECK(MmapRingSink::ReadChronological(path, content));
+    CHECK_EQ(content, expected);
+    ::unlink(path.c_str());
+}
+
+/**
+ * @brief 非空且不是同容量环形日志的文件拒绝打开，内容和大小保持不变
+ */
+void TestRefusesForeignFile() {
+    const std::string path = TempPath("foreign");
+    const std::string text = "这不是环形日志\n";
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << text;
+    }
+    {
+        MmapRingSink sink(path, 64 * 1024);
+        CHECK(!sink.IsOpen());
+        WriteLines(sink, 0, 3);  // 未打开时写入被丢弃
+    }
+    CHECK_EQ(ReadFile(path), text);
+    ::unlink(path.c_str());
+
+    const std::string ring = TempPath("mismatch");
+    ::unlink(ring.c_str());
+    {
+        MmapRingSink sink(ring, 64 * 1024);
+        CHECK(sink.IsOpen());
+        WriteLines(sink, 0, 5);
+    }
+    const std::string before = ReadFile(ring);
+    {
+        MmapRingSink sink(ring, 32 * 1024);  // 容量不同
+        CHECK(!sink.IsOpen());
+    }
+    CHECK(ReadFile(ring) == before);
+    ::unlink(ring.c_str());
+}
+
+/**
+ * @brief 把读回的内容拆成行号；每行必须是完整的 "[INFO] line N"
+ */
+std::vector<int> LineNumbers(const std::string& content) {
+    std::vector<int> numbers;
+    size_t start = 0;
+    while (start < content.size()) {
+        const size_t end = content.find('\n', start);
+        CHECK(end != std::string::npos);
+        const std::string line = content.substr(start, end - start);
+        CHECK(line.rfind("[INFO] line ", 0) == 0);
+        numbers.push_back(std::stoi(line.substr(12)));
+        start = end + 1;
+    }
+    return numbers;
+}
+
+/**
+ * @brief 回绕多圈后读回的是以最后一行结束的连续后缀
+ */
+void TestWrap() {
+    const std::string path = TempPath("wrap");
+    ::unlink(path.c_str());
+    MmapRingSink sink(path, 1000);  // 不是8的倍数：只用前 1000 & ~7 字节
+    CHECK(sink.IsOpen());
+    int next = 0;
+    for (int batch = 0; batch < 200; batch++) {
+        const int count = 1 + batch % 7;
+        WriteLines(sink, next, count);
+        next += count;
+    }
+    std::string content;
+    CHECK(MmapRingSink::ReadChronological(path, content));
+    const std::vector<int> numbers = LineNumbers(content);
+    CHECK(numbers.size() > 10);
+    CHECK_EQ(numbers.back(), next - 1);
+    for (size_t i = 1; i < numbers.size(); i++) {
+        CHECK_EQ(numbers[i], numbers[i - 1] + 1);
+    }
+    ::unlink(path.c_str());
+}
+
+/**
+ * @brief 模拟写入方预留了一帧但没有写完（正在拷贝或已崩溃）：
+ *        回绕后该位置残留的上一圈旧行和写了一半的正文都不应被读出
+ */
+void TestUncommittedFrame() {
+    const std::string path = TempPath("partial");
+    ::unlink(path.c_str());
+    const uint64_t capacity = 4096;
+    MmapRingSink sink(path, capacity);
+    CHECK(sink.IsOpen());
+    int next = 0;
+    while (next < 1000) {  // 写满几圈，数据区全是旧帧
+        WriteLines(sink, next, 3);
+        next += 3;
+    }
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    CHECK(fd >= 0);
+    const size_t file_bytes = MmapRingHeader::kDataOffset + capacity;
+    void* mapping = ::mmap(nullptr, file_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    CHECK(mapping != MAP_FAILED);
+    auto* header = static_cast<MmapRingHeader*>(mapping);
+    char* data = static_cast<char*>(mapping) + MmapRingHeader::kDataOffset;
+
+    // 预留一帧，只写长度和一半正文，不写提交标记
+    const std::string torn = "[INFO] line 999999 写了一半";
+    const uint64_t frame_bytes = MmapRingHeader::FrameBytes(512);
+    const uint64_t frame = header->head.fetch_add(frame_bytes);
+    const uint64_t length = 512;
+    std::memcpy(data + (frame + 8) % capacity, &length, sizeof(length));
+    for (size_t i = 0; i < torn.size(); i++) {
+        data[(frame + MmapRingHeader::kFrameHeader + i) % capacity] = torn[i];
+    }
+
+    std::string content;
+    CHECK(MmapRingSink::ReadChronological(path, content));
+    std::vector<int> numbers = LineNumbers(content);
+    CHECK(!numbers.empty());
+    CHECK_EQ(numbers.back(), next - 1);
+    for (size_t i = 1; i < numbers.size(); i++) {
+        CHECK_EQ(numbers[i], numbers[i - 1] + 1);
+    }
+
+    // 之后提交的帧照常读出，未提交的帧被跳过
+    WriteLines(sink, next, 3);
+    next += 3;
+    CHECK(MmapRingSink::ReadChronological(path, content));
+    numbers = LineNumbers(content);
+    CHECK_EQ(numbers.back(), next - 1);
+    for (size_t i = 1; i < numbers.size(); i++) {
+        CHECK_EQ(numbers[i], numbers[i - 1] + 1);
+    }
+    CHECK(content.find("写了一半") == std::string::npos);
+
+    ::munmap(mapping, file_bytes);
+    ::unlink(path.c_str());
+}
+
+} // namespace
+
+int main() {
+    TestWriteAndReopen();
+    TestRefusesForeignFile();
+    TestWrap();
+    TestUncommittedFrame();
+    std::printf("test_mmap_sink: 通过\n");
+    return 0;
+}
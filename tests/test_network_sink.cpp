@@ -0,0 +1,249 @@
+/**
+ * @file test_network_sink.cpp
+ * @brief NetworkSink 与 color_printer_collector 在本机回环上的测试：
+ *        收集端被杀死期间批次留在本地缓存、按退避重连后补发，缓存溢出的消息计入丢弃，
+ *        重启后的收集端按序号统计到同样数量的丢失
+ *
+ *        用法: test_network_sink <color_printer_collector 的路径>
+ */
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <netinet/in.h>
+#include <sstream>
+#include <string>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "color_printer_network_sink.h"
+#include "test_common.h"
+
+namespace {
+
+const char* g_collector = nullptr;
+
+std::string TempPath(const char* name) {
+    return "/tmp/cp_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+std::vector<std::string> ReadLines(const std::string& path) {
+    std::ifstream in(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(in, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+/**
+ * @brief 向内核要一个当前空闲的回环端口
+ */
+uint16_t FreePort() {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK(::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    socklen_t length = sizeof(address);
+    CHECK(::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) == 0);
+    ::close(fd);
+    return ntohs(address.sin_port);
+}
+
+/**
+ * @brief 启动收集端，标准输出与标准错误重定向到文件，等到端口可以连接后返回
+ */
+pid_t StartCollector(uint16_t port, const std::string& out_path, const std::string& err_path,
+                     const std::vector<std::string>& extra = {}) {
+    const pid_t pid = ::fork();
+    CHECK(pid >= 0);
+    if (pid == 0) {
+        const int out = ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        const int err = ::open(err_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ::dup2(out, STDOUT_FILENO);
+        ::dup2(err, STDERR_FILENO);
+        const std::string port_text = std::to_string(port);
+        std::vector<const char*> argv = {g_collector, "--tcp", "--print", "--port", port_text.c_str()};
+        for (const std::string& arg : extra) {
+            argv.push_back(arg.c_str());
+        }
+        argv.push_back(nullptr);
+        ::execv(g_collector, const_cast<char* const*>(argv.data()));
+        ::_exit(127);
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (true) {
+        const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address;
+        std::memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        const bool up = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        ::close(fd);
+        if (up) {
+            return pid;
+        }
+        CHECK(std::chrono::steady_clock::now() < deadline);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+template <typename Predicate>
+bool WaitFor(Predicate predicate, std::chrono::milliseconds limit) {
+    const auto deadline = std::chrono::steady_clock::now() + limit;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+/**
+ * @brief 等待子进程退出，返回退出码；超时视为失败
+ */
+int WaitExit(pid_t pid, std::chrono::milliseconds limit) {
+    int status = 0;
+    CHECK(WaitFor([&] { return ::waitpid(pid, &status, WNOHANG) == pid; }, limit));
+    CHECK(WIFEXITED(status));
+    return WEXITSTATUS(status);
+}
+
+void Write(NetworkSink& sink, int first, int count) {
+    std::vector<std::string> lines;
+    for (int i = first; i < first + count; i++) {
+        lines.push_back("[INFO] msg " + std::to_string(i) + "\n");
+    }
+    std::vector<LogRecord> records;
+    for (const std::string& line : lines) {
+        records.push_back(LogRecord{PrintColor::WHITE, LogLevel::INFO, "INFO",
+                                    std::string_view(line).substr(7, line.size() - 8), line});
+    }
+    sink.Write(records.data(), records.size());
+}
+
+/**
+ * @brief 从收集端最后一行统计中取出 "名称 数字"
+ */
+uint64_t StatField(const std::string& err_path, const std::string& name) {
+    const std::vector<std::string> lines = ReadLines(err_path);
+    CHECK(!lines.empty());
+    std::istringstream stats(lines.back());
+    std::string word;
+    while (stats >> word) {
+        if (word == name) {
+            uint64_t value = 0;
+            stats >> value;
+            return value;
+        }
+    }
+    CHECK(!"统计行中没有该字段");
+    return 0;
+}
+
+/**
+ * @brief 收集端的输出中消息序号严格递增，返回消息条数
+ */
+size_t CheckIncreasing(const std::vector<std::string>& lines, int* last) {
+    size_t count = 0;
+    *last = -1;
+    for (const std::string& line : lines) {
+        if (line.rfind("[INFO] msg ", 0) != 0) {
+            continue;  // 收集端自己的提示
+        }
+        const int index = std::atoi(line.c_str() + 11);
+        CHECK(index > *last);
+        *last = index;
+        count++;
+    }
+    return count;
+}
+
+void TestKillAndRestart() {
+    const uint16_t port = FreePort();
+    const std::string out1 = TempPath("collector1.out");
+    const std::string err1 = TempPath("collector1.err");
+    const std::string out2 = TempPath("collector2.out");
+    const std::string err2 = TempPath("collector2.err");
+
+    NetworkOptions options;
+    options.port = port;
+    options.batch_bytes = 1024;
+    options.batch_interval = std::chrono::milliseconds(10);
+    options.spool_bytes = 16 * 1024;
+    options.reconnect_min = std::chrono::milliseconds(20);
+    options.reconnect_max = std::chrono::milliseconds(200);
+    options.flush_timeout = std::chrono::milliseconds(5000);
+
+    // 阶段一：收集端正常接收
+    pid_t collector = StartCollector(port, out1, err1);
+    NetworkSink sink(options);
+    Write(sink, 0, 100);
+    sink.Flush();
+    CHECK_EQ(sink.Sent(), 100u);
+    int last = -1;
+    CHECK(WaitFor([&] { return CheckIncreasing(ReadLines(out1), &last) == 100; }, std::chrono::milliseconds(3000)));
+    CHECK(sink.Connected());
+
+    // 阶段二：杀死收集端；之后的批次留在缓存中，超出缓存上限的最旧批次被丢弃
+    ::kill(collector, SIGKILL);
+    ::waitpid(collector, nullptr, 0);
+    Write(sink, 100, 50);
+    CHECK(WaitFor([&] { return !sink.Connected(); }, std::chrono::milliseconds(3000)));
+    CHECK_EQ(sink.Sent(), 100u);
+    Write(sink, 150, 2000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));  // 期间按退避反复重连失败
+    CHECK(!sink.Connected());
+    CHECK_EQ(sink.Sent(), 100u);
+    const uint64_t dropped = sink.Dropped();
+    CHECK(dropped > 0);
+    CHECK(dropped < 2050);
+
+    // 阶段三：在同一端口重启收集端，缓存中的批次在一个退避间隔内补发
+    const uint64_t total = 2150;
+    collector = StartCollector(port, out2, err2, {"--expect", std::to_string(total)});
+    sink.Flush();
+    CHECK(sink.Connected());
+    CHECK_EQ(sink.Sent() + sink.Dropped(), total);
+    CHECK_EQ(sink.Dropped(), dropped);
+    CHECK_EQ(WaitExit(collector, std::chrono::milliseconds(5000)), 3);  // 有丢失时退出码为3
+
+    // 重启后的收集端：阶段一的消息与缓存溢出丢弃的消息都表现为序号空缺
+    const size_t replayed = CheckIncreasing(ReadLines(out2), &last);
+    CHECK_EQ(replayed, total - 100 - dropped);
+    CHECK_EQ(last, 2149);
+    CHECK_EQ(StatField(err2, "消息"), replayed);
+    CHECK_EQ(StatField(err2, "丢失"), 100 + dropped);
+    CHECK_EQ(StatField(err2, "重复"), 0u);
+
+    for (const std::string& path : {out1, err1, out2, err2}) {
+        ::unlink(path.c_str());
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "用法: %s <color_printer_collector 的路径>\n", argv[0]);
+        return 2;
+    }
+    g_collector = argv[1];
+    ::signal(SIGPIPE, SIG_IGN);
+    color_printer_test::RunWithTimeout(std::chrono::seconds(60), TestKillAndRestart);
+    std::printf("test_network_sink: 通过\n");
+    return 0;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file test_query.cpp
+ * @brief color_printer_query 的索引测试：增量更新、文件被替换或改写时重建、长行不被切到两个块中
+ *        通过命令行调用工具，参数为 color_printer_query 的路径
+ */
+
+#include <cstdio>
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "test_common.h"
+
+namespace {
+
+const char* g_query = nullptr;
+
+/**
+ * @brief 运行 color_printer_query，返回它的标准输出
+ */
+std::string Query(std::vector<std::string> args) {
+    int fds[2];
+    CHECK(::pipe(fds) == 0);
+    const pid_t pid = ::fork();
+    CHECK(pid >= 0);
+    if (pid == 0) {
+        ::dup2(fds[1], STDOUT_FILENO);
+        ::close(fds[0]);
+        ::close(fds[1]);
+        std::vector<const char*> argv = {g_query, "--no-color", "--threads", "2"};
+        for (const std::string& arg : args) {
+            argv.push_back(arg.c_str());
+        }
+        argv.push_back(nullptr);
+        ::execv(g_query, const_cast<char* const*>(argv.data()));
+        ::_exit(127);
+    }
+    ::close(fds[1]);
+    std::string out;
+    char buffer[65536];
+    ssize_t length;
+    while ((length = ::read(fds[0], buffer, sizeof(buffer))) != 0) {
+        if (length > 0) {
+            out.append(buffer, static_cast<size_t>(length));
+        }
+    }
+    ::close(fds[0]);
+    int status = 0;
+    ::waitpid(pid, &status, 0);
+    CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    return out;
+}
+
+void WriteFile(const std::string& path, const std::string& content, int flags = O_TRUNC) {
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | flags, 0644);
+    CHECK(fd >= 0);
+    CHECK(::write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size()));
+    ::close(fd);
+}
+
+/**
+ * @brief count 行 "2026-10-17 10:MM:SS [类型] 正文 序号"，类型长度相同时每行等长
+ */
+std::string MakeLines(const char* type, const char* text, int count) {
+    std::string out;
+    char line[128];
+    for (int i = 0; i < count; i++) {
+        std::snprintf(line, sizeof(line), "2026-10-17 10:%02d:%02d [%s] %s %06d\n", i / 60 % 60, i % 60, type, text,
+                      i);
+        out += line;
+    }
+    return out;
+}
+
+size_t CountLines(const std::string& text) {
+    size_t lines = 0;
+    for (char c : text) {
+        lines += c == '\n';
+    }
+    return lines;
+}
+
+timespec MtimeOf(const std::string& path) {
+    struct stat info;
+    CHECK(::stat(path.c_str(), &info) == 0);
+    return info.st_mtim;
+}
+
+void SetMtime(const std::string& path, timespec mtime) {
+    const timespec times[2] = {mtime, mtime};
+    CHECK(::utimensat(AT_FDCWD, path.c_str(), times, 0) == 0);
+}
+
+std::string TempPath(const char* name) {
+    return "/tmp/cp_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+void Remove(const std::string& path) {
+    ::unlink(path.c_str());
+    ::unlink((path + ".cpidx").c_str());
+}
+
+/**
+ * @brief 只追加时增量更新的索引与重建的索引查询结果相同
+ */
+void TestAppend() {
+    const std::string path = TempPath("query_append.log");
+    WriteFile(path, MakeLines("INFO", "first", 20000));
+    CHECK_EQ(CountLines(Query({"--only", "INFO", path})), 20000u);
+    CHECK(Query({"--only", "ERROR", path}).empty());
+
+    WriteFile(path, "2026-10-17 11:00:00 [INFO] half", O_APPEND);  // 最后一行还没写完
+    CHECK_EQ(CountLines(Query({"--only", "INFO", path})), 20001u);
+    WriteFile(path, " done\n" + MakeLines("ERROR", "appended", 30000), O_APPEND);
+    const std::string incremental = Query({"--only", "ERROR", path});
+    CHECK_EQ(CountLines(incremental), 30000u);
+    CHECK_EQ(Query({"--grep", "half done", path}), "2026-10-17 11:00:00 [INFO] half done\n");
+    CHECK_EQ(Query({"--reindex", "--only", "ERROR", path}), incremental);
+    Remove(path);
+}
+
+/**
+ * @brief 大小不变的改写：修改时间、开头内容或 inode 任一变化都要重建索引
+ */
+void TestRewrittenSameSize() {
+    const std::string path = TempPath("query_rewrite.log");
+    const std::string original = MakeLines("DEBUG", "alpha", 20000);
+    const std::string rewritten = MakeLines("ERROR", "omega", 20000);
+    CHECK_EQ(original.size(), rewritten.size());
+
+    // 同一 inode、同样大小，修改时间被恢复：只有开头的哈希能发现
+    WriteFile(path, original);
+    const timespec mtime = MtimeOf(path);
+    CHECK(Query({"--only", "ERROR", path}).empty());
+    WriteFile(path, rewritten);
+    SetMtime(path, mtime);
+    CHECK_EQ(CountLines(Query({"--only", "ERROR", path})), 20000u);
+
+    // 开头 64 KB 不变，只改写后面：修改时间能发现
+    timespec later = MtimeOf(path);
+    later.tv_sec += 1;
+    WriteFile(path, MakeLines("ERROR", "omega", 19000) + MakeLines("FATAL", "omega", 1000));
+    SetMtime(path, later);
+    CHECK_EQ(CountLines(Query({"--only", "FATAL", path})), 1000u);
+
+    // 轮转：新文件（新 inode）与旧文件大小、开头和修改时间都相同，只有 inode 能发现
+    const std::string same_head = MakeLines("ERROR", "omega", 19000) + MakeLines("DEBUG", "omega", 1000);
+    const timespec before = MtimeOf(path);
+    const std::string replacement = path + ".new";
+    WriteFile(replacement, same_head);
+    SetMtime(replacement, before);
+    CHECK(::rename(replacement.c_str(), path.c_str()) == 0);
+    CHECK_EQ(CountLines(Query({"--only", "DEBUG", path})), 1000u);
+    CHECK(Query({"--only", "FATAL", path}).empty());
+    Remove(path);
+}
+
+/**
+ * @brief 超过 1 MB 的行整行留在一个块中，按行首的类型和时间戳过滤
+ */
+void TestLongLine() {
+    const std::string path = TempPath("query_long.log");
+    const std::string long_line = "2026-10-17 10:00:00 [ERROR] " + std::string(3 * 1024 * 1024, 'x') + " needle_tail\n";
+    WriteFile(path, MakeLines("INFO", "before", 100) + long_line + MakeLines("INFO", "after", 100));
+    CHECK_EQ(Query({"--only", "ERROR", "--grep", "needle_tail", path}), long_line);
+    CHECK_EQ(Query({"--since", "2026-10-17 10:00:00", "--until", "2026-10-17 10:00:00", "--grep", "needle_tail", path}),
+             long_line);
+    CHECK_EQ(CountLines(Query({"--only", "INFO", path})), 200u);
+    Remove(path);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::fprintf(stderr, "用法: %s <color_printer_query 的路径>\n", argv[0]);
+        return 2;
+    }
+    g_query = argv[1];
+    TestAppend();
+    TestRewrittenSameSize();
+    TestLongLine();
+    std::printf("test_query: 通过\n");
+    return 0;
+}
@@ -0,0 +1,251 @@
+/**
+ * @file test_shm_bus.cpp
+ * @brief 共享内存日志总线的测试：多线程写入后按序取出，跳过写入进程已退出而停滞的记录，
+ *        收集端退出后生产者不再无限等待，以及总线的接管与重新连接
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "color_printer_shm_sink.h"
+#include "test_common.h"
+
+namespace {
+
+std::string BusName(const char* name) {
+    return "/cp_test_" + std::to_string(::getpid()) + "_" + name;
+}
+
+void Write(ShmBusSink& sink, const std::string& message, LogLevel level = LogLevel::INFO) {
+    const std::string line = "[INFO] " + message + "\n";
+    const LogRecord record{PrintColor::GREEN, level, "INFO", std::string_view(line).substr(7, message.size()), line};
+    sink.Write(&record, 1);
+}
+
+std::vector<std::string> DrainAll(ShmBusHeader* bus, uint64_t stuck_head = ShmBusSink::kNotStuck) {
+    std::vector<std::string> lines;
+    ShmBusSink::Drain(bus, UINT64_MAX, stuck_head, [&](PrintColor color, LogLevel, std::string_view line) {
+        CHECK(color == PrintColor::GREEN);
+        CHECK(!line.empty() && line.back() == '\n');
+        lines.emplace_back(line.substr(0, line.size() - 1));
+    });
+    return lines;
+}
+
+/**
+ * @brief 多个线程同时写入，跨越数据区末尾多圈；每个线程的顺序保持不变
+ */
+void TestConcurrentWriters() {
+    const std::string name = BusName("concurrent");
+    ShmBusHeader* bus = ShmBusSink::Create(name, 4096);
+    CHECK(bus != nullptr);
+    ShmBusSink sink(name);
+    CHECK(sink.IsOpen());
+    CHECK(!sink.WantsColor());
+
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 2000;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < kThreads; t++) {
+        writers.emplace_back([&sink, t] {
+            for (int i = 0; i < kPerThread; i++) {
+                Write(sink, std::to_string(t) + " " + std::to_string(i));
+            }
+        });
+    }
+    std::vector<int> next(kThreads, 0);
+    int received = 0;
+    while (received < kThreads * kPerThread) {
+        for (const std::string& line : DrainAll(bus)) {
+            const int thread = std::stoi(line.substr(7));
+            const int index = std::stoi(line.substr(line.rfind(' ') + 1));
+            CHECK_EQ(index, next[static_cast<size_t>(thread)]);
+            next[static_cast<size_t>(thread)]++;
+            received++;
+        }
+    }
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+    CHECK_EQ(bus->dropped.load(), 0u);
+    ::shm_unlink(name.c_str());
+    ShmBusSink::Unmap(bus);
+}
+
+/**
+ * @brief 模拟生产者在预留之后被杀死：记录头仍为0（长度未知）或停在 kBusy
+ */
+void TestStuckRecords() {
+    const std::string name = BusName("stuck");
+    ShmBusHeader* bus = ShmBusSink::Create(name, 4096);
+    CHECK(bus != nullptr);
+    ShmBusSink sink(name);
+    char* data = reinterpret_cast<char*>(bus) + ShmBusHeader::kDataOffset;
+
+    Write(sink, "before");
+    // 预留了 24 字节，但没有写入记录头
+    bus->head.fetch_add(24);
+    Write(sink, "after 1");
+    const uint64_t stuck_head = bus->head.load();
+    Write(sink, "after 2");
+
+    std::vector<std::string> lines = DrainAll(bus);
+    CHECK_EQ(lines.size(), 1u);
+    CHECK_EQ(lines[0], "[INFO] before");
+    CHECK(DrainAll(bus).empty());  // 没有超时就一直等待
+
+    // 停滞开始时的 head 之前的内容丢弃，之后的记录照常取出
+    lines = DrainAll(bus, stuck_head);
+    CHECK_EQ(lines.size(), 1u);
+    CHECK_EQ(lines[0], "[INFO] after 2");
+    CHECK_EQ(bus->dropped.load(), 1u);
+    CHECK(bus->resync_bytes.load() >= 24);
+    CHECK_EQ(bus->tail.load(), bus->head.load());
+
+    // 已写入长度、停在 kBusy 的记录只跳过这一条
+    const uint64_t busy_at = bus->head.fetch_add(32);
+    auto* busy = reinterpret_cast<ShmRecordHeader*>(data + busy_at % bus->capacity);
+    busy->state.store(32 | ShmRecordHeader::kBusy);
+    Write(sink, "after busy");
+    CHECK(DrainAll(bus).empty());
+    lines = DrainAll(bus, bus->head.load());
+    CHECK_EQ(lines.size(), 1u);
+    CHECK_EQ(lines[0], "[INFO] after busy");
+    CHECK_EQ(bus->dropped.load(), 2u);
+
+    // 跳过后归还的空间被清零，可以继续正常使用多圈
+    for (int i = 0; i < 500; i++) {
+        Write(sink, "wrap " + std::to_string(i));
+        lines = DrainAll(bus);
+        CHECK_EQ(lines.size(), 1u);
+        CHECK_EQ(lines[0], "[INFO] wrap " + std::to_string(i));
+    }
+    ::shm_unlink(name.c_str());
+    ShmBusSink::Unmap(bus);
+}
+
+/**
+ * @brief 缓冲区满且收集端心跳已超时：生产者不再无限等待，丢弃并计数
+ */
+void TestCollectorGone() {
+    const std::string name = BusName("gone");
+    ShmBusHeader* bus = ShmBusSink::Create(name, 4096);
+    CHECK(bus != nullptr);
+    ShmBusSink sink(name);
+    CHECK(sink.IsOpen());
+
+    // 收集端从不取数据，也不再更新心跳
+    bus->heartbeat_ms.store(bus->heartbeat_ms.load() - ShmBusHeader::kCollectorTimeoutMs - 1000);
+    color_printer_test::RunWithTimeout(std::chrono::seconds(30), [&] {
+        for (int i = 0; i < 1000; i++) {
+            Write(sink, "no collector " + std::to_string(i));
+        }
+    });
+    CHECK(bus->dropped.load() > 0);
+
+    // 收集端恢复后照常写入
+    const uint64_t dropped = bus->dropped.load();
+    DrainAll(bus);
+    Write(sink, "collector back");
+    const std::vector<std::string> lines = DrainAll(bus);
+    CHECK_EQ(lines.size(), 1u);
+    CHECK_EQ(lines[0], "[INFO] collector back");
+    CHECK_EQ(bus->dropped.load(), dropped);
+    ::shm_unlink(name.c_str());
+    ShmBusSink::Unmap(bus);
+}
+
+/**
+ * @brief 收集端重启时接管原有总线；总线被移除或替换后，生产者按间隔重新连接，其间退回标准输出
+ */
+void TestReuseAndReattach() {
+    const std::string name = BusName("reattach");
+    ShmBusSink sink(name);  // 先于收集端启动
+    CHECK(!sink.IsOpen());
+
+    ShmBusHeader* bus = ShmBusSink::Create(name, 4096);
+    CHECK(bus != nullptr);
+    Write(sink, "attached");
+    CHECK(sink.IsOpen());
+    std::vector<std::string> lines = DrainAll(bus);
+    CHECK_EQ(lines.size(), 1u);
+    CHECK_EQ(lines[0], "[INFO] attached");
+
+    // 收集端被杀死：总线留在原处，新的收集端接管，未取出的记录不丢
+    Write(sink, "pending");
+    bus->heartbeat_ms.store(bus->heartbeat_ms.load() - ShmBusHeader::kCollectorTimeoutMs - 1000);
+    ShmBusSink::Unmap(bus);
+    bus = ShmBusSink::Create(name, 4096);
+    CHECK(bus != nullptr);
+    Write(sink, "after restart");
+    lines = DrainAll(bus);
+    CHECK_EQ(lines.size(), 2u);
+    CHECK_EQ(lines[0], "[INFO] pending");
+    CHECK_EQ(lines[1], "[INFO] after restart");
+
+    // 另一个收集端仍在运行（心跳在更新）时不接管
+    std::atomic<bool> collecting{true};
+    std::thread collector([&] {
+        while (collecting.load()) {
+            ShmBusSink::WaitForData(bus, 50);
+        }
+    });
+    CHECK(ShmBusSink::Create(name, 4096) == nullptr);
+    collecting.store(false);
+    collector.join();
+
+    // 收集端正常退出：生产者退回标准输出
+    ShmBusSink::Remove(name, bus);
+    color_printer_test::StdoutToFile capture("/tmp/cp_test_" + std::to_string(::getpid()) + "_shm_stdout");
+    std::vector<std::string> batch;
+    for (int i = 0; i < 3; i++) {
+        batch.push_back("[INFO] removed " + std::to_string(i) + "\n");
+    }
+    std::vector<LogRecord> records;
+    for (const std::string& line : batch) {
+        records.push_back({PrintColor::GREEN, LogLevel::INFO, "INFO", std::string_view(line).substr(7, line.size() - 8), line});
+    }
+    sink.Write(records.data(), records.size());
+    const std::string output = capture.Finish();
+    CHECK_EQ(output, batch[0] + batch[1] + batch[2]);
+    CHECK(!sink.IsOpen());
+
+    // 新的收集端启动后，间隔到期的下一次写入重新连接
+    bus = ShmBusSink::Create(name, 4096);
+    CHECK(bus != nullptr);
+    std::this_thread::sleep_for(std::chrono::milliseconds(ShmBusSink::kAttachIntervalMs + 100));
+    Write(sink, "reattached");
+    lines = DrainAll(bus);
+    CHECK_EQ(lines.size(), 1u);
+    CHECK_EQ(lines[0], "[INFO] reattached");
+
+    // 以不同容量重建：旧总线被标记为已移除，生产者连接到新总线
+    ShmBusHeader* larger = ShmBusSink::Create(name, 8192);
+    CHECK(larger != nullptr);
+    CHECK(bus->retired.load() != 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(ShmBusSink::kAttachIntervalMs + 100));
+    Write(sink, "larger");
+    CHECK(DrainAll(bus).empty());
+    lines = DrainAll(larger);
+    CHECK_EQ(lines.size(), 1u);
+    CHECK_EQ(lines[0], "[INFO] larger");
+    ShmBusSink::Unmap(bus);
+    ShmBusSink::Remove(name, larger);
+}
+
+} // namespace
+
+int main() {
+    TestConcurrentWriters();
+    TestStuckRecords();
+    TestCollectorGone();
+    TestReuseAndReattach();
+    std::printf("test_shm_bus: 通过\n");
+    return 0;
+}
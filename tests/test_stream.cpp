@@ -0,0 +1,74 @@
+/**
+ * @file test_stream.cpp
+ * @brief ColorPrinter::Stream 的测试：遇到 '\n' 立即输出完整的行，析构时输出不完整的行
+ */
+
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "color_printer.h"
+#include "test_common.h"
+
+using namespace color_printer_test;
+
+namespace {
+
+void TestLinesEmittedOnNewline() {
+    auto sink = std::make_shared<MemorySink>();
+    ColorPrinter::Printer printer{sink};
+    {
+        ColorPrinter::Stream stream(printer, PrintColor::CYAN, "DEBUG");
+        stream << "x = " << 42 << ", y = " << std::fixed << std::setprecision(1) << 2.5;
+        CHECK(sink->Lines().empty());  // 还没有换行
+
+        stream << "\nsecond";
+        CHECK_EQ(sink->Lines().size(), 1u);  // 没有 flush，换行本身触发输出
+        CHECK_EQ(sink->Lines()[0], "[DEBUG] x = 42, y = 2.5");
+
+        stream.put('\n');
+        CHECK_EQ(sink->Lines().size(), 2u);
+        CHECK_EQ(sink->Lines()[1], "[DEBUG] second");
+
+        stream << "a\nb\n\nc" << std::endl;
+        CHECK_EQ(sink->Lines().size(), 6u);
+        CHECK_EQ(sink->Lines()[2], "[DEBUG] a");
+        CHECK_EQ(sink->Lines()[3], "[DEBUG] b");
+        CHECK_EQ(sink->Lines()[4], "[DEBUG] ");
+        CHECK_EQ(sink->Lines()[5], "[DEBUG] c");
+
+        // 跨多次写入、超过初始缓冲区的长行
+        const std::string chunk(3000, 'z');
+        stream << chunk << chunk << chunk << '\n';
+        CHECK_EQ(sink->Lines().size(), 7u);
+        CHECK_EQ(sink->Lines()[6], "[DEBUG] " + chunk + chunk + chunk);
+
+        stream << "tail without newline";
+        CHECK_EQ(sink->Lines().size(), 7u);
+    }
+    CHECK_EQ(sink->Lines().size(), 8u);
+    CHECK_EQ(sink->Lines()[7], "[DEBUG] tail without newline");
+}
+
+/**
+ * @brief 临时对象的写法：整条语句结束时输出
+ */
+void TestTemporaryStream() {
+    auto sink = std::make_shared<MemorySink>();
+    ColorPrinter::Printer printer{sink};
+    ColorPrinter::Stream(printer, PrintColor::GREEN, "INFO") << "count: " << 3;
+    ColorPrinter::Stream(printer, PrintColor::GREEN, "INFO") << "with endl" << std::endl;
+    const std::vector<std::string> lines = sink->Lines();
+    CHECK_EQ(lines.size(), 2u);
+    CHECK_EQ(lines[0], "[INFO] count: 3");
+    CHECK_EQ(lines[1], "[INFO] with endl");
+}
+
+} // namespace
+
+int main() {
+    TestLinesEmittedOnNewline();
+    TestTemporaryStream();
+    std::printf("test_stream: 通过\n");
+    return 0;
+}